@@ -0,0 +1,903 @@
+#include <stdio.h>
+#include <gpiod.h>
+#include <gpiod_spi.h>
+#include <gpiod_config.h>
+#include <gpiod_debounce.h>
+#include <gpiod_broker.h>
+#include <gpiod_rt.h>
+#include <gpiod_regs.h>
+#include <gpio_addressing.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+/*******************************************************************************/
+//
+// DESCRIPTION : Benchmark harness for the gpiod library.
+//
+// USAGE       : bench [--regs PATH | --dev-mem | --gpiomem | --sim | --chardev PATH | --broker PATH] [--iters N]
+//                     [--case NAME] [--rt CPU]
+//
+// DETAILS     : Runs against a regular file standing in for the register space by
+//               default, or the given backend. Every case reports one JSON line on
+//               stdout: throughput from an untimed loop, and per-operation latency
+//               percentiles plus a log2 histogram (bucket n counts latencies in
+//               [2^(n-1), 2^n) ns) from a second loop timing each operation. The
+//               clock read overhead is measured once and subtracted.
+//               The set_gpio_fn_stress case instead splits the configuration pins
+//               between 1, 2, 4 and 8 threads. The threads change their own pins'
+//               functions concurrently in the FSEL registers they share. Only the
+//               owner writes a pin's field, so each time an owner finds its pin in a
+//               state other than the one it last wrote, another thread's update has
+//               overwritten it. It reports one line per thread count, with the
+//               throughput and those lost updates, counted during the run and on the
+//               final state.
+//               --chardev runs the cases that do not need the register mapping
+//               against a GPIO character device, for comparison with the mmap path.
+//               The bulk group is then one multi-line kernel request. Without the
+//               hardware, gpio-sim (CONFIG_GPIO_SIM) provides a chip with 64 lines:
+//                 mkdir -p /sys/kernel/config/gpio-sim/bench/gpio-bank0
+//                 echo 64 > /sys/kernel/config/gpio-sim/bench/gpio-bank0/num_lines
+//                 echo 1  > /sys/kernel/config/gpio-sim/bench/live
+//                 bench --chardev /dev/$(cat /sys/kernel/config/gpio-sim/bench/gpio-bank0/chip_name)
+//               --broker runs the broker cases instead, as a client of the broker
+//               daemon (bin/target) listening on PATH. They time a round trip
+//               through the shared-memory rings, on the lines of the multi-pin
+//               cases, for comparison with the direct calls:
+//                 target --sim --socket /tmp/gpiod.sock & bench --broker /tmp/gpiod.sock
+//               The rt_jitter case runs the real-time self-test (gpiod_rt.h) on the
+//               single pin, back to back and then paced at BENCH_RT_PERIOD_NS over a
+//               tenth of the iterations. --rt first sets the benchmark up for
+//               real-time use on the given CPU (-1 for any) with the default
+//               SCHED_FIFO priority, so every case runs locked, pre-faulted and
+//               pinned. Comparing rt_jitter with and without it shows what the
+//               setup removes.
+//               The reg_* cases time the register access policies of gpiod_regs.h
+//               directly, whatever policy the library is built with: one store or
+//               load relaxed and strict, and four back to back stores relaxed, with
+//               one closing dsb (_sync), and strict. Building with MMIO=strict shows
+//               the cost of the strict policy on the library calls themselves.
+//
+/*******************************************************************************/
+
+/// GLOBALS ///
+// Register file used when no backend is given, lets the benchmark run off target
+static const char* BENCH_REGS_PATH   = "/tmp/gpiod_bench.regs";
+// Default operations per case
+static const uint32_t BENCH_ITERS    = 1000000;
+// Most operations timed individually per case
+static const uint32_t BENCH_LAT_MAX  = 1000000;
+// Number of lines in the multi-pin cases
+#define BENCH_NUM_LINES 16
+// First pin of the multi-pin cases, the group spans both banks
+static const uint8_t BENCH_FIRST_PIN = 24;
+// Number of log2 latency buckets
+#define BENCH_HIST_SZ   32
+// Lines of the multi-pin cases, lines[0] is the single pin
+static gpio_line_t bench_lines[BENCH_NUM_LINES];
+// Fast path handles for the lines
+static gpio_fast_t bench_fast[BENCH_NUM_LINES];
+// Bulk group over the lines
+static gpio_bulk_t bench_bulk;
+// Pins of the bit-banged SPI case: chip select, clock, MOSI and MISO
+static const uint8_t BENCH_SPI_PINS[] = { 4, 5, 6, 7 };
+// Bytes per SPI transfer
+#define BENCH_SPI_LEN   64
+// Lines of the SPI case
+static gpio_line_t bench_spi_lines[4];
+// SPI master of the SPI case
+static gpio_spi_t bench_spi;
+// SPI transfer buffers
+static uint8_t bench_spi_tx[BENCH_SPI_LEN];
+static uint8_t bench_spi_rx[BENCH_SPI_LEN];
+// Pins no other case holds, cycled through by the request/release case
+static const uint8_t BENCH_FREE_PINS[] = { 0, 1, 2, 3, 56, 57 };
+// Number of pins reconfigured by the configuration cases
+#define BENCH_CONFIG_PINS 32
+// Lines of the configuration cases, pins 8..23 and 40..55, clear of the other cases
+static gpio_line_t bench_config_lines[BENCH_CONFIG_PINS];
+// The two board modes switched between by the configuration cases
+static gpio_config_t bench_config_modes[2];
+// Samples a pin must hold in the debounce cases
+#define BENCH_DEBOUNCE_SAMPLES 4
+// Debouncer of the bit-sliced debounce case
+static gpio_debounce_t bench_debounce;
+// Debounced levels, counts and thresholds of the per-pin debounce case
+static uint64_t bench_debounce_levels = 0x00;
+static uint8_t bench_debounce_count[GPIO_PIN_MAX + 1];
+static uint8_t bench_debounce_threshold[GPIO_PIN_MAX + 1];
+// Connection of the broker cases
+static gpio_broker_client_t bench_broker;
+// Pins of the broker cases, those of the multi-pin cases
+static const uint64_t BENCH_BROKER_PINS = ((GPIO_PIN_BIT(BENCH_NUM_LINES) - 1) << 24);
+// SET, CLR and LEV registers of the pins of the multi-pin cases, both banks, for the register cases
+static volatile uint32_t* bench_set_regs[2];
+static volatile uint32_t* bench_clr_regs[2];
+static volatile uint32_t* bench_lev_reg;
+// Period of the paced rt_jitter run
+static const uint64_t BENCH_RT_PERIOD_NS = 10000;
+// Most threads of the stress case, doubled from 1
+#define BENCH_STRESS_MAX_THREADS 8
+// Sink for read results, keeps the reads from being optimized away
+static volatile uint64_t bench_sink  = 0;
+
+/// STRUCTS ///
+// One benchmark case
+typedef struct bench_case {
+    // Case name as reported
+    const char* name;
+    // Run one operation, given the iteration number
+    void (*run)(uint32_t);
+    // Whether the case needs the register mapping, it is skipped on the character device
+    bool regs;
+} bench_case_t;
+
+// One thread of the stress case
+typedef struct bench_stress {
+    // Thread index, it owns the configuration lines of this index modulo threads
+    uint8_t thread;
+    // Threads running
+    uint8_t threads;
+    // Function changes made by the thread
+    uint32_t ops;
+    // Lost updates found by the thread
+    uint32_t lost;
+    // Start line, every thread starts together
+    pthread_barrier_t* start;
+} bench_stress_t;
+
+/// CASES ///
+// Toggle through write_gpio(), FSEL readback and one SET/CLR store per call
+static void case_write_gpio(uint32_t iter)
+{
+    write_gpio(&bench_lines[0], iter & 0x01);
+}
+// Toggle through the fast path, one store per write
+static void case_write_gpio_fast(uint32_t iter)
+{
+    write_gpio_fast(&bench_fast[0], iter & 0x01);
+}
+// Flip the function of a pin outside the bulk group, a FSEL read-modify-write
+static void case_set_gpio_fn(uint32_t iter)
+{
+    set_gpio_fn(&bench_config_lines[0], (iter & 0x01) ? INPUT : OUTPUT);
+}
+// Drive all lines one write_gpio() call at a time
+static void case_write_16_single(uint32_t iter)
+{
+    /// LOCALS ///
+    // Line index
+    uint8_t line_ind = 0;
+
+    for (line_ind = 0; line_ind < BENCH_NUM_LINES; line_ind++)
+    {
+        write_gpio(&bench_lines[line_ind], (iter + line_ind) & 0x01);
+    }
+}
+// Drive all lines one fast path store at a time
+static void case_write_16_fast(uint32_t iter)
+{
+    /// LOCALS ///
+    // Line index
+    uint8_t line_ind = 0;
+
+    for (line_ind = 0; line_ind < BENCH_NUM_LINES; line_ind++)
+    {
+        write_gpio_fast(&bench_fast[line_ind], (iter + line_ind) & 0x01);
+    }
+}
+// Drive all lines with one bulk write
+static void case_write_16_bulk(uint32_t iter)
+{
+    write_gpio_bulk(&bench_bulk, (iter & 0x01) ? 0x5555555555555555ULL : 0xAAAAAAAAAAAAAAAAULL, bench_bulk.pin_mask);
+}
+// Read one pin
+static void case_read_gpio(uint32_t iter)
+{
+    (void) iter;
+    bench_sink = (uint64_t) read_gpio(&bench_lines[0]);
+}
+// Snapshot every pin, GPLEV0 and GPLEV1
+static void case_read_gpio_levels(uint32_t iter)
+{
+    /// LOCALS ///
+    // Levels read
+    uint64_t levels = 0x00;
+
+    (void) iter;
+    read_gpio_levels(&levels);
+    bench_sink = levels;
+}
+// Request, configure and release a line on the already open chip
+static void case_request_release(uint32_t iter)
+{
+    /// LOCALS ///
+    // Line requested
+    gpio_line_t line;
+
+    if (0 == request_gpio_line(&line, BENCH_FREE_PINS[iter % sizeof(BENCH_FREE_PINS)]))
+    {
+        set_gpio_fn(&line, INPUT);
+        release_gpio_line(&line);
+    }
+}
+// Full duplex bit-banged SPI transfer of BENCH_SPI_LEN bytes, mode 0 at full speed
+static void case_spi_transfer(uint32_t iter)
+{
+    bench_spi_tx[0] = (uint8_t) iter;
+    transfer_gpio_spi(&bench_spi, bench_spi_tx, bench_spi_rx, BENCH_SPI_LEN);
+}
+// Switch the configuration pins between two modes one set_gpio_fn()/set_gpio_pull() call at a time
+static void case_config_32_single(uint32_t iter)
+{
+    /// LOCALS ///
+    // Line index
+    uint8_t line_ind = 0;
+
+    for (line_ind = 0; line_ind < BENCH_CONFIG_PINS; line_ind++)
+    {
+        set_gpio_fn(&bench_config_lines[line_ind], (iter & 0x01) ? OUTPUT : INPUT);
+        set_gpio_pull(&bench_config_lines[line_ind], (iter & 0x01) ? PULL_NONE : PULL_UP);
+    }
+}
+// Switch the configuration pins between two prestaged modes with one commit
+static void case_config_32_commit(uint32_t iter)
+{
+    commit_gpio_config(&bench_config_modes[iter & 0x01]);
+}
+// Read the timebase
+static void case_gpio_time_ns(uint32_t iter)
+{
+    (void) iter;
+    bench_sink = gpio_time_ns();
+}
+// Spin for one microsecond, the latency reported is the delay itself
+static void case_gpio_delay_1us(uint32_t iter)
+{
+    (void) iter;
+    gpio_delay_ns(1000);
+}
+// Every pin flipping every 64 samples, with a sparse pseudo-random bounce over it
+static inline uint64_t bench_debounce_sample(uint32_t iter)
+{
+    /// LOCALS ///
+    // Hash of the iteration
+    uint64_t hash = (uint64_t) iter * 0x9E3779B97F4A7C15ULL;
+
+    return ((iter & 0x40) ? ~((uint64_t) 0) : 0) ^ (hash & (hash >> 7) & (hash >> 13));
+}
+// Debounce every pin with a counter and branches per pin
+static void case_debounce_58_per_pin(uint32_t iter)
+{
+    /// LOCALS ///
+    // Sample debounced
+    uint64_t levels  = bench_debounce_sample(iter);
+    // Pins changed
+    uint64_t changed = 0x00;
+    // Pin index
+    uint8_t pin      = 0;
+
+    for (pin = 0; pin <= GPIO_PIN_MAX; pin++)
+    {
+        if (GPIO_PIN_LEVEL(levels, pin) == GPIO_PIN_LEVEL(bench_debounce_levels, pin))
+        {
+            bench_debounce_count[pin] = 0;
+        }
+        else if (++bench_debounce_count[pin] >= bench_debounce_threshold[pin])
+        {
+            bench_debounce_count[pin] = 0;
+            changed |= GPIO_PIN_BIT(pin);
+        }
+    }
+    bench_debounce_levels ^= changed;
+    bench_sink = changed;
+}
+// Debounce every pin with the vertical counters
+static void case_debounce_58_sliced(uint32_t iter)
+{
+    bench_sink = update_gpio_debounce(&bench_debounce, bench_debounce_sample(iter));
+}
+// One SET or CLR store of the single pin, no barrier
+static void case_reg_write_relaxed(uint32_t iter)
+{
+    gpio_reg_write_relaxed((iter & 0x01) ? bench_set_regs[0] : bench_clr_regs[0], GPIO_PIN_BIT(BENCH_FIRST_PIN));
+}
+// One SET or CLR store of the single pin between a dmb and a dsb
+static void case_reg_write_strict(uint32_t iter)
+{
+    gpio_reg_write_strict((iter & 0x01) ? bench_set_regs[0] : bench_clr_regs[0], GPIO_PIN_BIT(BENCH_FIRST_PIN));
+}
+// Drive the lines to alternate levels with four back to back posted stores
+static void case_reg_write_4_relaxed(uint32_t iter)
+{
+    gpio_reg_write_relaxed(bench_set_regs[0], (uint32_t) (bench_bulk.pin_mask & ((iter & 0x01) ? 0x55555555 : 0xAAAAAAAA)));
+    gpio_reg_write_relaxed(bench_set_regs[1], (uint32_t) (bench_bulk.pin_mask >> 32) & ((iter & 0x01) ? 0x55555555 : 0xAAAAAAAA));
+    gpio_reg_write_relaxed(bench_clr_regs[0], (uint32_t) (bench_bulk.pin_mask & ((iter & 0x01) ? 0xAAAAAAAA : 0x55555555)));
+    gpio_reg_write_relaxed(bench_clr_regs[1], (uint32_t) (bench_bulk.pin_mask >> 32) & ((iter & 0x01) ? 0xAAAAAAAA : 0x55555555));
+}
+// The same four posted stores completed by one dsb
+static void case_reg_write_4_sync(uint32_t iter)
+{
+    case_reg_write_4_relaxed(iter);
+    gpio_reg_sync();
+}
+// The same four stores, each between a dmb and a dsb
+static void case_reg_write_4_strict(uint32_t iter)
+{
+    gpio_reg_write_strict(bench_set_regs[0], (uint32_t) (bench_bulk.pin_mask & ((iter & 0x01) ? 0x55555555 : 0xAAAAAAAA)));
+    gpio_reg_write_strict(bench_set_regs[1], (uint32_t) (bench_bulk.pin_mask >> 32) & ((iter & 0x01) ? 0x55555555 : 0xAAAAAAAA));
+    gpio_reg_write_strict(bench_clr_regs[0], (uint32_t) (bench_bulk.pin_mask & ((iter & 0x01) ? 0xAAAAAAAA : 0x55555555)));
+    gpio_reg_write_strict(bench_clr_regs[1], (uint32_t) (bench_bulk.pin_mask >> 32) & ((iter & 0x01) ? 0xAAAAAAAA : 0x55555555));
+}
+// One GPLEV0 load, no barrier
+static void case_reg_read_relaxed(uint32_t iter)
+{
+    (void) iter;
+    bench_sink = gpio_reg_read_relaxed(bench_lev_reg);
+}
+// One GPLEV0 load between two dmb
+static void case_reg_read_strict(uint32_t iter)
+{
+    (void) iter;
+    bench_sink = gpio_reg_read_strict(bench_lev_reg);
+}
+// The cases, in the order they are run
+static const bench_case_t BENCH_CASES[] = {
+    { "write_gpio",          case_write_gpio,          false },
+    { "write_gpio_fast",     case_write_gpio_fast,     true  },
+    { "set_gpio_fn",         case_set_gpio_fn,         false },
+    { "write_16_single",     case_write_16_single,     false },
+    { "write_16_fast",       case_write_16_fast,       true  },
+    { "write_16_bulk",       case_write_16_bulk,       false },
+    { "read_gpio",           case_read_gpio,           false },
+    { "read_gpio_levels",    case_read_gpio_levels,    true  },
+    { "request_release",     case_request_release,     false },
+    { "spi_transfer_64",     case_spi_transfer,        true  },
+    { "config_32_single",    case_config_32_single,    false },
+    { "config_32_commit",    case_config_32_commit,    true  },
+    { "gpio_time_ns",        case_gpio_time_ns,        false },
+    { "gpio_delay_1us",      case_gpio_delay_1us,      false },
+    { "debounce_58_per_pin", case_debounce_58_per_pin, false },
+    { "debounce_58_sliced",  case_debounce_58_sliced,  false },
+    { "reg_write_relaxed",   case_reg_write_relaxed,   true  },
+    { "reg_write_strict",    case_reg_write_strict,    true  },
+    { "reg_write_4_relaxed", case_reg_write_4_relaxed, true  },
+    { "reg_write_4_sync",    case_reg_write_4_sync,    true  },
+    { "reg_write_4_strict",  case_reg_write_4_strict,  true  },
+    { "reg_read_relaxed",    case_reg_read_relaxed,    true  },
+    { "reg_read_strict",     case_reg_read_strict,     true  },
+};
+// Toggle one pin through the broker and wait for the store
+static void case_broker_write(uint32_t iter)
+{
+    write_gpio_broker(&bench_broker, (iter & 0x01) ? BENCH_BROKER_PINS : 0x00, GPIO_PIN_BIT(BENCH_FIRST_PIN));
+}
+// Toggle one pin through the broker without waiting, the latency is that of posting the command
+static void case_broker_post_write(uint32_t iter)
+{
+    post_gpio_broker_write(&bench_broker, (iter & 0x01) ? BENCH_BROKER_PINS : 0x00, GPIO_PIN_BIT(BENCH_FIRST_PIN));
+}
+// Drive every broker pin with one command and wait for the store
+static void case_broker_write_16(uint32_t iter)
+{
+    write_gpio_broker(&bench_broker, (iter & 0x01) ? 0x5555555555555555ULL : 0xAAAAAAAAAAAAAAAAULL, BENCH_BROKER_PINS);
+}
+// Read the levels of the broker pins
+static void case_broker_read_levels(uint32_t iter)
+{
+    /// LOCALS ///
+    // Levels read
+    uint64_t levels = 0x00;
+
+    (void) iter;
+    read_gpio_broker_levels(&bench_broker, &levels);
+    bench_sink = levels;
+}
+// The broker cases, run instead of the others with --broker
+static const bench_case_t BENCH_BROKER_CASES[] = {
+    { "broker_write",        case_broker_write,        false },
+    { "broker_post_write",   case_broker_post_write,   false },
+    { "broker_write_16",     case_broker_write_16,     false },
+    { "broker_read_levels",  case_broker_read_levels,  false },
+};
+// Number of broker cases
+static const uint8_t BENCH_BROKER_CASES_SZ = sizeof(BENCH_BROKER_CASES)/sizeof(BENCH_BROKER_CASES[0]);
+// Number of cases
+static const uint8_t BENCH_CASES_SZ = sizeof(BENCH_CASES)/sizeof(BENCH_CASES[0]);
+
+/// FUNCTIONS ///
+// Monotonic time in nanoseconds
+static uint64_t bench_now_ns(void);
+// Function of a configuration line, read back from its FSEL register
+static enum FunctionSelect bench_config_fn(uint8_t line_ind)
+{
+    /// LOCALS ///
+    // Pin of the line, 8..23 then 40..55
+    uint8_t pin = (line_ind < 16) ? (8 + line_ind) : (40 + line_ind - 16);
+
+    return (enum FunctionSelect) ((gpio_reg_read((volatile uint32_t *)(get_gpio_chip_base() + GPFN_SEL0_OFF +
+                                                                       ((pin / 10) * GPIO_REG_SIZE))) >> ((pin % 10) * 3)) & 0x07);
+}
+// Stress thread, change the functions of the owned lines, checking each still holds its last write
+static void* bench_stress_thread(void* arg)
+{
+    /// LOCALS ///
+    // The thread's share of the case
+    bench_stress_t* stress = (bench_stress_t *) arg;
+    // Function last written to each owned line
+    enum FunctionSelect written[BENCH_CONFIG_PINS];
+    // Function change index
+    uint32_t op_ind        = 0;
+    // Line index
+    uint8_t line_ind       = stress->thread;
+
+    for (line_ind = stress->thread; line_ind < BENCH_CONFIG_PINS; line_ind += stress->threads)
+    {
+        set_gpio_fn(&bench_config_lines[line_ind], INPUT);
+        written[line_ind] = INPUT;
+    }
+    line_ind = stress->thread;
+    pthread_barrier_wait(stress->start);
+    for (op_ind = 0; op_ind < stress->ops; op_ind++)
+    {
+        stress->lost += (written[line_ind] != bench_config_fn(line_ind)) ? 1 : 0;
+        written[line_ind] = (written[line_ind] == INPUT) ? OUTPUT : INPUT;
+        set_gpio_fn(&bench_config_lines[line_ind], written[line_ind]);
+        line_ind = ((line_ind + stress->threads) < BENCH_CONFIG_PINS) ? (line_ind + stress->threads) : stress->thread;
+    }
+    // Wait for every thread to stop writing before the final check
+    pthread_barrier_wait(stress->start);
+    for (line_ind = stress->thread; line_ind < BENCH_CONFIG_PINS; line_ind += stress->threads)
+    {
+        stress->lost += (written[line_ind] != bench_config_fn(line_ind)) ? 1 : 0;
+    }
+    return NULL;
+}
+// Run the stress case for each thread count and report it
+static void bench_run_stress(const char* backend,
+                             uint32_t iters)
+{
+    /// LOCALS ///
+    // The threads and their shares
+    pthread_t threads[BENCH_STRESS_MAX_THREADS];
+    bench_stress_t stress[BENCH_STRESS_MAX_THREADS];
+    // Start line
+    pthread_barrier_t start;
+    // Loop start time
+    uint64_t start_ns    = 0;
+    // Whole run time
+    uint64_t elapsed_ns  = 0;
+    // Lost updates of every thread
+    uint32_t lost        = 0;
+    // Thread count and thread index
+    uint8_t num_threads  = 0;
+    uint8_t thread_ind   = 0;
+
+    for (num_threads = 1; num_threads <= BENCH_STRESS_MAX_THREADS; num_threads *= 2)
+    {
+        pthread_barrier_init(&start, NULL, num_threads + 1);
+        for (thread_ind = 0; thread_ind < num_threads; thread_ind++)
+        {
+            stress[thread_ind].thread  = thread_ind;
+            stress[thread_ind].threads = num_threads;
+            stress[thread_ind].ops     = iters / num_threads;
+            stress[thread_ind].lost    = 0;
+            stress[thread_ind].start   = &start;
+            pthread_create(&threads[thread_ind], NULL, bench_stress_thread, &stress[thread_ind]);
+        }
+        // The threads are waiting by now, or about to
+        start_ns = bench_now_ns();
+        pthread_barrier_wait(&start);
+        pthread_barrier_wait(&start);
+        elapsed_ns = bench_now_ns() - start_ns;
+        lost       = 0;
+        for (thread_ind = 0; thread_ind < num_threads; thread_ind++)
+        {
+            pthread_join(threads[thread_ind], NULL);
+            lost += stress[thread_ind].lost;
+        }
+        pthread_barrier_destroy(&start);
+        printf("{\"case\":\"set_gpio_fn_stress\",\"backend\":\"%s\",\"threads\":%u,\"ops\":%u,"
+               "\"ops_per_sec\":%.0f,\"lost_updates\":%u}\n",
+               backend, num_threads, (iters / num_threads) * num_threads,
+               (double) ((iters / num_threads) * num_threads) * 1e9 / (double) (elapsed_ns ? elapsed_ns : 1), lost);
+        fflush(stdout);
+    }
+}
+// Run the real-time self-test and report it
+static void bench_run_rt_jitter(const char* backend,
+                                uint32_t iters,
+                                uint64_t period_ns)
+{
+    /// LOCALS ///
+    // Self-test results
+    gpio_rt_report_t report;
+    // Status of the self-test
+    int32_t status = 0;
+    // Histogram bucket
+    uint8_t bucket = 0;
+
+    if (0 != (status = run_gpio_rt_selftest(&bench_lines[0], iters, period_ns, &report)))
+    {
+        fprintf(stderr, "bench: rt_jitter failed (%d)\n", status);
+        return;
+    }
+    printf("{\"case\":\"rt_jitter\",\"backend\":\"%s\",\"iters\":%u,\"period_ns\":%llu,\"min_ns\":%llu,"
+           "\"mean_ns\":%llu,\"max_ns\":%llu,\"stalls\":%llu,\"hist_log2_ns\":[",
+           backend, report.iters, (unsigned long long) report.period_ns, (unsigned long long) report.min_ns,
+           (unsigned long long) report.mean_ns, (unsigned long long) report.max_ns, (unsigned long long) report.stalls);
+    for (bucket = 0; bucket < GPIO_RT_HIST_SZ; bucket++)
+    {
+        printf("%s%llu", (0 == bucket) ? "" : ",", (unsigned long long) report.hist[bucket]);
+    }
+    printf("]}\n");
+    fflush(stdout);
+}
+// Monotonic time in nanoseconds
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000000ULL) + (uint64_t) ts.tv_nsec;
+}
+// Sort helper for latencies
+static int bench_cmp_u32(const void* lhs, const void* rhs)
+{
+    return (*(const uint32_t *) lhs > *(const uint32_t *) rhs) - (*(const uint32_t *) lhs < *(const uint32_t *) rhs);
+}
+// Cost of one pair of clock reads
+static uint64_t bench_timer_overhead_ns(void)
+{
+    /// LOCALS ///
+    // Smallest back to back difference seen
+    uint64_t min_ns = UINT64_MAX;
+    // Sample start
+    uint64_t start_ns = 0;
+    // Sample index
+    uint32_t sample = 0;
+
+    for (sample = 0; sample < 10000; sample++)
+    {
+        start_ns = bench_now_ns();
+        start_ns = bench_now_ns() - start_ns;
+        min_ns   = (start_ns < min_ns) ? start_ns : min_ns;
+    }
+    return min_ns;
+}
+// Run one case and report it
+static void bench_run_case(const bench_case_t* bench_case,
+                           const char* backend,
+                           uint32_t iters,
+                           uint32_t* samples,
+                           uint64_t overhead_ns)
+{
+    /// LOCALS ///
+    // Number of individually timed operations
+    uint32_t lat_iters = (iters < BENCH_LAT_MAX) ? iters : BENCH_LAT_MAX;
+    // Log2 latency histogram
+    uint64_t hist[BENCH_HIST_SZ];
+    // Loop start time
+    uint64_t start_ns = 0;
+    // Whole loop time
+    uint64_t elapsed_ns = 0;
+    // One operation's time
+    uint64_t op_ns = 0;
+    // Loop index
+    uint32_t iter = 0;
+    // Histogram bucket
+    uint8_t bucket = 0;
+
+    memset(hist, 0, sizeof(hist));
+    // Warm up, then throughput
+    for (iter = 0; iter < (iters / 10); iter++)
+    {
+        bench_case->run(iter);
+    }
+    start_ns = bench_now_ns();
+    for (iter = 0; iter < iters; iter++)
+    {
+        bench_case->run(iter);
+    }
+    elapsed_ns = bench_now_ns() - start_ns;
+    // Latency, one operation at a time
+    for (iter = 0; iter < lat_iters; iter++)
+    {
+        start_ns = bench_now_ns();
+        bench_case->run(iter);
+        op_ns = bench_now_ns() - start_ns;
+        op_ns = (op_ns > overhead_ns) ? (op_ns - overhead_ns) : 0;
+        samples[iter] = (op_ns > UINT32_MAX) ? UINT32_MAX : (uint32_t) op_ns;
+        bucket = (0 == op_ns) ? 0 : (uint8_t) (64 - __builtin_clzll(op_ns));
+        hist[(bucket < BENCH_HIST_SZ) ? bucket : (BENCH_HIST_SZ - 1)]++;
+    }
+    qsort(samples, lat_iters, sizeof(samples[0]), bench_cmp_u32);
+
+    printf("{\"case\":\"%s\",\"backend\":\"%s\",\"iters\":%u,\"ops_per_sec\":%.0f,"
+           "\"p50_ns\":%u,\"p99_ns\":%u,\"p99_9_ns\":%u,\"max_ns\":%u,\"hist_log2_ns\":[",
+           bench_case->name, backend, iters, (double) iters * 1e9 / (double) (elapsed_ns ? elapsed_ns : 1),
+           samples[(lat_iters * 50) / 100], samples[(lat_iters * 99) / 100],
+           samples[(lat_iters * 999) / 1000], samples[lat_iters - 1]);
+    for (bucket = 0; bucket < BENCH_HIST_SZ; bucket++)
+    {
+        printf("%s%llu", (0 == bucket) ? "" : ",", (unsigned long long) hist[bucket]);
+    }
+    printf("]}\n");
+    fflush(stdout);
+}
+// Run the broker cases as a client of the broker on the socket path
+static int bench_run_broker(const char* path,
+                            const char* only_case,
+                            uint32_t iters,
+                            uint32_t* samples,
+                            uint64_t overhead_ns)
+{
+    /// LOCALS ///
+    // Status of the setup
+    int32_t status   = 0;
+    // Line and case index
+    uint8_t line_ind = 0;
+    uint8_t case_ind = 0;
+
+    if (0 != (status = open_gpio_broker(&bench_broker, path, BENCH_BROKER_PINS)))
+    {
+        fprintf(stderr, "bench: cannot connect to the broker on %s (%d)\n", path, status);
+        return EXIT_FAILURE;
+    }
+    for (line_ind = 0; line_ind < BENCH_NUM_LINES; line_ind++)
+    {
+        if (0 != set_gpio_broker_fn(&bench_broker, BENCH_FIRST_PIN + line_ind, OUTPUT))
+        {
+            fprintf(stderr, "bench: failed to set up pin %u through the broker\n", BENCH_FIRST_PIN + line_ind);
+            close_gpio_broker(&bench_broker);
+            return EXIT_FAILURE;
+        }
+    }
+    fprintf(stderr, "bench: broker on %s, %u iterations, clock overhead %llu ns\n",
+            path, iters, (unsigned long long) overhead_ns);
+    for (case_ind = 0; case_ind < BENCH_BROKER_CASES_SZ; case_ind++)
+    {
+        if ((NULL == only_case) || (0 == strcmp(only_case, BENCH_BROKER_CASES[case_ind].name)))
+        {
+            bench_run_case(&BENCH_BROKER_CASES[case_ind], "broker", iters, samples, overhead_ns);
+        }
+    }
+    // Posted writes report their failures only once applied
+    sync_gpio_broker(&bench_broker);
+    if (0 != gpio_broker_async_errors(&bench_broker))
+    {
+        fprintf(stderr, "bench: %llu posted writes failed\n", (unsigned long long) gpio_broker_async_errors(&bench_broker));
+    }
+    close_gpio_broker(&bench_broker);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[])
+{
+    /// LOCALS ///
+    // Register file, when no device backend is selected
+    const char* regs_path  = BENCH_REGS_PATH;
+    // Backend reported
+    const char* backend    = "regs_file";
+    // Socket of the broker, the broker cases are run when given
+    const char* broker_path = NULL;
+    // Exit status of the broker cases
+    int broker_status      = EXIT_SUCCESS;
+    // Only run the case of this name, all when NULL
+    const char* only_case  = NULL;
+    // Real-time setup, applied when --rt is given
+    gpio_rt_config_t rt_config;
+    bool rt                = false;
+    // Status of the real-time setup
+    int32_t rt_status      = 0;
+    // Backend opened
+    enum GpioBackend chip_backend = BACKEND_DEV_MEM;
+    // Operations per case
+    uint32_t iters         = BENCH_ITERS;
+    // Latency samples
+    uint32_t* samples      = NULL;
+    // Clock read overhead
+    uint64_t overhead_ns   = 0;
+    // Timebase calibration
+    gpio_timebase_info_t timebase;
+    // File descriptor used to create the register file
+    int32_t fd             = -1;
+    // Pin of a configuration line
+    uint8_t config_pin     = 0;
+    // Argument, line and case index
+    int32_t arg_ind        = 0;
+    uint8_t line_ind       = 0;
+    uint8_t case_ind       = 0;
+
+    for (arg_ind = 1; arg_ind < argc; arg_ind++)
+    {
+        if ((0 == strcmp(argv[arg_ind], "--regs")) && (arg_ind + 1 < argc))
+        {
+            regs_path = argv[++arg_ind];
+        }
+        else if (0 == strcmp(argv[arg_ind], "--dev-mem"))
+        {
+            regs_path = NULL;
+            backend   = "dev_mem";
+        }
+        else if (0 == strcmp(argv[arg_ind], "--gpiomem"))
+        {
+            regs_path    = NULL;
+            backend      = "gpiomem";
+            chip_backend = BACKEND_GPIOMEM;
+        }
+        else if (0 == strcmp(argv[arg_ind], "--sim"))
+        {
+            regs_path    = NULL;
+            backend      = "sim";
+            chip_backend = BACKEND_SIM;
+        }
+        else if ((0 == strcmp(argv[arg_ind], "--chardev")) && (arg_ind + 1 < argc))
+        {
+            regs_path    = argv[++arg_ind];
+            backend      = "chardev";
+            chip_backend = BACKEND_CHARDEV;
+        }
+        else if ((0 == strcmp(argv[arg_ind], "--broker")) && (arg_ind + 1 < argc))
+        {
+            broker_path = argv[++arg_ind];
+            backend     = "broker";
+        }
+        else if ((0 == strcmp(argv[arg_ind], "--iters")) && (arg_ind + 1 < argc))
+        {
+            iters = (uint32_t) strtoul(argv[++arg_ind], NULL, 0);
+        }
+        else if ((0 == strcmp(argv[arg_ind], "--case")) && (arg_ind + 1 < argc))
+        {
+            only_case = argv[++arg_ind];
+        }
+        else if ((0 == strcmp(argv[arg_ind], "--rt")) && (arg_ind + 1 < argc))
+        {
+            init_gpio_rt_config(&rt_config);
+            rt_config.cpu = (int32_t) strtol(argv[++arg_ind], NULL, 0);
+            rt            = true;
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--regs PATH | --dev-mem | --gpiomem | --sim | --chardev PATH | --broker PATH] "
+                    "[--iters N] [--case NAME] [--rt CPU]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (0 == iters)
+    {
+        iters = 1;
+    }
+    // The broker owns the chip, only its cases are run
+    if (NULL != broker_path)
+    {
+        if (NULL == (samples = malloc(sizeof(samples[0]) * ((iters < BENCH_LAT_MAX) ? iters : BENCH_LAT_MAX))))
+        {
+            return EXIT_FAILURE;
+        }
+        broker_status = bench_run_broker(broker_path, only_case, iters, samples, bench_timer_overhead_ns());
+        free(samples);
+        return broker_status;
+    }
+
+    // Make sure the register file exists, the chip context does not create files
+    if ((NULL != regs_path) && (BACKEND_CHARDEV != chip_backend) && (-1 != (fd = open(regs_path, O_RDWR | O_CREAT, 0600))))
+    {
+        close(fd);
+    }
+    if (0 != open_gpio_backend(chip_backend, regs_path))
+    {
+        fprintf(stderr, "bench: failed to open the %s backend\n", backend);
+        return EXIT_FAILURE;
+    }
+    for (line_ind = 0; line_ind < BENCH_NUM_LINES; line_ind++)
+    {
+        if ((0 != request_gpio_line(&bench_lines[line_ind], BENCH_FIRST_PIN + line_ind)) ||
+            (0 != set_gpio_fn(&bench_lines[line_ind], OUTPUT)) ||
+            ((BACKEND_CHARDEV != chip_backend) && (0 != config_gpio_fast(&bench_fast[line_ind], &bench_lines[line_ind]))))
+        {
+            fprintf(stderr, "bench: failed to set up pin %u\n", BENCH_FIRST_PIN + line_ind);
+            return EXIT_FAILURE;
+        }
+    }
+    for (line_ind = 0; line_ind < 4; line_ind++)
+    {
+        if ((0 != request_gpio_line(&bench_spi_lines[line_ind], BENCH_SPI_PINS[line_ind])) ||
+            (0 != set_gpio_fn(&bench_spi_lines[line_ind], (3 == line_ind) ? INPUT : OUTPUT)))
+        {
+            fprintf(stderr, "bench: failed to set up SPI pin %u\n", BENCH_SPI_PINS[line_ind]);
+            return EXIT_FAILURE;
+        }
+    }
+    init_gpio_config(&bench_config_modes[0]);
+    init_gpio_config(&bench_config_modes[1]);
+    for (line_ind = 0; line_ind < BENCH_CONFIG_PINS; line_ind++)
+    {
+        config_pin = (line_ind < 16) ? (8 + line_ind) : (40 + line_ind - 16);
+        stage_gpio_fn(&bench_config_modes[0], config_pin, INPUT);
+        stage_gpio_pull(&bench_config_modes[0], config_pin, PULL_UP);
+        stage_gpio_fn(&bench_config_modes[1], config_pin, OUTPUT);
+        stage_gpio_pull(&bench_config_modes[1], config_pin, PULL_NONE);
+        if (0 != request_gpio_line(&bench_config_lines[line_ind], config_pin))
+        {
+            fprintf(stderr, "bench: failed to set up configuration pin %u\n", config_pin);
+            return EXIT_FAILURE;
+        }
+    }
+    if (((BACKEND_CHARDEV != chip_backend) &&
+         (0 != init_gpio_spi(&bench_spi, &bench_spi_lines[0], &bench_spi_lines[1], &bench_spi_lines[2],
+                             &bench_spi_lines[3], SPI_MODE_0, 0))) ||
+        (0 != request_gpio_bulk(&bench_bulk, bench_lines, BENCH_NUM_LINES)) ||
+        (NULL == (samples = malloc(sizeof(samples[0]) * ((iters < BENCH_LAT_MAX) ? iters : BENCH_LAT_MAX)))))
+    {
+        fprintf(stderr, "bench: failed to set up the SPI master or bulk group\n");
+        return EXIT_FAILURE;
+    }
+
+    if (BACKEND_CHARDEV != chip_backend)
+    {
+        bench_set_regs[0] = (volatile uint32_t *)(get_gpio_chip_base() + GPSET0_OFF);
+        bench_set_regs[1] = (volatile uint32_t *)(get_gpio_chip_base() + GPSET1_OFF);
+        bench_clr_regs[0] = (volatile uint32_t *)(get_gpio_chip_base() + GPCLR0_OFF);
+        bench_clr_regs[1] = (volatile uint32_t *)(get_gpio_chip_base() + GPCLR1_OFF);
+        bench_lev_reg     = (volatile uint32_t *)(get_gpio_chip_base() + GPLEV0_OFF);
+    }
+    init_gpio_debounce(&bench_debounce, (GPIO_PIN_BIT(GPIO_PIN_MAX) << 1) - 1, 0x00, BENCH_DEBOUNCE_SAMPLES);
+    memset(bench_debounce_threshold, BENCH_DEBOUNCE_SAMPLES, sizeof(bench_debounce_threshold));
+
+    // After the last allocation of the setup, every case then runs locked and pinned
+    if (rt && (0 != (rt_status = setup_gpio_rt(&rt_config))))
+    {
+        fprintf(stderr, "bench: real-time setup failed (%d)\n", rt_status);
+        return EXIT_FAILURE;
+    }
+    else if (rt)
+    {
+        fprintf(stderr, "bench: real-time setup on CPU %d, SCHED_FIFO %u\n", rt_config.cpu, rt_config.priority);
+    }
+    overhead_ns = bench_timer_overhead_ns();
+    get_gpio_timebase_info(&timebase);
+    fprintf(stderr, "bench: %s backend, %u iterations, clock overhead %llu ns\n",
+            backend, iters, (unsigned long long) overhead_ns);
+    fprintf(stderr, "bench: timebase %s, %llu Hz, resolution %u ns, read %u ns, delay error %u ns (max %u ns)\n",
+            (TIME_SOURCE_CNTVCT == timebase.source) ? "cntvct" : "clock", (unsigned long long) timebase.counter_hz,
+            timebase.resolution_ns, timebase.read_ns, timebase.delay_error_ns, timebase.delay_max_ns);
+    for (case_ind = 0; case_ind < BENCH_CASES_SZ; case_ind++)
+    {
+        if (((NULL == only_case) || (0 == strcmp(only_case, BENCH_CASES[case_ind].name))) &&
+            (!BENCH_CASES[case_ind].regs || (BACKEND_CHARDEV != chip_backend)))
+        {
+            bench_run_case(&BENCH_CASES[case_ind], backend, iters, samples, overhead_ns);
+        }
+    }
+    if (((NULL == only_case) || (0 == strcmp(only_case, "set_gpio_fn_stress"))) && (BACKEND_CHARDEV != chip_backend))
+    {
+        bench_run_stress(backend, iters);
+    }
+    if ((NULL == only_case) || (0 == strcmp(only_case, "rt_jitter")))
+    {
+        bench_run_rt_jitter(backend, iters, 0);
+        bench_run_rt_jitter(backend, (iters / 10) ? (iters / 10) : 1, BENCH_RT_PERIOD_NS);
+    }
+
+    free(samples);
+    release_gpio_bulk(&bench_bulk);
+    for (line_ind = 0; line_ind < BENCH_NUM_LINES; line_ind++)
+    {
+        release_gpio_line(&bench_lines[line_ind]);
+    }
+    for (line_ind = 0; line_ind < 4; line_ind++)
+    {
+        release_gpio_line(&bench_spi_lines[line_ind]);
+    }
+    for (line_ind = 0; line_ind < BENCH_CONFIG_PINS; line_ind++)
+    {
+        release_gpio_line(&bench_config_lines[line_ind]);
+    }
+    close_gpio_chip();
+    return EXIT_SUCCESS;
+}
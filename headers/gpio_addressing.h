@@ -300,9 +300,9 @@
  * ACCESS      : RW
  *               
  */
-#define GPHEN0_OFF 0x58 // pins 0..31, 0 = High detect disabled, 1 = High on GPIO pin n sets
+#define GPHEN0_OFF 0x64 // pins 0..31, 0 = High detect disabled, 1 = High on GPIO pin n sets
                         //             corresponding bit in GPEDS0
-#define GPHEN1_OFF 0x5C // pins 32..57, 0 = High detect disabled, 1 = High on GPIO pin n 
+#define GPHEN1_OFF 0x68 // pins 32..57, 0 = High detect disabled, 1 = High on GPIO pin n 
                         //             corresponding bit in GPEDS1
 
 /* GPIO Low Level Detect Enable Registers 
@@ -315,9 +315,9 @@
  * ACCESS      : RW
  *               
  */
-#define GPLEN0_OFF 0x64 // pins 0..31, 0 = Low detect disabled, 1 = Low on GPIO pin n sets
+#define GPLEN0_OFF 0x70 // pins 0..31, 0 = Low detect disabled, 1 = Low on GPIO pin n sets
                         //             corresponding bit in GPEDS0
-#define GPLEN1_OFF 0x68 // pins 32..57, 0 = Low detect disabled, 1 = Low on GPIO pin n sets
+#define GPLEN1_OFF 0x74 // pins 32..57, 0 = Low detect disabled, 1 = Low on GPIO pin n sets
                         //             corresponding bit in GPEDS1
 
 /* GPIO Asynchronous Rising Edge Detect Enable Registers 
@@ -1,6 +1,22 @@
 #ifndef SRC_GPIOD_H
 #define SRC_GPIOD_H
 #include <stdint.h> 
+#include <gpiod_regs.h>
+#include <gpiod_time.h>
+// Atomic and aligned members of the structures shared with C, std::atomic has the same
+// size and alignment as the C atomic on the supported compilers
+#ifdef __cplusplus
+#include <atomic>
+#define GPIO_ATOMIC(type) std::atomic<type>
+#define GPIO_ALIGNAS(n)   alignas(n)
+#else
+#include <stdatomic.h>
+#define GPIO_ATOMIC(type) _Atomic(type)
+#define GPIO_ALIGNAS(n)   _Alignas(n)
+#endif
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 /// CONSTS & ENUMS ///
 // Error Return Values 
@@ -11,6 +27,31 @@
 #define EPDAT_NULL    -5
 #define EPIN_CONFIG   -6
 #define EOUT_OF_RANGE -7
+#define ECHIP_CLOSED  -8
+#define ETHREAD       -9
+#define EBACKEND      -10
+#define EFILE_IO      -11
+#define EKERNEL       -12
+#define EBROKER       -13
+#define ERT_SETUP     -14
+// The call does not fit the current state, such as reading a trace still being recorded
+#define ESTATE        -15
+// Highest GPIO pin number
+#define GPIO_PIN_MAX  57
+// Lines that may be requested at once, taken from a fixed pool (EMALLOC when exhausted)
+#define GPIO_LINE_POOL_SIZE 64
+// Bit of GPIO pin n in a 64-bit pin word (pins 0..31 in the low half, 32..57 in the high half)
+#define GPIO_PIN_BIT(n) (((uint64_t) 1) << (n))
+// Level of GPIO pin n in a 64-bit pin word, as returned by read_gpio_levels()
+#define GPIO_PIN_LEVEL(levels, n) ((uint8_t) (((levels) >> (n)) & 0x01))
+// Cache line size, keeps data written by different threads apart
+#define GPIO_CACHE_LINE 64
+// Default path mapped by the chip context
+#define GPIO_DEV_MEM_PATH     "/dev/mem"
+// Default path of the GPIO only device, usable without root
+#define GPIO_DEV_GPIOMEM_PATH "/dev/gpiomem"
+// Default GPIO character device, the kernel arbitrates every line request
+#define GPIO_DEV_GPIOCHIP_PATH "/dev/gpiochip0"
 // Function Selection Bit Values
 enum FunctionSelect {
    INPUT  = 0x00,
@@ -22,6 +63,19 @@ enum FunctionSelect {
    ALT_4  = 0x03,
    ALT_5  = 0x02,
 };
+// Pull resistor selection, the value of a pin's GP_PUP_PDN_CNTRL field
+enum PullSelect {
+   PULL_NONE = 0x00,
+   PULL_UP   = 0x01,
+   PULL_DOWN = 0x02,
+};
+// Register backends, selected when the chip context is first opened
+enum GpioBackend {
+   BACKEND_DEV_MEM = 0x00, // /dev/mem, mapped at GPIO_BASE_REG_ADDR, needs root
+   BACKEND_GPIOMEM = 0x01, // /dev/gpiomem, the GPIO block alone mapped at offset 0
+   BACKEND_SIM     = 0x02, // In-memory register simulator, only in GPIOD_SIM builds
+   BACKEND_CHARDEV = 0x03, // /dev/gpiochipN and the v2 line ioctls, no register access
+};
 /// GPIO Structure ///
 // "Private" struct encapsulating member data that is used to manipulate
 // a gpio line (forward declaration)
@@ -33,11 +87,102 @@ typedef struct gpio_line {
     // Private structure
     _gpio_internals_t* priv_dat;
 } gpio_line_t;
+// "Public" struct that represents a group of output lines written together
+typedef struct gpio_bulk {
+    // Pins of the group, GPIO_PIN_BIT(n) set for each pin n
+    uint64_t pin_mask;
+    // Base of the shared register mapping, NULL until requested and on BACKEND_CHARDEV
+    void* _base;
+    // Multi-line request of the group on BACKEND_CHARDEV, -1 otherwise
+    int32_t _fd;
+} gpio_bulk_t;
+// "Public" struct caching everything a fast path write needs, filled once by config_gpio_fast().
+// Valid for as long as the line it was configured from stays requested.
+typedef struct gpio_fast {
+    // Set register of the pin's bank
+    volatile uint32_t* _set_reg;
+    // Clear register of the pin's bank
+    volatile uint32_t* _clr_reg;
+    // Bit of the pin in its bank
+    uint32_t _pin_mask;
+} gpio_fast_t;
 /// FUNCTIONS ///
-/* Request a GPIO line */
+/* Open the process-wide GPIO chip context, NULL maps GPIO_DEV_MEM_PATH. A regular file may be
+ * given instead of a device, in which case it is mapped from offset 0 (grown to the register
+ * range if needed) so the library can be exercised without the hardware. The chip context is
+ * reference counted, every open must be balanced by a close. */
+int32_t open_gpio_chip(const char*);
+/* Open the GPIO chip context on a backend, NULL selects the backend's default path. If the context
+ * is already open this only takes a reference, the backend of the first open is kept.
+ * On BACKEND_CHARDEV each line is a kernel line request and a bulk group is one multi-line request.
+ * Lines support the INPUT and OUTPUT functions, pulls, and edge events through poll_gpio_events()
+ * with kernel timestamps. Everything that needs the registers (fast path handles, level snapshots,
+ * register updates and configuration commits, and the modules built on them) returns EBACKEND.
+ * A group's lines must share their direction and bias. A line the kernel will not give its own
+ * request back when its group fails or is released returns EKERNEL until it is released. */
+int32_t open_gpio_backend(enum GpioBackend, const char*);
+/* Drop a reference on the GPIO chip context, the mapping is torn down with the last reference */
+int32_t close_gpio_chip(void);
+/* Base of the shared register mapping, NULL while the chip context is closed. Lets other
+ * layers (the C++ pin templates) address registers through the library's one mapping. */
+void* get_gpio_chip_base(void);
+/* Request a GPIO line, opens the chip context on GPIO_DEV_MEM_PATH if not already open */
 int32_t request_gpio_line(gpio_line_t*, uint8_t);
+/* Release a GPIO line, dropping its reference on the chip context */
+int32_t release_gpio_line(gpio_line_t*);
 /* Write the GPIO Pin n, either high or low */
 int32_t write_gpio(gpio_line_t *, uint8_t);
+/* Read the level of the GPIO Pin n, returns 0 (low), 1 (high) or an error */
+int32_t read_gpio(gpio_line_t *);
+/* Snapshot the levels of all pins, GPLEV0 and GPLEV1 are each read once */
+int32_t read_gpio_levels(uint64_t *);
 /* Set the pin function for the GPIO Pin n, use the enum above */
 int32_t set_gpio_fn(gpio_line_t *, enum FunctionSelect);
+/* Select the pull resistor of the GPIO Pin n, use the enum above */
+int32_t set_gpio_pull(gpio_line_t *, enum PullSelect);
+/* Read-modify-write the register at a byte offset from the chip base under its register lock, the
+ * bits of mask (second argument) take their value from bits. For layers addressing registers
+ * directly (the C++ pin templates) so their updates of shared registers are not lost. */
+int32_t update_gpio_reg(uint32_t, uint32_t, uint32_t);
+/* Request a bulk group over already requested lines, every line must be configured as OUTPUT */
+int32_t request_gpio_bulk(gpio_bulk_t *, gpio_line_t *, uint8_t);
+/* Write the pins selected by mask to their bit in value, at most one store each to GPSET0/1 and GPCLR0/1 */
+int32_t write_gpio_bulk(gpio_bulk_t *, uint64_t, uint64_t);
+/* Release a bulk group */
+int32_t release_gpio_bulk(gpio_bulk_t *);
+/* Configure a fast path handle from a requested line, the line must be configured as OUTPUT */
+int32_t config_gpio_fast(gpio_fast_t *, gpio_line_t *);
+/* Timestamped variants, the last argument receives the timebase time (gpio_time_ns()) taken as the
+ * operation completes: after the write was issued, or after the value was read */
+int32_t write_gpio_ts(gpio_line_t *, uint8_t, uint64_t *);
+int32_t read_gpio_ts(gpio_line_t *, uint64_t *);
+int32_t read_gpio_levels_ts(uint64_t *, uint64_t *);
+int32_t write_gpio_bulk_ts(gpio_bulk_t *, uint64_t, uint64_t, uint64_t *);
+/// FAST PATH ///
+// No checks are made here, the handle was validated by config_gpio_fast(). SET/CLR are write only
+// and writing a 0 has no effect, so a write is a single store of the cached pin bit.
+/* Drive the fast path pin high */
+static inline void set_gpio_fast(const gpio_fast_t * fast)
+{
+    gpio_reg_write(fast->_set_reg, fast->_pin_mask);
+}
+/* Drive the fast path pin low */
+static inline void clear_gpio_fast(const gpio_fast_t * fast)
+{
+    gpio_reg_write(fast->_clr_reg, fast->_pin_mask);
+}
+/* Write the fast path pin, either high (non-zero) or low */
+static inline void write_gpio_fast(const gpio_fast_t * fast, uint8_t high_low)
+{
+    gpio_reg_write(high_low ? fast->_set_reg : fast->_clr_reg, fast->_pin_mask);
+}
+/* Write the fast path pin and timestamp the store */
+static inline void write_gpio_fast_ts(const gpio_fast_t * fast, uint8_t high_low, uint64_t * stamp_ns)
+{
+    gpio_reg_write(high_low ? fast->_set_reg : fast->_clr_reg, fast->_pin_mask);
+    *stamp_ns = gpio_time_ns();
+}
+#ifdef __cplusplus
+}
+#endif
 #endif
@@ -0,0 +1,245 @@
+#ifndef SRC_GPIOD_HPP
+#define SRC_GPIOD_HPP
+#include <cstdint>
+#include <gpiod.h>
+#include <gpiod_regs.h>
+#include <gpio_addressing.h>
+
+/*******************************************************************************/
+//
+// DESCRIPTION : Header only C++ layer for pins fixed at compile time.
+//
+// DETAILS     : Pin<N> and PinGroup<N...> work out every register offset, shift and
+//               mask from the pin numbers with constexpr, so none of the divisions
+//               request_gpio_line() makes at runtime are left in the generated code.
+//               Out of range pins fail to compile against GPIO_PIN_MAX. A pin write
+//               is a single store to GPSET/GPCLR at a constant offset from the base.
+//               There is no mapping of its own, the base is taken from the C library's
+//               chip context (get_gpio_chip_base()) when the object is constructed,
+//               so the chip must be open first (see Chip) and stay open while the
+//               objects are used. Like the fast path in gpiod.h nothing is checked on
+//               a write, valid() tells whether the base was there to take. Function
+//               and pull changes go through update_gpio_reg() so they take the same
+//               register locks as the C library.
+//
+/*******************************************************************************/
+
+namespace gpiod
+{
+/// CONSTS ///
+// Pins per function select register, 3 bits each
+static constexpr uint8_t PINS_PER_FSEL_REG    = 10;
+// Pins per pull-up/pull-down register, 2 bits each
+static constexpr uint8_t PINS_PER_PUP_PDN_REG = 16;
+// Pins per 1-bit mapped register
+static constexpr uint8_t PINS_PER_BIT_REG     = 32;
+// Function select field of one pin
+static constexpr uint32_t FSEL_FIELD_MASK     = 0x07;
+// Pull-up/pull-down field of one pin
+static constexpr uint32_t PUP_PDN_FIELD_MASK  = 0x03;
+// Index of the last function select register
+static constexpr uint8_t FSEL_LAST_REG        = GPIO_PIN_MAX / PINS_PER_FSEL_REG;
+
+/// CHIP ///
+// Scoped reference on the chip context, the C library's open/close are reference counted
+// so a Chip may live alongside lines requested through the C API.
+class Chip
+{
+public:
+    /* Open the chip context, NULL maps GPIO_DEV_MEM_PATH */
+    explicit Chip(const char* path = nullptr) : _open_retval(open_gpio_chip(path)) {}
+    /* Open the chip context on a backend */
+    explicit Chip(enum GpioBackend backend, const char* path = nullptr) : _open_retval(open_gpio_backend(backend, path)) {}
+    /* Drop the reference taken on construction */
+    ~Chip()
+    {
+        if (0 == _open_retval)
+        {
+            close_gpio_chip();
+        }
+    }
+    Chip(const Chip&)            = delete;
+    Chip& operator=(const Chip&) = delete;
+    /* Return value of the open, 0 on success */
+    int32_t status() const { return _open_retval; }
+private:
+    // Return value of the open
+    int32_t _open_retval;
+};
+
+/// PIN ///
+// One pin fixed at compile time
+template <uint8_t N>
+class Pin
+{
+    static_assert(N <= GPIO_PIN_MAX, "GPIO pin out of range");
+public:
+    // The pin number
+    static constexpr uint8_t PIN           = N;
+    // Bit of the pin in a 64-bit pin word
+    static constexpr uint64_t MASK         = GPIO_PIN_BIT(N);
+    // Bit of the pin in its 1-bit mapped bank
+    static constexpr uint32_t BIT          = ((uint32_t) 1) << (N % PINS_PER_BIT_REG);
+    // 1-bit mapped bank of the pin
+    static constexpr uint8_t BANK          = N / PINS_PER_BIT_REG;
+    // Set, clear and level register offsets
+    static constexpr uint32_t SET_OFF      = (0 == BANK) ? GPSET0_OFF : GPSET1_OFF;
+    static constexpr uint32_t CLR_OFF      = (0 == BANK) ? GPCLR0_OFF : GPCLR1_OFF;
+    static constexpr uint32_t LEV_OFF      = (0 == BANK) ? GPLEV0_OFF : GPLEV1_OFF;
+    // Function select register offset, shift and field mask
+    static constexpr uint32_t FSEL_OFF     = GPFN_SEL0_OFF + ((N / PINS_PER_FSEL_REG) * GPIO_REG_SIZE);
+    static constexpr uint32_t FSEL_SHIFT   = (N % PINS_PER_FSEL_REG) * 3;
+    static constexpr uint32_t FSEL_MASK    = FSEL_FIELD_MASK << FSEL_SHIFT;
+    // Bits of the function select register that may be written
+    static constexpr uint32_t FSEL_WRITE   = ((N / PINS_PER_FSEL_REG) == FSEL_LAST_REG) ?
+                                                 GPREG5_3BIT_WRITE_MASK : GPREG0_4_3BIT_WRITE_MASK;
+    // Pull-up/pull-down register offset, shift and field mask
+    static constexpr uint32_t PUP_PDN_OFF   = GP_PUP_PDN_CNTRL_REG0 + ((N / PINS_PER_PUP_PDN_REG) * GPIO_REG_SIZE);
+    static constexpr uint32_t PUP_PDN_SHIFT = (N % PINS_PER_PUP_PDN_REG) * 2;
+    static constexpr uint32_t PUP_PDN_MASK  = PUP_PDN_FIELD_MASK << PUP_PDN_SHIFT;
+
+    /* Take the base of the chip context mapping */
+    Pin() : _base((volatile uint32_t *) get_gpio_chip_base()) {}
+    /* Whether the chip context was open when the pin was constructed */
+    bool valid() const { return nullptr != _base; }
+    /* Drive the pin high */
+    void set() const { gpio_reg_write(_reg(SET_OFF), BIT); }
+    /* Drive the pin low */
+    void clear() const { gpio_reg_write(_reg(CLR_OFF), BIT); }
+    /* Write the pin, either high (true) or low */
+    void write(bool high_low) const { gpio_reg_write(_reg(high_low ? SET_OFF : CLR_OFF), BIT); }
+    /* Level of the pin */
+    bool read() const { return 0 != (gpio_reg_read(_reg(LEV_OFF)) & BIT); }
+    /* Set the pin function, a read-modify-write of the one function select register under its lock */
+    void set_fn(enum FunctionSelect fn) const
+    {
+        update_gpio_reg(FSEL_OFF, FSEL_MASK, (((uint32_t) fn) << FSEL_SHIFT) & FSEL_WRITE);
+    }
+    /* Function of the pin */
+    enum FunctionSelect get_fn() const
+    {
+        return (enum FunctionSelect) ((gpio_reg_read(_reg(FSEL_OFF)) >> FSEL_SHIFT) & FSEL_FIELD_MASK);
+    }
+    /* Set the pin pull, a read-modify-write of the one pull-up/pull-down register under its lock */
+    void set_pull(enum PullSelect pull) const
+    {
+        update_gpio_reg(PUP_PDN_OFF, PUP_PDN_MASK, (((uint32_t) pull) << PUP_PDN_SHIFT) & PUP_PDN_MASK);
+    }
+    /* Pull of the pin */
+    enum PullSelect get_pull() const
+    {
+        return (enum PullSelect) ((gpio_reg_read(_reg(PUP_PDN_OFF)) >> PUP_PDN_SHIFT) & PUP_PDN_FIELD_MASK);
+    }
+private:
+    /* Register at a byte offset from the base */
+    volatile uint32_t* _reg(uint32_t offset) const { return _base + (offset / GPIO_REG_SIZE); }
+    // Base of the shared register mapping
+    volatile uint32_t* _base;
+};
+
+/// PIN GROUP ///
+// Pins fixed at compile time, written together with at most one store per register
+template <uint8_t... N>
+class PinGroup
+{
+    static_assert(sizeof...(N) > 0, "empty GPIO pin group");
+    static_assert(((N <= GPIO_PIN_MAX) && ...), "GPIO pin out of range");
+public:
+    // Pins of the group in a 64-bit pin word
+    static constexpr uint64_t MASK  = (GPIO_PIN_BIT(N) | ...);
+    static_assert(__builtin_popcountll(MASK) == sizeof...(N), "GPIO pin repeated in group");
+    // Pins of the group in bank 0 and bank 1
+    static constexpr uint32_t MASK0 = (uint32_t) MASK;
+    static constexpr uint32_t MASK1 = (uint32_t) (MASK >> PINS_PER_BIT_REG);
+
+    /* Take the base of the chip context mapping */
+    PinGroup() : _base((volatile uint32_t *) get_gpio_chip_base()) {}
+    /* Whether the chip context was open when the group was constructed */
+    bool valid() const { return nullptr != _base; }
+    /* Drive every pin of the group high */
+    void set() const
+    {
+        if constexpr (0 != MASK0) gpio_reg_write(_reg(GPSET0_OFF), MASK0);
+        if constexpr (0 != MASK1) gpio_reg_write(_reg(GPSET1_OFF), MASK1);
+    }
+    /* Drive every pin of the group low */
+    void clear() const
+    {
+        if constexpr (0 != MASK0) gpio_reg_write(_reg(GPCLR0_OFF), MASK0);
+        if constexpr (0 != MASK1) gpio_reg_write(_reg(GPCLR1_OFF), MASK1);
+    }
+    /* Write every pin of the group to its bit in a 64-bit pin word. Writing 0 to SET/CLR has no
+     * effect, so both are stored unconditionally rather than branching on the levels. */
+    void write(uint64_t levels) const
+    {
+        if constexpr (0 != MASK0)
+        {
+            gpio_reg_write(_reg(GPSET0_OFF), ((uint32_t) levels) & MASK0);
+            gpio_reg_write(_reg(GPCLR0_OFF), ~((uint32_t) levels) & MASK0);
+        }
+        if constexpr (0 != MASK1)
+        {
+            gpio_reg_write(_reg(GPSET1_OFF), ((uint32_t) (levels >> PINS_PER_BIT_REG)) & MASK1);
+            gpio_reg_write(_reg(GPCLR1_OFF), ~((uint32_t) (levels >> PINS_PER_BIT_REG)) & MASK1);
+        }
+    }
+    /* Write levels known at compile time, registers with nothing to change are not touched */
+    template <uint64_t LEVELS>
+    void write() const
+    {
+        if constexpr (0 != (LEVELS & MASK0))  gpio_reg_write(_reg(GPSET0_OFF), (uint32_t) (LEVELS & MASK0));
+        if constexpr (0 != (~LEVELS & MASK0)) gpio_reg_write(_reg(GPCLR0_OFF), (uint32_t) (~LEVELS & MASK0));
+        if constexpr (0 != ((LEVELS >> PINS_PER_BIT_REG) & MASK1))
+            gpio_reg_write(_reg(GPSET1_OFF), (uint32_t) ((LEVELS >> PINS_PER_BIT_REG) & MASK1));
+        if constexpr (0 != ((~LEVELS >> PINS_PER_BIT_REG) & MASK1))
+            gpio_reg_write(_reg(GPCLR1_OFF), (uint32_t) ((~LEVELS >> PINS_PER_BIT_REG) & MASK1));
+    }
+    /* Levels of the group's pins as a 64-bit pin word, other pins read as 0 */
+    uint64_t read() const
+    {
+        uint64_t levels = 0x00;
+        if constexpr (0 != MASK0) levels |= gpio_reg_read(_reg(GPLEV0_OFF)) & MASK0;
+        if constexpr (0 != MASK1) levels |= ((uint64_t) (gpio_reg_read(_reg(GPLEV1_OFF)) & MASK1)) << PINS_PER_BIT_REG;
+        return levels;
+    }
+    /* Set the function of every pin in the group, one locked read-modify-write per function select register */
+    void set_fn(enum FunctionSelect fn) const
+    {
+        _set_fn_reg<0>(fn);
+        _set_fn_reg<1>(fn);
+        _set_fn_reg<2>(fn);
+        _set_fn_reg<3>(fn);
+        _set_fn_reg<4>(fn);
+        _set_fn_reg<5>(fn);
+    }
+private:
+    static_assert(5 == FSEL_LAST_REG, "function select registers changed");
+    /* Lowest field bit of each group pin in function select register R */
+    template <uint8_t R>
+    static constexpr uint32_t _fsel_ones()
+    {
+        return ((((N / PINS_PER_FSEL_REG) == R) ? (((uint32_t) 1) << ((N % PINS_PER_FSEL_REG) * 3)) : 0) | ...);
+    }
+    /* Update function select register R, if any pin of the group is in it */
+    template <uint8_t R>
+    void _set_fn_reg(enum FunctionSelect fn) const
+    {
+        // Field bits owned by the group in this register
+        constexpr uint32_t fsel_mask  = _fsel_ones<R>() * FSEL_FIELD_MASK;
+        // Bits of the register that may be written
+        constexpr uint32_t fsel_write = (R == FSEL_LAST_REG) ? GPREG5_3BIT_WRITE_MASK : GPREG0_4_3BIT_WRITE_MASK;
+        // The register
+        constexpr uint32_t fsel_off   = GPFN_SEL0_OFF + (R * GPIO_REG_SIZE);
+
+        if constexpr (0 != fsel_mask)
+        {
+            update_gpio_reg(fsel_off, fsel_mask, (_fsel_ones<R>() * (uint32_t) fn) & fsel_write);
+        }
+    }
+    /* Register at a byte offset from the base */
+    volatile uint32_t* _reg(uint32_t offset) const { return _base + (offset / GPIO_REG_SIZE); }
+    // Base of the shared register mapping
+    volatile uint32_t* _base;
+};
+}
+#endif
@@ -0,0 +1,238 @@
+#ifndef SRC_GPIOD_BROKER_H
+#define SRC_GPIOD_BROKER_H
+#include <stdint.h>
+#include <stdbool.h>
+#include <gpiod.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*******************************************************************************/
+//
+// DESCRIPTION : GPIO broker, one process owning the chip and serving the pins to
+//               client processes through shared memory.
+//
+// DETAILS     : The broker (src/main.c) opens the backend once and listens on a
+//               Unix socket. A client connects and names the pins it wants. The
+//               broker requests those lines, unless another client owns one of
+//               them, and hands back a shared-memory segment over the socket
+//               (SCM_RIGHTS). The segment is private to that client and holds a
+//               command ring and a response ring. Each ring has one producer and
+//               one consumer, so neither side takes a lock, as in gpiod_poller.h.
+//               Clients need no access to /dev/mem, only to the socket.
+//               The broker thread spins over the command rings. Writes from every
+//               client in one pass are merged into pending SET/CLR words and stored
+//               together, at most one store per register. A write touching a pin
+//               already pending with the other level is stored first, so no level a
+//               client asks for is skipped. A command that reads or configures
+//               stores the pending writes before it runs. Responses are published
+//               at the end of the pass, after the stores.
+//               After GPIO_BROKER_IDLE_NS without a command the broker sleeps on an
+//               eventfd it shares with every client. A client that posts a command
+//               while the broker sleeps writes that eventfd once. A client waiting
+//               for a response, and the broker waiting for a command, spin for
+//               GPIO_BROKER_SPINS passes, then yield.
+//               Accepted sockets are non-blocking and wait in a pending slot until
+//               their handshake has arrived, so a client that connects and says
+//               nothing never stalls the others. It is closed after
+//               GPIO_BROKER_HELLO_NS.
+//               A client connection must only be used from one thread at a time.
+//               Closing it, or the client exiting, releases its pins.
+//
+/*******************************************************************************/
+
+/// CONSTS & ENUMS ///
+// Default socket of the broker
+#define GPIO_BROKER_SOCKET_PATH  "/run/gpiod-broker.sock"
+// Handshake and segment magic, "GPBR"
+#define GPIO_BROKER_MAGIC        0x52425047
+// Protocol version
+#define GPIO_BROKER_VERSION      1
+// Most clients served at once
+#define GPIO_BROKER_MAX_CLIENTS  16
+// Entries of each ring, a power of two
+#define GPIO_BROKER_RING_SIZE    256
+// Commands taken from one client per pass, keeps a busy client from starving the others
+#define GPIO_BROKER_BATCH        64
+// Time without a command before the broker stops spinning and sleeps, in nanoseconds
+#define GPIO_BROKER_IDLE_NS      1000000
+// Time a connection has to send its handshake before it is closed, in nanoseconds
+#define GPIO_BROKER_HELLO_NS     100000000
+// Passes between checks of the socket for connections while busy
+#define GPIO_BROKER_POLL_PASSES  4096
+// Spins of a waiting client, or empty passes of the broker, before it yields the CPU
+#define GPIO_BROKER_SPINS        4096
+// Command flag, no response is sent and a failure is only counted
+#define GPIO_BROKER_NO_REPLY     0x01
+// Operations
+enum GpioBrokerOp {
+    BROKER_WRITE       = 0x00, // Drive set_bits high and clr_bits low
+    BROKER_READ_LEVELS = 0x01, // Levels of the client's pins
+    BROKER_SET_FN      = 0x02, // Function of one pin
+    BROKER_SET_PULL    = 0x03, // Pull of one pin
+    BROKER_SYNC        = 0x04, // Nothing, answered once every earlier command has been applied
+};
+/// GPIO Broker Protocol Structures ///
+// Handshake sent by a client
+typedef struct gpio_broker_hello {
+    // GPIO_BROKER_MAGIC and GPIO_BROKER_VERSION
+    uint32_t magic;
+    uint32_t version;
+    // Pins the client wants
+    uint64_t pin_mask;
+} gpio_broker_hello_t;
+// Handshake answer, carries the segment and the wake eventfd when status is 0
+typedef struct gpio_broker_welcome {
+    // GPIO_BROKER_MAGIC and GPIO_BROKER_VERSION
+    uint32_t magic;
+    uint32_t version;
+    // 0, or why the client was refused
+    int32_t status;
+    uint32_t _reserved;
+} gpio_broker_welcome_t;
+// One command
+typedef struct gpio_broker_cmd {
+    // Pins driven high and low by BROKER_WRITE
+    uint64_t set_bits;
+    uint64_t clr_bits;
+    // Sequence number, echoed by the response
+    uint32_t seq;
+    // enum GpioBrokerOp
+    uint8_t op;
+    // Pin of BROKER_SET_FN and BROKER_SET_PULL
+    uint8_t pin;
+    // enum FunctionSelect or enum PullSelect
+    uint8_t arg;
+    // GPIO_BROKER_NO_REPLY or 0
+    uint8_t flags;
+} gpio_broker_cmd_t;
+// One response
+typedef struct gpio_broker_resp {
+    // Levels of BROKER_READ_LEVELS
+    uint64_t value;
+    // Sequence number of the command
+    uint32_t seq;
+    // Return value of the command
+    int32_t status;
+} gpio_broker_resp_t;
+// Segment shared by the broker and one client
+typedef struct gpio_broker_shm {
+    // GPIO_BROKER_MAGIC and GPIO_BROKER_VERSION
+    uint32_t magic;
+    uint32_t version;
+    // Pins the client owns
+    uint64_t pin_mask;
+    // Next command slot, written by the client only
+    GPIO_ALIGNAS(GPIO_CACHE_LINE) GPIO_ATOMIC(uint32_t) _cmd_head;
+    // Next command taken, written by the broker only
+    GPIO_ALIGNAS(GPIO_CACHE_LINE) GPIO_ATOMIC(uint32_t) _cmd_tail;
+    // Next response slot, written by the broker only
+    GPIO_ALIGNAS(GPIO_CACHE_LINE) GPIO_ATOMIC(uint32_t) _resp_head;
+    // Next response taken, written by the client only
+    GPIO_ALIGNAS(GPIO_CACHE_LINE) GPIO_ATOMIC(uint32_t) _resp_tail;
+    // Set by the broker before it sleeps, the client clearing it writes the wake eventfd
+    GPIO_ALIGNAS(GPIO_CACHE_LINE) GPIO_ATOMIC(bool) _broker_idle;
+    // Commands posted with GPIO_BROKER_NO_REPLY that failed
+    GPIO_ATOMIC(uint64_t) _async_errors;
+    // The rings
+    gpio_broker_cmd_t _cmds[GPIO_BROKER_RING_SIZE];
+    gpio_broker_resp_t _resps[GPIO_BROKER_RING_SIZE];
+} gpio_broker_shm_t;
+/// GPIO Broker Structures ///
+// Client side of a connection
+typedef struct gpio_broker_client {
+    // Pins owned
+    uint64_t pin_mask;
+    // The segment
+    gpio_broker_shm_t* _shm;
+    // Socket to the broker, its hangup tells the broker the client is gone
+    int32_t _sock;
+    // Eventfd waking the broker
+    int32_t _wake_fd;
+    // Sequence number of the next command
+    uint32_t _seq;
+} gpio_broker_client_t;
+// Broker side of a connection
+typedef struct _gpio_broker_conn {
+    // Socket to the client, -1 for a free slot
+    int32_t _sock;
+    // The segment
+    gpio_broker_shm_t* _shm;
+    // Pins owned
+    uint64_t _pin_mask;
+    // Next response slot, published to the segment at the end of the pass
+    uint32_t _resp_head;
+} _gpio_broker_conn_t;
+// Connection accepted and still sending its handshake
+typedef struct _gpio_broker_pending {
+    // Socket to the client, -1 for a free slot
+    int32_t _sock;
+    // Bytes of the handshake received
+    uint32_t _len;
+    // Time of the accept
+    uint64_t _accept_ns;
+    // The handshake, filled as it arrives
+    gpio_broker_hello_t _hello;
+} _gpio_broker_pending_t;
+// The broker
+typedef struct gpio_broker {
+    // Connections
+    _gpio_broker_conn_t _conns[GPIO_BROKER_MAX_CLIENTS];
+    // Connections in their handshake
+    _gpio_broker_pending_t _pending[GPIO_BROKER_MAX_CLIENTS];
+    // One line per pin, requested while a client owns the pin
+    gpio_line_t _lines[GPIO_PIN_MAX + 1];
+    // Pins owned by any client, and those of them configured as OUTPUT
+    uint64_t _owned;
+    uint64_t _outputs;
+    // Writes merged and not yet stored
+    uint64_t _pending_set;
+    uint64_t _pending_clr;
+    // Listening socket
+    int32_t _listen_fd;
+    // Eventfd the broker sleeps on
+    int32_t _wake_fd;
+    // Cleared to stop the broker
+    GPIO_ATOMIC(bool) _running;
+    // Socket path, unlinked on release
+    char _path[108];
+    // Commands run, write commands among them, and the SET/CLR flushes they were stored in
+    uint64_t commands;
+    uint64_t writes;
+    uint64_t flushes;
+} gpio_broker_t;
+/// FUNCTIONS ///
+/* Broker: listen on the socket path (NULL for GPIO_BROKER_SOCKET_PATH), creating it with the given mode.
+ * A stale socket is replaced. EBROKER when the socket cannot be set up, when a broker already listens
+ * there, or when the path holds anything but a socket */
+int32_t init_gpio_broker(gpio_broker_t *, const char *, uint32_t);
+/* Broker: serve clients until stop_gpio_broker() */
+int32_t run_gpio_broker(gpio_broker_t *);
+/* Broker: make run_gpio_broker() return, safe from a signal handler */
+void stop_gpio_broker(gpio_broker_t *);
+/* Broker: drop every client, release their lines and remove the socket */
+int32_t release_gpio_broker(gpio_broker_t *);
+/* Client: connect to the broker at the socket path (NULL for the default) and claim the pins in mask.
+ * EBROKER when the broker cannot be reached, EBAD_PIN for pins past GPIO_PIN_MAX, EPIN_CONFIG when
+ * another client owns one of the pins, EMALLOC when the broker serves too many clients */
+int32_t open_gpio_broker(gpio_broker_client_t *, const char *, uint64_t);
+/* Client: disconnect, the broker releases the pins */
+int32_t close_gpio_broker(gpio_broker_client_t *);
+/* Client: drive the pins in mask to their bit in value and wait until it is done */
+int32_t write_gpio_broker(gpio_broker_client_t *, uint64_t, uint64_t);
+/* Client: drive the pins in mask to their bit in value without waiting, failures are only counted */
+int32_t post_gpio_broker_write(gpio_broker_client_t *, uint64_t, uint64_t);
+/* Client: levels of the client's pins, as a 64-bit pin word */
+int32_t read_gpio_broker_levels(gpio_broker_client_t *, uint64_t *);
+/* Client: set the function of an owned pin */
+int32_t set_gpio_broker_fn(gpio_broker_client_t *, uint8_t, enum FunctionSelect);
+/* Client: set the pull of an owned pin */
+int32_t set_gpio_broker_pull(gpio_broker_client_t *, uint8_t, enum PullSelect);
+/* Client: wait until every command posted so far has been applied */
+int32_t sync_gpio_broker(gpio_broker_client_t *);
+/* Client: posted writes that failed */
+uint64_t gpio_broker_async_errors(gpio_broker_client_t *);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,108 @@
+#ifndef SRC_GPIOD_CAPTURE_H
+#define SRC_GPIOD_CAPTURE_H
+#include <stdint.h>
+#include <stdbool.h>
+#include <gpiod.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*******************************************************************************/
+// 
+// DESCRIPTION : Logic-analyzer capture of every pin into a memory mapped ring file.
+//
+// DETAILS     : The capture loop samples GPLEV0/1 as fast as the calling thread
+//               runs and stores a record only when a watched pin changed: the time
+//               since the previous record and the 64-bit level word. Records go into
+//               a ring preallocated and pre-faulted in the capture file, so the hot
+//               path never allocates, never makes a system call and never faults.
+//               Once the ring wraps the oldest records are overwritten, the header
+//               keeps the time base of the oldest record still held.
+//               A delta holds up to 2^32 - 1 ns. A longer stretch without a change,
+//               or the idle time before a capture is resumed, is bridged by records
+//               that repeat the levels held.
+//               A gap between two samples longer than the configured limit counts as
+//               a drop: a pulse shorter than the gap may have gone unseen.
+//
+/*******************************************************************************/
+
+/// CONSTS & ENUMS ///
+// Capture file magic, "GPCP"
+#define GPIO_CAPTURE_MAGIC   0x50435047
+// Capture file version
+#define GPIO_CAPTURE_VERSION 2
+/// GPIO Capture Structures ///
+// One record, a level change
+typedef struct __attribute__((packed)) gpio_capture_record {
+    // Levels of every pin after the change, as a 64-bit pin word
+    uint64_t levels;
+    // Time since the previous record, in nanoseconds
+    uint32_t delta_ns;
+} gpio_capture_record_t;
+// Capture file header, followed by capacity records
+typedef struct gpio_capture_header {
+    // GPIO_CAPTURE_MAGIC
+    uint32_t magic;
+    // GPIO_CAPTURE_VERSION
+    uint32_t version;
+    // Records the ring holds
+    uint64_t capacity;
+    // Records written since the start, the next slot is head % capacity
+    uint64_t head;
+    // Time of the oldest record still held, in nanoseconds
+    uint64_t base_ns;
+    // Time of the newest record, the next delta counts from it, in nanoseconds
+    uint64_t last_ns;
+    // Pins watched for changes
+    uint64_t pin_mask;
+    // Samples taken
+    uint64_t samples;
+    // Samples further apart than max_gap_ns
+    uint64_t drops;
+    // Longest gap between samples that is not a drop, in nanoseconds
+    uint64_t max_gap_ns;
+    // Time spent capturing, in nanoseconds
+    uint64_t elapsed_ns;
+} gpio_capture_header_t;
+// Capture statistics
+typedef struct gpio_capture_stats {
+    // Samples taken
+    uint64_t samples;
+    // Records written, including those since overwritten
+    uint64_t records;
+    // Samples further apart than the gap limit
+    uint64_t drops;
+    // Samples per second
+    double samples_per_sec;
+    // Fraction of samples that were drops
+    double drop_rate;
+} gpio_capture_stats_t;
+// An open capture
+typedef struct gpio_capture {
+    // Header of the mapped file
+    gpio_capture_header_t* _header;
+    // Records of the mapped file
+    gpio_capture_record_t* _records;
+    // Size of the mapping
+    uint64_t _map_size;
+    // Cleared to stop the capture loop
+    GPIO_ATOMIC(bool) _running;
+} gpio_capture_t;
+/// FUNCTIONS ///
+/* Create the capture file with room for capacity records of the watched pins, samples further apart
+ * than max_gap_ns count as drops. The file is preallocated and mapped. */
+int32_t open_gpio_capture(gpio_capture_t *, const char *, uint64_t, uint64_t, uint64_t);
+/* Capture on the calling thread for duration_ns, 0 captures until stop_gpio_capture() */
+int32_t run_gpio_capture(gpio_capture_t *, uint64_t);
+/* Stop a running capture */
+int32_t stop_gpio_capture(gpio_capture_t *);
+/* Statistics of the capture so far */
+int32_t get_gpio_capture_stats(gpio_capture_t *, gpio_capture_stats_t *);
+/* Flush and unmap the capture file */
+int32_t close_gpio_capture(gpio_capture_t *);
+/* Decode a capture file into a VCD file, one wire per watched pin */
+int32_t export_gpio_capture_vcd(const char *, const char *);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,52 @@
+#ifndef SRC_GPIOD_CONFIG_H
+#define SRC_GPIOD_CONFIG_H
+#include <stdint.h>
+#include <gpiod.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*******************************************************************************/
+// 
+// DESCRIPTION : Configuration transactions, many pins reconfigured in one pass.
+//
+// DETAILS     : Function select, pull resistor and event detect enable settings
+//               are staged per pin into a transaction without touching the
+//               hardware. Staging only records, per register, which bits change
+//               and to what. A commit then visits each touched register once: one
+//               read and one write, or a write alone when every writable bit of the
+//               register was staged. Function selects are committed first, then
+//               pulls, then detect enables, so an edge detector is never armed on a
+//               pin still in its old function. A transaction is not consumed by its
+//               commit, a board mode can be staged once and committed on every
+//               switch to it. Commits need the chip context to be open.
+//
+/*******************************************************************************/
+
+/// CONSTS & ENUMS ///
+// Registers a transaction may touch: GPFSEL0..5, GP_PUP_PDN_CNTRL_REG0..3 and both banks
+// of the REN/FEN/HEN/LEN/AREN/AFEN detect enables
+#define GPIO_CONFIG_REGS (6 + 4 + 12)
+/// GPIO Config Structure ///
+// A configuration transaction
+typedef struct gpio_config {
+    // Bits staged in each register, only these are changed by a commit
+    uint32_t _mask[GPIO_CONFIG_REGS];
+    // Staged value of those bits
+    uint32_t _bits[GPIO_CONFIG_REGS];
+} gpio_config_t;
+/// FUNCTIONS ///
+/* Start an empty transaction */
+int32_t init_gpio_config(gpio_config_t *);
+/* Stage the function of pin n, a later stage of the same pin replaces it */
+int32_t stage_gpio_fn(gpio_config_t *, uint8_t, enum FunctionSelect);
+/* Stage the pull resistor of pin n */
+int32_t stage_gpio_pull(gpio_config_t *, uint8_t, enum PullSelect);
+/* Stage the event detectors (enum EventDetect flags) of pin n, every detector not given is disabled */
+int32_t stage_gpio_event(gpio_config_t *, uint8_t, uint8_t);
+/* Apply the transaction, at most one read and one write per touched register */
+int32_t commit_gpio_config(const gpio_config_t *);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,90 @@
+#ifndef SRC_GPIOD_DEBOUNCE_H
+#define SRC_GPIOD_DEBOUNCE_H
+#include <stdint.h>
+#include <gpiod.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*******************************************************************************/
+//
+// DESCRIPTION : Bit-parallel debouncer of every pin at once.
+//
+// DETAILS     : Each sample is a 64-bit level word, as read by read_gpio_levels()
+//               or carried by a poller change record. A pin's debounced level
+//               changes once its raw level has differed from it for its threshold
+//               of consecutive samples. A sample agreeing with the debounced level
+//               starts the count over. The counts are vertical counters: bit b of
+//               every pin's count lives in one word, so one sample costs the same
+//               few word operations for 1 pin or all 58, with no branch per pin.
+//               Thresholds are set per pin, from 1 (no filtering) to
+//               GPIO_DEBOUNCE_MAX samples, and stored bit-sliced the same way.
+//               A debouncer is plain caller owned state with no lock. One thread
+//               updates it.
+//
+/*******************************************************************************/
+
+/// CONSTS & ENUMS ///
+// Bits of each pin's count
+#define GPIO_DEBOUNCE_BITS 4
+// Largest threshold, in samples
+#define GPIO_DEBOUNCE_MAX  ((1 << GPIO_DEBOUNCE_BITS) - 1)
+/// GPIO Debounce Structure ///
+// Debouncer state
+typedef struct gpio_debounce {
+    // Debounced levels, as a 64-bit pin word
+    uint64_t levels;
+    // Pins debounced, the other pins of levels never change
+    uint64_t pin_mask;
+    // Samples each pin has differed from its debounced level, bit b of every count in _count[b]
+    uint64_t _count[GPIO_DEBOUNCE_BITS];
+    // Threshold of each pin, bit-sliced as the counts
+    uint64_t _threshold[GPIO_DEBOUNCE_BITS];
+} gpio_debounce_t;
+/// FUNCTIONS ///
+/* Initialize a debouncer of the pins in mask (second argument), starting from the given levels, with
+ * one threshold for every pin. EBAD_PIN for pins past GPIO_PIN_MAX, EOUT_OF_RANGE for a bad threshold */
+int32_t init_gpio_debounce(gpio_debounce_t *, uint64_t, uint64_t, uint8_t);
+/* Set the threshold of the pins in mask (second argument), their counts start over */
+int32_t set_gpio_debounce_threshold(gpio_debounce_t *, uint64_t, uint8_t);
+/* Read the levels and debounce them, storing the pins whose debounced level changed */
+int32_t sample_gpio_debounce(gpio_debounce_t *, uint64_t *);
+/// INLINE FUNCTIONS ///
+/* Debounce one sample, returns the pins whose debounced level changed */
+static inline uint64_t update_gpio_debounce(gpio_debounce_t * deb, uint64_t levels)
+{
+    /// LOCALS ///
+    // Pins whose sample differs from their debounced level, only their counts go on
+    uint64_t differ  = (levels ^ deb->levels) & deb->pin_mask;
+    // Carry of the increment into each count bit
+    uint64_t carry   = differ;
+    // Pins whose count equals their threshold
+    uint64_t reached = ~((uint64_t) 0);
+    // Next count bit
+    uint64_t next    = 0;
+    // Pins changed by this sample
+    uint64_t changed = 0;
+    // Count bit index
+    uint8_t bit      = 0;
+
+    // Ripple increment of the differing counts, every other count is cleared
+    for (bit = 0; bit < GPIO_DEBOUNCE_BITS; bit++)
+    {
+        next            = (deb->_count[bit] ^ carry) & differ;
+        carry          &= deb->_count[bit];
+        deb->_count[bit] = next;
+        reached        &= ~(next ^ deb->_threshold[bit]);
+    }
+    // A count never passes its threshold, it is cleared on reaching it
+    changed      = reached & differ;
+    deb->levels ^= changed;
+    for (bit = 0; bit < GPIO_DEBOUNCE_BITS; bit++)
+    {
+        deb->_count[bit] &= ~changed;
+    }
+    return changed;
+}
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,65 @@
+#ifndef SRC_GPIOD_EVENT_H
+#define SRC_GPIOD_EVENT_H
+#include <stdint.h>
+#include <gpiod.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*******************************************************************************/
+// 
+// DESCRIPTION : Hardware edge/level event detection on top of the GPEDS registers.
+//
+// DETAILS     : A line is armed by selecting which of the REN/FEN/HEN/LEN/AREN/AFEN
+//               detectors may set its GPEDS bit. A poll pass then reads GPEDS0/1 once,
+//               clears the bits it delivers with a single write-1-to-clear store per
+//               register and hands them back as a batch of events sharing one timestamp.
+//               Bits that did not fit in the batch stay set for the next pass, so no
+//               event is lost. Level detected (HEN/LEN) bits re-assert while the level
+//               holds.
+//               On BACKEND_CHARDEV lines are armed through the kernel instead, only the
+//               edge detectors are available (the async ones map to the same edges) and
+//               each poll pass drains the lines' kernel event queues without blocking,
+//               every event carrying the kernel's own timestamp. The line's kernel
+//               request is pollable (get_gpio_event_fd()), it is readable while the
+//               line has events queued, so an epoll loop needs no thread of its own.
+//               On the register backends the poller's ring eventfds fill that role,
+//               see gpiod_poller.h.
+//
+/*******************************************************************************/
+
+/// CONSTS & ENUMS ///
+// Event detectors, or'ed together to select what sets a line's GPEDS bit
+enum EventDetect {
+    EVENT_NONE          = 0x00,
+    EVENT_RISING        = 0x01, // GPREN, synchronous rising edge
+    EVENT_FALLING       = 0x02, // GPFEN, synchronous falling edge
+    EVENT_HIGH          = 0x04, // GPHEN, high level
+    EVENT_LOW           = 0x08, // GPLEN, low level
+    EVENT_ASYNC_RISING  = 0x10, // GPAREN, asynchronous rising edge
+    EVENT_ASYNC_FALLING = 0x20, // GPAFEN, asynchronous falling edge
+};
+/// GPIO Event Structure ///
+// One detected event
+typedef struct gpio_event {
+    // Timebase time (gpio_time_ns()) of the poll pass that found the event, in nanoseconds (the
+    // kernel's CLOCK_MONOTONIC or hardware timestamp of the edge on BACKEND_CHARDEV)
+    uint64_t timestamp_ns;
+    // The GPIO pin the event was detected on
+    uint8_t pin;
+    // Level of the pin when the event was found
+    uint8_t level;
+} gpio_event_t;
+/// FUNCTIONS ///
+/* Select the detectors (enum EventDetect flags) that set the line's event status bit, EVENT_NONE disarms it */
+int32_t set_gpio_event(gpio_line_t *, uint8_t);
+/* Read and clear every fired event status bit, returns the fired pins as a 64-bit pin word */
+int32_t poll_gpio_event_bits(uint64_t *);
+/* Deliver up to max events into the batch, returns the number delivered or an error */
+int32_t poll_gpio_events(gpio_event_t *, uint32_t);
+/* Pollable fd readable while the line has events queued, BACKEND_CHARDEV only. The fd stays owned by the line */
+int32_t get_gpio_event_fd(gpio_line_t *);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,259 @@
+#ifndef SRC_GPIOD_INTERNALS_H
+#define SRC_GPIOD_INTERNALS_H
+#include <stdint.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include <gpiod.h>
+#include <gpiod_event.h>
+#include <gpiod_stats.h>
+#include <gpiod_regs.h>
+#include <gpio_addressing.h>
+
+/*******************************************************************************/
+// 
+// DESCRIPTION : Library internal data shared between the gpiod modules.
+//
+// PURPOSE     : Not part of the public API, included by the library sources only.
+//
+// CONCURRENCY : Lines, groups and fast path handles may be used from any thread.
+//               - SET/CLR writes take no lock. The registers are write-only and a
+//                 store of a pin bit changes that pin alone, so each write is one
+//                 atomic store and concurrent writers cannot lose each other's pins.
+//               - GPEDS is write-1-to-clear and is likewise written without a lock.
+//               - GPLEV and GPEDS reads take no lock.
+//               - Read-modify-writes of shared registers (FSEL, PUP_PDN and the six
+//                 detect enables) take the spinlock of that one register, so threads
+//                 configuring pins in different registers never contend. A lock is
+//                 held for one read and one write. __update_gpio_reg() is the
+//                 only way such a register is modified.
+//               - Line slots are claimed with an atomic exchange.
+//               - Opening and closing the chip context is serialised by a mutex. A
+//                 chip must not be torn down while other threads still use it.
+//               The locks are process local: other processes mapping the same
+//               registers are not excluded.
+//
+/*******************************************************************************/
+
+/// CONSTS ///
+// Spins on a held register lock before yielding the CPU
+#define GPIO_LOCK_SPINS 128
+// Kernel request index of a line that holds its own request
+#define GPIO_CDEV_SOLO  0xFF
+// Stats hooks, see gpiod_stats.h. GPIO_STATS_START declares the start time of an operation among
+// the locals, GPIO_STATS_RECORD counts it. Both are empty without GPIOD_STATS.
+#ifdef GPIOD_STATS
+#define GPIO_STATS_START(start_ns)                        uint64_t start_ns = gpio_time_ns()
+#define GPIO_STATS_RECORD(line_ind, op, retval, start_ns) __record_gpio_stat((line_ind), (op), (retval), (start_ns))
+#else
+#define GPIO_STATS_START(start_ns)
+#define GPIO_STATS_RECORD(line_ind, op, retval, start_ns)
+#endif
+// Stats line of a line handle
+#define GPIO_STATS_LINE(line) ((NULL != (line)->priv_dat) ? (line)->priv_dat->_pin_value : GPIO_STATS_CHIP)
+/// STRUCTS ///
+// Process-wide chip context, the register space is mapped once and shared by every line
+typedef struct _gpio_chip {
+    // Backend the register space was opened on
+    enum GpioBackend _backend;
+    // File descriptor backing the memory mapped space
+    int32_t _fd;
+    // Outstanding references, one per open_gpio_chip() call and one per requested line
+    uint32_t _ref_count;
+    // The GPIO base address mapped into user space
+    void* _base;
+} _gpio_chip_t;
+// Lock of one register, on its own cache line so that threads spinning on different registers
+// do not share a line
+typedef struct _gpio_reg_lock {
+    _Alignas(GPIO_CACHE_LINE) atomic_flag _flag;
+} _gpio_reg_lock_t;
+// Per-pin descriptor, every register index, shift and mask a line needs is derived from these
+// few bytes. The table of all pins is built at compile time, see gpio_pin_desc.
+typedef struct _gpio_pin_desc {
+    // Function select register index, GPFSEL0..5
+    uint8_t _fsel_reg    : 3;
+    // Pull-up/pull-down register index, GP_PUP_PDN_CNTRL_REG0..3
+    uint8_t _pup_pdn_reg : 2;
+    // Bank of the 1-bit mapped registers, 0 for GPxxx0 and 1 for GPxxx1
+    uint8_t _bank        : 1;
+    // Shift of the pin's field in its function select register
+    uint8_t _fsel_shift;
+    // Shift of the pin's field in its pull-up/pull-down register
+    uint8_t _pup_pdn_shift;
+    // Shift of the pin's bit in its bank
+    uint8_t _bank_shift;
+} _gpio_pin_desc_t;
+// Private data struct definition, a slot of the fixed line pool
+typedef struct _gpio_internals {
+    // The GPIO base address, the chip context mapping, NULL on BACKEND_CHARDEV where calls go to _fd
+    void* _base;
+    // Kernel line request on BACKEND_CHARDEV (the group's, if the line is in a bulk group), -1 otherwise
+    int32_t _fd;
+    // The Pin selected, indexes gpio_pin_desc
+    uint8_t _pin_value;
+    // Whether the slot is held by a line
+    atomic_bool _in_use;
+    // Index of the line in its kernel request, GPIO_CDEV_SOLO when the request is the line's own
+    uint8_t _cdev_index;
+    // Kernel line flags (GPIO_V2_LINE_FLAG_*) of the line on BACKEND_CHARDEV
+    uint16_t _cdev_flags;
+}_gpio_internals_t;
+/// GLOBALS ///
+// The one chip context of this process, defined in gpiod.c
+extern _gpio_chip_t gpio_chip;
+// Register locks, one per register word of the mapping, defined in gpiod.c
+extern _gpio_reg_lock_t gpio_reg_locks[GPIO_ADDR_RANGE_SIZE / GPIO_REG_SIZE];
+// The fixed line pool, defined in gpiod.c
+extern _gpio_internals_t gpio_line_pool[GPIO_LINE_POOL_SIZE];
+// Descriptors of pins 0..GPIO_PIN_MAX, defined in gpiod.c
+extern const _gpio_pin_desc_t gpio_pin_desc[GPIO_PIN_MAX + 1];
+/// FUNCTIONS ///
+/* Take a reference on the chip context, mapping it on the given backend on first use */
+int32_t __get_gpio_chip(enum GpioBackend, const char *);
+/* Drop a reference on the chip context, unmapping it on last use */
+int32_t __put_gpio_chip(void);
+/* Read back the function currently selected for the GPIO pin */
+enum FunctionSelect __get_gpio_fn(_gpio_internals_t *);
+/* Whether register access is possible: 0 when mapped, EBACKEND on BACKEND_CHARDEV, else ECHIP_CLOSED */
+int32_t __gpio_regs_retval(void);
+/* read_gpio_levels() without the stats hook, for the library's own sampling loops */
+int32_t __read_gpio_levels(uint64_t *);
+/* Read and clear the fired event status bits of the given pins only, see gpiod_event.c */
+int32_t __poll_gpio_event_bits(uint64_t, uint64_t *);
+#ifdef GPIOD_STATS
+/* Create the stats segment of the process, called with the chip lock held */
+void __open_gpio_stats(void);
+/* Count one operation on a stats line, its outcome and its latency from the start time */
+void __record_gpio_stat(uint8_t, enum GpioStatOp, int32_t, uint64_t);
+#endif
+#ifdef GPIOD_TRACE
+/* Start recording to the file named by GPIO_TRACE_ENV, if any, called with the chip lock held */
+void __open_gpio_trace(void);
+#endif
+/* Character device backend, see gpiod_cdev.c */
+/* Open and check a GPIO character device, returns its descriptor or an error */
+int32_t __cdev_open_chip(const char *);
+/* Take the line's own kernel request, keeping the direction and bias the line has */
+int32_t __cdev_request_line(_gpio_internals_t *);
+/* Drop the line's own kernel request */
+void __cdev_release_line(_gpio_internals_t *);
+/* Drive the line high or low */
+int32_t __cdev_write_gpio(_gpio_internals_t *, uint8_t);
+/* Read the line level */
+int32_t __cdev_read_gpio(_gpio_internals_t *);
+/* Function of the line, INPUT or OUTPUT */
+enum FunctionSelect __cdev_get_gpio_fn(_gpio_internals_t *);
+/* Select INPUT or OUTPUT */
+int32_t __cdev_set_gpio_fn(_gpio_internals_t *, enum FunctionSelect);
+/* Select the bias */
+int32_t __cdev_set_gpio_pull(_gpio_internals_t *, enum PullSelect);
+/* Select the edges (enum EventDetect flags) reported by the line */
+int32_t __cdev_set_gpio_event(_gpio_internals_t *, uint8_t);
+/* Deliver up to max buffered edge events of every line */
+int32_t __cdev_poll_gpio_events(gpio_event_t *, uint32_t);
+/* Move the group's lines, which must have the same flags, into one multi-line request */
+int32_t __cdev_request_gpio_bulk(gpio_bulk_t *, gpio_line_t *, uint8_t);
+/* Write the group's pins selected by mask with one ioctl */
+int32_t __cdev_write_gpio_bulk(gpio_bulk_t *, uint64_t, uint64_t);
+/* Give the group's lines their own requests back and drop the group request, returns the error of
+ * the first line left without one */
+int32_t __cdev_release_gpio_bulk(gpio_bulk_t *);
+/// INLINE FUNCTIONS ///
+/* Take the lock of a register of the chip mapping, the wait is one other holder's read and write.
+ * A holder that was preempted holds it far longer, so the wait yields the CPU after a short spin. */
+static inline void __lock_gpio_reg(volatile uint32_t* reg)
+{
+    /// LOCALS ///
+    // Spins left before yielding
+    uint32_t spins = GPIO_LOCK_SPINS;
+
+    while (atomic_flag_test_and_set_explicit(&gpio_reg_locks[((void *) reg - gpio_chip._base) / GPIO_REG_SIZE]._flag,
+                                             memory_order_acquire))
+    {
+        if (0 == --spins)
+        {
+            spins = GPIO_LOCK_SPINS;
+            sched_yield();
+        }
+#if defined(__aarch64__) || defined(__arm__)
+        __asm__ __volatile__("yield");
+#elif defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+}
+/* Drop the lock of a register */
+static inline void __unlock_gpio_reg(volatile uint32_t* reg)
+{
+    atomic_flag_clear_explicit(&gpio_reg_locks[((void *) reg - gpio_chip._base) / GPIO_REG_SIZE]._flag, memory_order_release);
+}
+/* Read-modify-write a shared register under its lock, the bits of mask take their value from bits.
+ * Only bits in write_mask are written, the rest are written as 0. */
+static inline void __update_gpio_reg(volatile uint32_t* reg, uint32_t mask, uint32_t bits, uint32_t write_mask)
+{
+    __lock_gpio_reg(reg);
+    gpio_reg_write(reg, ((gpio_reg_read(reg) & ~mask) | (bits & mask)) & write_mask);
+    __unlock_gpio_reg(reg);
+}
+/* Register of the line's bank, from the offset of the bank 0 register (GPSET0_OFF, GPLEV0_OFF, ...).
+ * Every 1-bit mapped register keeps bank 1 in the word following bank 0. */
+static inline volatile uint32_t* __gpio_bank_reg(const _gpio_internals_t* pdat, uint32_t bank0_off)
+{
+    return (volatile uint32_t *)(pdat->_base + bank0_off + (gpio_pin_desc[pdat->_pin_value]._bank * GPIO_REG_SIZE));
+}
+/* Bit of the line in its bank */
+static inline uint32_t __gpio_bank_bit(const _gpio_internals_t* pdat)
+{
+    return ((uint32_t) 1) << gpio_pin_desc[pdat->_pin_value]._bank_shift;
+}
+/* Bits that may be written in a 1-bit mapped register of the line's bank */
+static inline uint32_t __gpio_bank_mask(const _gpio_internals_t* pdat)
+{
+    return (0 == gpio_pin_desc[pdat->_pin_value]._bank) ? GPREG0_1BIT_WRITE_MASK : GPREG1_1BIT_WRITE_MASK;
+}
+/* Function select register of the line */
+static inline volatile uint32_t* __gpio_fsel_reg(const _gpio_internals_t* pdat)
+{
+    return (volatile uint32_t *)(pdat->_base + GPFN_SEL0_OFF + (gpio_pin_desc[pdat->_pin_value]._fsel_reg * GPIO_REG_SIZE));
+}
+/* Pull-up/pull-down register of the line */
+static inline volatile uint32_t* __gpio_pup_pdn_reg(const _gpio_internals_t* pdat)
+{
+    return (volatile uint32_t *)(pdat->_base + GP_PUP_PDN_CNTRL_REG0 + (gpio_pin_desc[pdat->_pin_value]._pup_pdn_reg * GPIO_REG_SIZE));
+}
+/* Bits that may be written in the line's pull-up/pull-down register, REG3 has fewer pins */
+static inline uint32_t __gpio_pup_pdn_mask(const _gpio_internals_t* pdat)
+{
+    return (GPIO_PIN_MAX / 16 == gpio_pin_desc[pdat->_pin_value]._pup_pdn_reg) ? GPREG3_2BIT_WRITE_MASK : GPREG0_2_2BIT_WRITE_MASK;
+}
+/* Bits that may be written in the line's function select register, GPFSEL5 has fewer pins */
+static inline uint32_t __gpio_fsel_mask(const _gpio_internals_t* pdat)
+{
+    return (GPIO_PIN_MAX / 10 == gpio_pin_desc[pdat->_pin_value]._fsel_reg) ? GPREG5_3BIT_WRITE_MASK : GPREG0_4_3BIT_WRITE_MASK;
+}
+/* Drive the pins of set_bits high and those of clr_bits low. SET/CLR are write only and writing a 0
+ * has no effect, so each register is stored to at most once and only if it has a pin to change. */
+static inline void __write_gpio_masks(void* base, uint64_t set_bits, uint64_t clr_bits)
+{
+    if (0 != (uint32_t) set_bits)
+    {
+        gpio_reg_write((volatile uint32_t *)(base + GPSET0_OFF), (uint32_t) set_bits & GPREG0_1BIT_WRITE_MASK);
+    }
+    if (0 != (uint32_t)(set_bits >> 32))
+    {
+        gpio_reg_write((volatile uint32_t *)(base + GPSET1_OFF), (uint32_t)(set_bits >> 32) & GPREG1_1BIT_WRITE_MASK);
+    }
+    if (0 != (uint32_t) clr_bits)
+    {
+        gpio_reg_write((volatile uint32_t *)(base + GPCLR0_OFF), (uint32_t) clr_bits & GPREG0_1BIT_WRITE_MASK);
+    }
+    if (0 != (uint32_t)(clr_bits >> 32))
+    {
+        gpio_reg_write((volatile uint32_t *)(base + GPCLR1_OFF), (uint32_t)(clr_bits >> 32) & GPREG1_1BIT_WRITE_MASK);
+    }
+}
+#ifdef GPIOD_SIM
+/* Register file of the simulator, see gpiod_sim.c */
+void* __gpio_sim_regs(void);
+#endif
+#endif
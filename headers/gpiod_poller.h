@@ -0,0 +1,113 @@
+#ifndef SRC_GPIOD_POLLER_H
+#define SRC_GPIOD_POLLER_H
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <gpiod.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*******************************************************************************/
+// 
+// DESCRIPTION : Library owned poller thread feeding per consumer change rings.
+//
+// DETAILS     : The poller busy-polls GPLEV0/1 (and optionally GPEDS0/1) from a
+//               thread pinned to a chosen CPU. Every pass whose level changes or
+//               fired events touch a consumer's pins pushes a change record into that
+//               consumer's ring. Each ring has exactly one producer (the poller) and
+//               one consumer, so neither side takes a lock: the producer publishes
+//               with a release store of the head, the consumer frees slots with a
+//               release store of the tail. A full ring drops the record and counts
+//               it as an overflow, the poller never waits on a slow consumer.
+//               A ring may also be given an eventfd for epoll/poll/select loops. It
+//               becomes readable when the poller pushes into the ring after the
+//               consumer has found it empty. Only that first push after a drain
+//               pays for the write() to the eventfd, pushes into a ring already
+//               holding records do not signal. A reactor waits on the fd, then calls
+//               drain_gpio_ring() until it returns fewer than it asked for. That
+//               drain re-arms the fd. The fd may be opened and closed while the
+//               poller runs: closing waits out a signal the poller is making.
+//               The poller needs the register mapping, it is not available on
+//               BACKEND_CHARDEV.
+//
+/*******************************************************************************/
+
+/// CONSTS & ENUMS ///
+// Most rings a single poller feeds
+#define GPIO_POLLER_MAX_RINGS 16
+/// GPIO Change Structure ///
+// One change record
+typedef struct gpio_change {
+    // Timebase time (gpio_time_ns()) of the sample, in nanoseconds
+    uint64_t timestamp_ns;
+    // GPLEV snapshot, as a 64-bit pin word
+    uint64_t levels;
+    // Pins whose level changed since the previous sample
+    uint64_t changed;
+    // Pins whose event status bit fired (and was cleared) in this sample
+    uint64_t events;
+} gpio_change_t;
+/// GPIO Ring Structure ///
+// Single-producer/single-consumer ring of change records over caller owned storage
+typedef struct gpio_ring {
+    // Record storage, capacity entries
+    gpio_change_t* _records;
+    // Capacity - 1, capacity is a power of two
+    uint32_t _mask;
+    // Pins the consumer wants changes for
+    uint64_t pin_mask;
+    // Next slot the producer writes, written by the producer only
+    GPIO_ALIGNAS(GPIO_CACHE_LINE) GPIO_ATOMIC(uint32_t) _head;
+    // Records dropped because the ring was full, written by the producer only
+    GPIO_ATOMIC(uint64_t) _overflows;
+    // Next slot the consumer reads, written by the consumer only
+    GPIO_ALIGNAS(GPIO_CACHE_LINE) GPIO_ATOMIC(uint32_t) _tail;
+    // Set by the consumer once it found the ring empty, the next push signals the eventfd
+    GPIO_ATOMIC(bool) _armed;
+    // Eventfd signalled on the first push after a drain, -1 without one
+    GPIO_ATOMIC(int32_t) _event_fd;
+    // Signals of the producer in progress, a close waits for them before closing the fd
+    GPIO_ATOMIC(uint32_t) _signalling;
+} gpio_ring_t;
+/// GPIO Poller Structure ///
+// Poller thread and the rings it feeds
+typedef struct gpio_poller {
+    // Rings fed by the poller
+    gpio_ring_t* _rings[GPIO_POLLER_MAX_RINGS];
+    // Number of rings
+    uint8_t _num_rings;
+    // Union of the rings' pins
+    uint64_t _watch_mask;
+    // Whether the poller also reads GPEDS0/1, clearing the bits of the watched pins only
+    bool _sample_events;
+    // Cleared to stop the thread
+    GPIO_ATOMIC(bool) _running;
+    // The poller thread
+    pthread_t _thread;
+} gpio_poller_t;
+/// FUNCTIONS ///
+/* Initialize a ring over storage of capacity records (a power of two) for the given pin word */
+int32_t init_gpio_ring(gpio_ring_t *, gpio_change_t *, uint32_t, uint64_t);
+/* Drain up to max records from a ring, consumer side only, returns the number drained. Never blocks,
+ * draining fewer than max re-arms the ring's eventfd */
+uint32_t drain_gpio_ring(gpio_ring_t *, gpio_change_t *, uint32_t);
+/* Open the ring's eventfd, readable once records are pushed into the drained ring. Returns the fd or an error */
+int32_t open_gpio_ring_fd(gpio_ring_t *);
+/* Close the ring's eventfd, a signal the poller is making is waited for */
+int32_t close_gpio_ring_fd(gpio_ring_t *);
+/* Number of records dropped because the ring was full */
+uint64_t gpio_ring_overflows(gpio_ring_t *);
+/* Initialize a poller, optionally sampling the event status registers as well */
+int32_t init_gpio_poller(gpio_poller_t *, bool);
+/* Add a ring to a poller that has not been started */
+int32_t add_gpio_poller_ring(gpio_poller_t *, gpio_ring_t *);
+/* Start the poller thread pinned to the given CPU, a negative CPU leaves it unpinned. EBACKEND
+ * without the register mapping */
+int32_t start_gpio_poller(gpio_poller_t *, int32_t);
+/* Stop and join the poller thread */
+int32_t stop_gpio_poller(gpio_poller_t *);
+#ifdef __cplusplus
+}
+#endif
+#endif
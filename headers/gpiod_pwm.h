@@ -0,0 +1,75 @@
+#ifndef SRC_GPIOD_PWM_H
+#define SRC_GPIOD_PWM_H
+#include <stdint.h>
+#include <stdbool.h>
+#include <gpiod.h>
+#include <gpiod_wave.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*******************************************************************************/
+// 
+// DESCRIPTION : Multi-channel software PWM driven from a single timing loop.
+//
+// DETAILS     : Every channel shares one period. At the start of a period all
+//               channels with a non-zero duty are set together, then channels are
+//               cleared in groups at each distinct duty edge, so a period costs one
+//               SET/CLR store per distinct edge rather than per channel. The schedule
+//               of edges is sorted only when a duty changes. Duties are plain atomics,
+//               any thread may update them without a lock, and the loop picks the
+//               change up at its next period boundary. start_gpio_pwm() arms the loop
+//               before it runs, typically before the thread that runs it is spawned,
+//               so a stop_gpio_pwm() issued before run_gpio_pwm() starts is kept and
+//               the run returns at once.
+//
+/*******************************************************************************/
+
+/// CONSTS & ENUMS ///
+// Most channels in one PWM engine, one per pin
+#define GPIO_PWM_MAX_CHANNELS (GPIO_PIN_MAX + 1)
+/// GPIO PWM Structure ///
+// PWM engine
+typedef struct gpio_pwm {
+    // Group the channels are written through
+    gpio_bulk_t* _bulk;
+    // Period shared by every channel, in nanoseconds
+    uint32_t _period_ns;
+    // Number of channels
+    uint8_t _num_channels;
+    // Pin of each channel
+    uint8_t _pins[GPIO_PWM_MAX_CHANNELS];
+    // High time of each channel per period, in nanoseconds
+    GPIO_ATOMIC(uint32_t) _duty_ns[GPIO_PWM_MAX_CHANNELS];
+    // Bumped on every duty change, tells the loop to rebuild its schedule
+    GPIO_ATOMIC(uint32_t) _generation;
+    // Set by a start, cleared to stop the loop
+    GPIO_ATOMIC(bool) _running;
+    // Schedule of one period: the set at time 0, then one clear per distinct edge
+    gpio_wave_step_t _steps[GPIO_PWM_MAX_CHANNELS + 1];
+    // Number of scheduled steps
+    uint32_t _num_steps;
+    // Edge timing achieved so far
+    gpio_wave_timing_t _timing;
+} gpio_pwm_t;
+/// FUNCTIONS ///
+/* Initialize a PWM engine over a requested bulk group with the period in nanoseconds */
+int32_t init_gpio_pwm(gpio_pwm_t *, gpio_bulk_t *, uint32_t);
+/* Add a channel on a pin of the group with its initial duty, returns the channel index or an error.
+ * EPIN_CONFIG for a pin outside the group or already driven by a channel, ETHREAD once started */
+int32_t add_gpio_pwm_channel(gpio_pwm_t *, uint8_t, uint32_t);
+/* Set the duty of a channel in nanoseconds (clamped to the period), safe from any thread */
+int32_t set_gpio_pwm_duty(gpio_pwm_t *, uint8_t, uint32_t);
+/* Arm the PWM loop, its channels are then fixed until the run ends */
+int32_t start_gpio_pwm(gpio_pwm_t *);
+/* Run the armed PWM loop on the calling thread for the given number of periods, 0 runs until
+ * stop_gpio_pwm(). Returns at once when it was not started, or was stopped since */
+int32_t run_gpio_pwm(gpio_pwm_t *, uint32_t);
+/* Stop the PWM loop at the end of its current period, or the next run before it starts */
+int32_t stop_gpio_pwm(gpio_pwm_t *);
+/* Edge timing achieved by the PWM loop */
+int32_t get_gpio_pwm_timing(gpio_pwm_t *, gpio_wave_timing_t *);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,143 @@
+#ifndef SRC_GPIOD_REGS_H
+#define SRC_GPIOD_REGS_H
+#include <stdint.h>
+#ifdef GPIOD_TRACE
+#include <gpiod_trace.h>
+#endif
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*******************************************************************************/
+// 
+// DESCRIPTION : Register accessors, every GPIO register touch goes through these.
+//
+// DETAILS     : Against real hardware (/dev/mem, /dev/gpiomem) an access is one
+//               volatile 32-bit load or store of the mapped register, there is no
+//               dispatch. The compiler neither merges, splits, drops nor reorders
+//               volatile accesses among themselves, but plain memory accesses may
+//               move around them, and the CPU may let a store be posted. Two
+//               ordering policies are offered on top:
+//               - relaxed: the volatile access alone. Back to back stores are
+//                 posted and may still be in flight when the next instruction
+//                 runs. Ordering against other memory is left to the caller, e.g.
+//                 the register locks, whose acquire and release cover the accesses
+//                 between them, or gpio_reg_sync().
+//               - strict: a full barrier (dmb) before every access, so it is
+//                 ordered after all earlier memory accesses, a dmb after every
+//                 load, and a dsb after every store, so the store has completed
+//                 before the next instruction runs. On x86 the dmb is a compiler
+//                 barrier only (the CPU keeps the order) and the dsb an mfence.
+//               gpio_reg_read() and gpio_reg_write() use the relaxed policy unless
+//               the library is built with GPIOD_MMIO_STRICT (make MMIO=strict). The
+//               _relaxed and _strict variants pick one regardless, e.g. a relaxed
+//               burst of writes followed by one gpio_reg_sync().
+//               Builds with GPIOD_SIM defined route every access through the register
+//               simulator instead, so write-only, write-1-to-clear and reserved bits
+//               behave as on the chip. The barriers of the strict policy are kept.
+//               Builds with GPIOD_TRACE defined also report every access to the
+//               trace recorder (gpiod_trace.h), after it is made.
+//               The choices are made at compile time only.
+//
+/*******************************************************************************/
+
+#ifdef GPIOD_SIM
+/* Simulated register read, see gpiod_sim.c */
+uint32_t gpio_sim_read(volatile uint32_t *);
+/* Simulated register write, see gpiod_sim.c */
+void gpio_sim_write(volatile uint32_t *, uint32_t);
+#endif
+
+/// FUNCTIONS ///
+/* Barrier ordering every memory access before it against every access after it */
+static inline void gpio_reg_order(void)
+{
+#if defined(__aarch64__) || (defined(__arm__) && (7 <= __ARM_ARCH))
+    __asm__ __volatile__("dmb sy" ::: "memory");
+#elif defined(__x86_64__) || defined(__i386__)
+    __asm__ __volatile__("" ::: "memory");
+#else
+    __sync_synchronize();
+#endif
+}
+/* Barrier completing every memory access before it, posted register writes included */
+static inline void gpio_reg_sync(void)
+{
+#if defined(__aarch64__) || (defined(__arm__) && (7 <= __ARM_ARCH))
+    __asm__ __volatile__("dsb sy" ::: "memory");
+#elif defined(__x86_64__) || defined(__i386__)
+    __asm__ __volatile__("mfence" ::: "memory");
+#else
+    __sync_synchronize();
+#endif
+}
+/* Read a GPIO register, relaxed */
+static inline uint32_t gpio_reg_read_relaxed(volatile uint32_t * reg)
+{
+    /// LOCALS ///
+    // Value read
+    uint32_t value;
+
+#ifdef GPIOD_SIM
+    value = gpio_sim_read(reg);
+#else
+    value = *reg;
+#endif
+#ifdef GPIOD_TRACE
+    __trace_gpio_reg(TRACE_READ, reg, value);
+#endif
+    return value;
+}
+/* Write a GPIO register, relaxed */
+static inline void gpio_reg_write_relaxed(volatile uint32_t * reg, uint32_t value)
+{
+#ifdef GPIOD_SIM
+    gpio_sim_write(reg, value);
+#else
+    *reg = value;
+#endif
+#ifdef GPIOD_TRACE
+    __trace_gpio_reg(TRACE_WRITE, reg, value);
+#endif
+}
+/* Read a GPIO register, strict */
+static inline uint32_t gpio_reg_read_strict(volatile uint32_t * reg)
+{
+    /// LOCALS ///
+    // Value read
+    uint32_t value;
+
+    gpio_reg_order();
+    value = gpio_reg_read_relaxed(reg);
+    gpio_reg_order();
+    return value;
+}
+/* Write a GPIO register, strict */
+static inline void gpio_reg_write_strict(volatile uint32_t * reg, uint32_t value)
+{
+    gpio_reg_order();
+    gpio_reg_write_relaxed(reg, value);
+    gpio_reg_sync();
+}
+/* Read a GPIO register, with the policy the library is built with */
+static inline uint32_t gpio_reg_read(volatile uint32_t * reg)
+{
+#ifdef GPIOD_MMIO_STRICT
+    return gpio_reg_read_strict(reg);
+#else
+    return gpio_reg_read_relaxed(reg);
+#endif
+}
+/* Write a GPIO register, with the policy the library is built with */
+static inline void gpio_reg_write(volatile uint32_t * reg, uint32_t value)
+{
+#ifdef GPIOD_MMIO_STRICT
+    gpio_reg_write_strict(reg, value);
+#else
+    gpio_reg_write_relaxed(reg, value);
+#endif
+}
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,99 @@
+#ifndef SRC_GPIOD_RT_H
+#define SRC_GPIOD_RT_H
+#include <stdint.h>
+#include <stdbool.h>
+#include <gpiod.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*******************************************************************************/
+//
+// DESCRIPTION : Real-time setup of the calling thread and a write loop jitter
+//               self-test.
+//
+// DETAILS     : setup_gpio_rt() removes the usual sources of stalls in a toggle
+//               loop, in this order:
+//               - pins the calling thread to one CPU, so it is never migrated;
+//               - locks every current and future page of the process (mlockall),
+//                 which faults in the library's buffers: the line pool, the stats
+//                 segment and a trace buffer, even one allocated later;
+//               - stops the heap from being trimmed or served by mmap, then faults
+//                 in heap_bytes of it, so later allocations up to that size take
+//                 no page fault and make no system call;
+//               - faults in stack_bytes of the calling thread's stack;
+//               - calibrates the timebase, which would otherwise run on first use;
+//               - touches the register mapping, reading GPLEV0 and writing 0 to
+//                 GPSET0 (which changes no pin), so its first access in the loop
+//                 takes no fault. This needs the chip context open first;
+//               - switches the calling thread to SCHED_FIFO at the given priority,
+//                 last, so the work above does not run at real-time priority.
+//               Memory locking and SCHED_FIFO need CAP_IPC_LOCK and CAP_SYS_NICE
+//               (or root), or matching RLIMIT_MEMLOCK and RLIMIT_RTPRIO. Other
+//               threads keep their policy and affinity.
+//               run_gpio_rt_selftest() toggles a line through write_gpio_ts() and
+//               measures, for each write, the time from its deadline to the write
+//               completing. With a period the deadlines are fixed, every period from
+//               the start. Without one each deadline is the previous write, so the
+//               loop runs back to back and the time is its iteration time. The
+//               report carries a log2 histogram of those times and counts the
+//               stalls longer than GPIO_RT_STALL_NS. It takes no lock, makes no
+//               allocation and no system call besides those of write_gpio(), so
+//               running it on a node before it goes live shows the jitter its loops
+//               will see.
+//
+/*******************************************************************************/
+
+/// CONSTS & ENUMS ///
+// Default SCHED_FIFO priority
+#define GPIO_RT_PRIORITY    80
+// Default stack faulted in, in bytes
+#define GPIO_RT_STACK_BYTES (256 * 1024)
+// Default heap faulted in, in bytes
+#define GPIO_RT_HEAP_BYTES  (1024 * 1024)
+// Log2 buckets of the self-test histogram, bucket n counts times in [2^(n-1), 2^n) ns
+#define GPIO_RT_HIST_SZ     32
+// Self-test time counted as a stall, in nanoseconds
+#define GPIO_RT_STALL_NS    100000
+/// GPIO Real-Time Structures ///
+// Setup of the calling thread
+typedef struct gpio_rt_config {
+    // CPU the thread is pinned to, -1 leaves its affinity alone
+    int32_t cpu;
+    // SCHED_FIFO priority, 0 leaves the scheduling policy alone
+    uint8_t priority;
+    // Lock every page of the process
+    bool lock_memory;
+    // Stack and heap faulted in, in bytes, 0 for none
+    uint32_t stack_bytes;
+    uint32_t heap_bytes;
+} gpio_rt_config_t;
+// Self-test results
+typedef struct gpio_rt_report {
+    // Writes timed, and the period they were paced at (0 for back to back)
+    uint32_t iters;
+    uint64_t period_ns;
+    // Time from a deadline to its write completing: smallest, mean and largest, in nanoseconds
+    uint64_t min_ns;
+    uint64_t mean_ns;
+    uint64_t max_ns;
+    // Times longer than GPIO_RT_STALL_NS
+    uint64_t stalls;
+    // Log2 histogram of the times
+    uint64_t hist[GPIO_RT_HIST_SZ];
+} gpio_rt_report_t;
+/// FUNCTIONS ///
+/* Fill a setup with the defaults: no CPU pinning, GPIO_RT_PRIORITY, memory locked, and
+ * GPIO_RT_STACK_BYTES and GPIO_RT_HEAP_BYTES faulted in */
+int32_t init_gpio_rt_config(gpio_rt_config_t *);
+/* Set up the calling thread and the process for real-time use, see above. EOUT_OF_RANGE for a CPU
+ * that is not online or a priority past the SCHED_FIFO range, EMALLOC when the heap cannot be
+ * faulted in, ERT_SETUP when the system refuses the memory lock, the affinity or the policy */
+int32_t setup_gpio_rt(const gpio_rt_config_t *);
+/* Toggle an OUTPUT line the given number of times, paced at the period in nanoseconds (0 for back
+ * to back), and report the jitter. Stops at the first failed write and returns its error */
+int32_t run_gpio_rt_selftest(gpio_line_t *, uint32_t, uint64_t, gpio_rt_report_t *);
+#ifdef __cplusplus
+}
+#endif
+#endif
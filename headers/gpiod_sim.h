@@ -0,0 +1,57 @@
+#ifndef SRC_GPIOD_SIM_H
+#define SRC_GPIOD_SIM_H
+#include <stdint.h>
+#include <stdbool.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*******************************************************************************/
+// 
+// DESCRIPTION : In-memory BCM2711 GPIO register simulator (BACKEND_SIM).
+//
+// DETAILS     : Only available in builds with GPIOD_SIM defined (make SIM=1), where
+//               the register accessors route through it. It models the register
+//               semantics documented in gpio_addressing.h:
+//                - GPSET/GPCLR are write only, they update a hidden output latch and
+//                  read as 0.
+//                - GPLEV reflects the latch on pins selected as OUTPUT and the
+//                  injected external level on every other pin.
+//                - GPEDS bits are set by level transitions matching the REN/FEN/AREN/
+//                  AFEN enables and by levels matching HEN/LEN, and are write-1-to-clear
+//                  (a level detected bit re-asserts while its level holds).
+//                - Reserved bits are dropped on write and read as 0, reserved offsets
+//                  ignore writes.
+//               Synchronous and asynchronous edge detection are modelled alike.
+//               Accesses to the simulated registers can be logged, in order, to
+//               check how many reads and writes an operation makes.
+//               make SIM=1 check verifies this behaviour, see tools/gpiod_sim_check.c.
+//
+/*******************************************************************************/
+
+/// GPIO Sim Structures ///
+// One logged register access
+typedef struct gpio_sim_access {
+    // Offset of the register
+    uint32_t offset;
+    // Value read, or value written before the reserved bits are dropped
+    uint32_t value;
+    // Whether the access was a write
+    bool write;
+} gpio_sim_access_t;
+/// FUNCTIONS ///
+/* Log the accesses to the simulated registers into the array (first argument) of the given length,
+ * accesses past its end are dropped. NULL stops logging */
+void gpio_sim_log(gpio_sim_access_t *, uint32_t);
+/* Accesses logged since gpio_sim_log(), at most the length of the array */
+uint32_t gpio_sim_logged(void);
+/* Reset the simulator to power-on state, every register 0, every pin an input at level 0 */
+void gpio_sim_reset(void);
+/* Drive the external level of the pins in mask (second argument) to their bit in levels */
+void gpio_sim_set_inputs(uint64_t, uint64_t);
+/* Levels driven by the pins selected as OUTPUT, as a 64-bit pin word */
+uint64_t gpio_sim_get_outputs(void);
+#ifdef __cplusplus
+}
+#endif
+#endif
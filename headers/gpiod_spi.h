@@ -0,0 +1,64 @@
+#ifndef SRC_GPIOD_SPI_H
+#define SRC_GPIOD_SPI_H
+#include <stdint.h>
+#include <gpiod.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*******************************************************************************/
+// 
+// DESCRIPTION : Bit-banged SPI master over requested GPIO lines.
+//
+// DETAILS     : Line directions are checked and the SET/CLR masks of every
+//               (data bit, clock level) combination are computed once, when the
+//               master is initialized. A bit then costs one precomputed mask write
+//               for the data change (merged with the clock edge it rides on), one
+//               for the other clock edge and a single GPLEV read to sample MISO.
+//               Chip select is driven low for the whole of a transfer call.
+//               The lines must stay requested for as long as the master is used.
+//
+/*******************************************************************************/
+
+/// CONSTS & ENUMS ///
+// SPI modes, bit 1 is the clock polarity (CPOL), bit 0 the clock phase (CPHA)
+enum SpiMode {
+    SPI_MODE_0 = 0x00, // CPOL 0, sample on the rising edge
+    SPI_MODE_1 = 0x01, // CPOL 0, sample on the falling edge
+    SPI_MODE_2 = 0x02, // CPOL 1, sample on the falling edge
+    SPI_MODE_3 = 0x03, // CPOL 1, sample on the rising edge
+};
+/// GPIO SPI Structure ///
+// Bit-banged SPI master
+typedef struct gpio_spi {
+    // Base of the shared register mapping
+    void* _base;
+    // Chip select pin bit, 0 when there is no chip select
+    uint64_t _cs_bit;
+    // Clock pin bit
+    uint64_t _sclk_bit;
+    // Set/clear masks indexed by [data bit][clock level], MOSI is left out when there is no data line
+    uint64_t _set_masks[2][2];
+    uint64_t _clr_masks[2][2];
+    // Level register holding MISO, NULL when there is no MISO
+    volatile uint32_t* _miso_reg;
+    // Bit of MISO in its level register
+    uint8_t _miso_shift;
+    // Clock polarity, the idle clock level
+    uint8_t _cpol;
+    // Clock phase
+    uint8_t _cpha;
+    // Half a clock period, 0 runs as fast as the registers allow
+    uint32_t _half_period_ns;
+} gpio_spi_t;
+/// FUNCTIONS ///
+/* Initialize a master from requested lines (cs, sclk, mosi, miso), cs/mosi/miso may be NULL.
+ * cs/sclk/mosi must be OUTPUT and miso INPUT. The clock is parked at its idle level and cs high. */
+int32_t init_gpio_spi(gpio_spi_t *, gpio_line_t *, gpio_line_t *, gpio_line_t *, gpio_line_t *,
+                      enum SpiMode, uint32_t);
+/* Full duplex transfer of len bytes MSB first, tx NULL sends zeros, rx NULL discards */
+int32_t transfer_gpio_spi(gpio_spi_t *, const uint8_t *, uint8_t *, uint32_t);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,101 @@
+#ifndef SRC_GPIOD_STATS_H
+#define SRC_GPIOD_STATS_H
+#include <stdint.h>
+#include <gpiod.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*******************************************************************************/
+//
+// DESCRIPTION : Per-line operation counters and latency histograms, kept in a
+//               shared-memory segment another process can read live.
+//
+// DETAILS     : Only built with GPIOD_STATS (make STATS=1). Without it the hooks
+//               in the library compile to nothing. The segment is created when
+//               the chip context is first opened, as GPIO_STATS_SHM_PREFIX<pid>
+//               under /dev/shm, and unlinked at exit. It holds one slot per thread,
+//               so each thread updates its own counters with plain stores and
+//               never contends with another. Threads beyond GPIO_STATS_SLOTS - 1
+//               share the last slot, which is updated with atomic adds. When a
+//               thread exits its counts are added to the retired counters and its
+//               slot is cleared and freed for the next thread. A reader sums the
+//               slots and the retired counters, a count may be one operation behind
+//               the histogram it belongs to, or count an exiting thread's operations
+//               twice while they move, but nothing is ever torn. Each operation costs two
+//               timebase reads and a few increments. The fast path handles are
+//               not counted, nor are the level reads of the library's own sampling
+//               loops (poller, capture, debouncer, broker). A forked child counts
+//               nothing and leaves the parent's segment in place at its exit.
+//               See tools/gpiod_stats.c for the reader.
+//
+/*******************************************************************************/
+
+/// CONSTS & ENUMS ///
+// Segment magic, "GPST"
+#define GPIO_STATS_MAGIC     0x54535047
+// Segment version
+#define GPIO_STATS_VERSION   3
+// Name of the segment of a process, followed by its pid
+#define GPIO_STATS_SHM_PREFIX "/gpiod-stats."
+// Thread slots, the last is shared by the threads that found no free slot
+#define GPIO_STATS_SLOTS     16
+// Lines counted, one per pin plus GPIO_STATS_CHIP
+#define GPIO_STATS_LINES     (GPIO_PIN_MAX + 2)
+// Line of the operations not tied to one pin: bulk writes, level snapshots, calls on unrequested lines
+#define GPIO_STATS_CHIP      (GPIO_PIN_MAX + 1)
+// Error codes counted, indexed by the negated code, larger codes land in the last
+#define GPIO_STATS_ERRORS    17
+// Log2 latency buckets, bucket n counts latencies in [2^(n-1), 2^n) ns
+#define GPIO_STATS_HIST_SZ   32
+// Operations counted
+enum GpioStatOp {
+    STAT_WRITE    = 0x00, // write_gpio(), write_gpio_bulk()
+    STAT_READ     = 0x01, // read_gpio(), read_gpio_levels()
+    STAT_SET_FN   = 0x02, // set_gpio_fn()
+    STAT_SET_PULL = 0x03, // set_gpio_pull()
+    STAT_OPS      = 0x04,
+};
+/// GPIO Stats Structures ///
+// Counters of one line in one slot
+typedef struct gpio_stats_line {
+    // Calls per operation
+    uint64_t ops[STAT_OPS];
+    // Failed calls per error code
+    uint64_t errors[GPIO_STATS_ERRORS];
+    // Latency histogram per operation
+    uint64_t hist[STAT_OPS][GPIO_STATS_HIST_SZ];
+} gpio_stats_line_t;
+// Counters of one thread
+typedef struct gpio_stats_slot {
+    // Thread that claimed the slot, 0 while free
+    GPIO_ALIGNAS(GPIO_CACHE_LINE) uint64_t tid;
+    // Counters per line
+    gpio_stats_line_t lines[GPIO_STATS_LINES];
+} gpio_stats_slot_t;
+// The segment
+typedef struct gpio_stats_segment {
+    // GPIO_STATS_MAGIC and GPIO_STATS_VERSION
+    uint32_t magic;
+    uint32_t version;
+    // Process the segment belongs to
+    uint32_t pid;
+    // Layout, checked by readers against their own
+    uint16_t slots;
+    uint16_t lines;
+    uint16_t ops;
+    uint16_t errors;
+    uint16_t hist_sz;
+    // Slots claimed so far, counting freed slots claimed again, may exceed slots
+    uint32_t claimed;
+    // Timebase time the segment was created at
+    uint64_t start_ns;
+    // The slots
+    gpio_stats_slot_t slot[GPIO_STATS_SLOTS];
+    // Counts of the threads that exited, tid unused
+    gpio_stats_slot_t retired;
+} gpio_stats_segment_t;
+#ifdef __cplusplus
+}
+#endif
+#endif
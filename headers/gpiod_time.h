@@ -0,0 +1,106 @@
+#ifndef SRC_GPIOD_TIME_H
+#define SRC_GPIOD_TIME_H
+#include <stdint.h>
+#include <time.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*******************************************************************************/
+//
+// DESCRIPTION : Process-wide timebase for timestamps and busy-wait delays.
+//
+// DETAILS     : On aarch64 the time is read straight from the ARM generic timer's
+//               virtual counter (CNTVCT_EL0) and scaled to nanoseconds with one
+//               multiply, no system call and no vDSO. Elsewhere, or when the
+//               counter frequency is not advertised, it falls back to
+//               CLOCK_MONOTONIC_RAW. Both read in the CLOCK_MONOTONIC_RAW time
+//               domain: calibration measures the counter against that clock over a
+//               short sleep, so the scale does not rely on CNTFRQ being right, and
+//               aligns the two at the end. It also measures the cost of a read and
+//               the overshoot of the spin delay, reported by
+//               get_gpio_timebase_info(). Calibration runs once, when the chip
+//               context is first opened or on init_gpio_timebase(). Until then the
+//               clock is used. Every library timestamp (events, poller records,
+//               captures and the *_ts variants of the line API) comes from here.
+//
+/*******************************************************************************/
+
+/// CONSTS & ENUMS ///
+// Source of the timebase
+enum GpioTimeSource {
+    TIME_SOURCE_CLOCK  = 0x00, // clock_gettime(CLOCK_MONOTONIC_RAW)
+    TIME_SOURCE_CNTVCT = 0x01, // ARM generic timer virtual counter
+};
+/// GPIO Timebase Structures ///
+// Calibration results
+typedef struct gpio_timebase_info {
+    // Source the time is read from, enum GpioTimeSource
+    uint8_t source;
+    // Counter frequency measured against the clock, 0 for the clock itself
+    uint64_t counter_hz;
+    // Smallest step of the time read, in nanoseconds
+    uint32_t resolution_ns;
+    // Mean cost of one gpio_time_ns(), in nanoseconds
+    uint32_t read_ns;
+    // Overshoot of gpio_delay_ns() during calibration, 99th percentile and largest seen, in nanoseconds.
+    // The largest includes any preemption of the calibrating thread.
+    uint32_t delay_error_ns;
+    uint32_t delay_max_ns;
+} gpio_timebase_info_t;
+// Scale of the counter, read by the inline functions below, set once by calibration
+typedef struct _gpio_timebase {
+    // Nanoseconds per counter tick, 32.32 fixed point
+    uint64_t _mult;
+    // Added to the scaled counter to land in the CLOCK_MONOTONIC_RAW domain (modulo 2^64)
+    uint64_t _offset_ns;
+    // enum GpioTimeSource, published last
+    uint8_t _source;
+} _gpio_timebase_t;
+/// GLOBALS ///
+// The timebase of this process, defined in gpiod_time.c
+extern _gpio_timebase_t gpio_timebase;
+/// FUNCTIONS ///
+/* Calibrate the timebase, only the first call does any work (about 10 ms). Always returns 0 */
+int32_t init_gpio_timebase(void);
+/* Calibration results, calibrating first if needed */
+int32_t get_gpio_timebase_info(gpio_timebase_info_t *);
+/// INLINE FUNCTIONS ///
+/* Time in nanoseconds, CLOCK_MONOTONIC_RAW domain */
+static inline uint64_t gpio_time_ns(void)
+{
+    /// LOCALS ///
+    // Clock read on the fallback
+    struct timespec ts;
+#if defined(__aarch64__)
+    // Counter value
+    uint64_t ticks;
+
+    // Acquire, the scale is written before the source is published
+    if (TIME_SOURCE_CNTVCT == __atomic_load_n(&gpio_timebase._source, __ATOMIC_ACQUIRE))
+    {
+        // The ISB keeps the counter read from being hoisted above the code it times
+        __asm__ __volatile__("isb\n\tmrs %0, cntvct_el0" : "=r" (ticks) :: "memory");
+        return (uint64_t) (((unsigned __int128) ticks * gpio_timebase._mult) >> 32) + gpio_timebase._offset_ns;
+    }
+#endif
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000000ULL) + (uint64_t) ts.tv_nsec;
+}
+/* Spin until the timebase reaches the deadline */
+static inline void gpio_delay_until_ns(uint64_t deadline_ns)
+{
+    while (gpio_time_ns() < deadline_ns)
+    {
+    }
+}
+/* Spin for the given nanoseconds, never sleeps. Overshoots by up to about one read (see read_ns),
+ * more if the thread is preempted. */
+static inline void gpio_delay_ns(uint64_t delay_ns)
+{
+    gpio_delay_until_ns(gpio_time_ns() + delay_ns);
+}
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,84 @@
+#ifndef SRC_GPIOD_TRACE_H
+#define SRC_GPIOD_TRACE_H
+#include <stdint.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*******************************************************************************/
+//
+// DESCRIPTION : Recording of every GPIO register access into a binary trace, for
+//               offline replay.
+//
+// DETAILS     : Only available in builds with GPIOD_TRACE defined (make TRACE=1),
+//               where the register accessors in gpiod_regs.h report each read and
+//               write, including those of the fast path handles and of the poller
+//               thread. While recording, an access appends one record (register
+//               offset, value, timebase timestamp) to a buffer allocated up front,
+//               with one atomic add and no lock or allocation. Accesses past the
+//               capacity are counted as dropped. The character device backend has
+//               no registers and records nothing.
+//               Recording starts with start_gpio_trace(), or when the chip context
+//               is first opened if GPIO_TRACE_ENV names a file, in which case the
+//               trace is saved there at exit. A saved trace is a gpio_trace_file_t
+//               header followed by its records, in host byte order. See
+//               tools/gpiod_replay.c for the replay.
+//
+/*******************************************************************************/
+
+/// CONSTS & ENUMS ///
+// Trace file magic, "GPTR"
+#define GPIO_TRACE_MAGIC            0x52545047
+// Trace file version
+#define GPIO_TRACE_VERSION          1
+// Environment variable naming the file to record to from the first chip open
+#define GPIO_TRACE_ENV              "GPIOD_TRACE_FILE"
+// Records held when recording from the environment, 16 MiB
+#define GPIO_TRACE_DEFAULT_RECORDS  (1U << 20)
+// Kind of access
+enum GpioTraceOp {
+    TRACE_READ  = 0x00, // gpio_reg_read()
+    TRACE_WRITE = 0x01, // gpio_reg_write()
+};
+/// GPIO Trace Structures ///
+// One register access
+typedef struct gpio_trace_record {
+    // Timebase time of the access
+    uint64_t ts_ns;
+    // Value read or written
+    uint32_t value;
+    // Offset of the register from the GPIO base
+    uint16_t offset;
+    // enum GpioTraceOp
+    uint8_t op;
+    uint8_t _reserved;
+} gpio_trace_record_t;
+// Header of a saved trace
+typedef struct gpio_trace_file {
+    // GPIO_TRACE_MAGIC and GPIO_TRACE_VERSION
+    uint32_t magic;
+    uint32_t version;
+    // Size of a record, checked by readers against their own
+    uint32_t record_size;
+    uint32_t _reserved;
+    // Records that follow
+    uint64_t count;
+    // Accesses that did not fit the buffer, they are missing from the trace
+    uint64_t dropped;
+} gpio_trace_file_t;
+/// FUNCTIONS ///
+/* Start recording into a new buffer of the given number of records, replacing the previous trace.
+ * Returns EOUT_OF_RANGE for 0 records, EMALLOC when the buffer cannot be allocated. */
+int32_t start_gpio_trace(uint32_t);
+/* Stop recording, returns once every access in flight has been recorded. The trace is kept. */
+int32_t stop_gpio_trace(void);
+/* Records of the trace, its length and dropped count. Recording must be stopped, ESTATE otherwise. */
+int32_t get_gpio_trace(const gpio_trace_record_t **, uint64_t *, uint64_t *);
+/* Save the trace to a file. Recording must be stopped, ESTATE otherwise. EFILE_IO on a failed write. */
+int32_t save_gpio_trace(const char *);
+/* Record one register access, called by the accessors only */
+void __trace_gpio_reg(enum GpioTraceOp, volatile uint32_t *, uint32_t);
+#ifdef __cplusplus
+}
+#endif
+#endif
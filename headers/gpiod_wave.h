@@ -0,0 +1,107 @@
+#ifndef SRC_GPIOD_WAVE_H
+#define SRC_GPIOD_WAVE_H
+#include <stdint.h>
+#include <stdbool.h>
+#include <gpiod.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*******************************************************************************/
+// 
+// DESCRIPTION : Precompiled waveform playback over a bulk group of output lines.
+//
+// DETAILS     : A waveform is described once as a list of timed pin edges and
+//               compiled into steps of (set mask, clear mask, delay). Edges falling
+//               on the same instant are merged into one step. Playback walks the
+//               steps against absolute deadlines, spinning on the clock between them,
+//               and writes nothing but GPSET0/1 and GPCLR0/1 (only the registers a
+//               step actually changes). A new waveform can be queued while another
+//               plays, it is swapped in at the next loop boundary (double buffered).
+//               One waveform waits at a time, queueing another before the player
+//               picked the first up fails with ETHREAD. The waveform swapped out is
+//               retired: the player no longer reads it or its steps, and
+//               reclaim_gpio_wave() hands it back so the caller can recompile into
+//               that storage. Waveforms retire in the order they were queued, so one
+//               handed back means every waveform queued before it is free as well.
+//               Queueing arms the player and stop_gpio_wave() disarms it, a stop
+//               issued before play_gpio_wave() starts is therefore kept and that play
+//               returns at once, until a waveform is queued again.
+//
+/*******************************************************************************/
+
+/// GPIO Wave Structures ///
+// One edge of a waveform description
+typedef struct gpio_wave_edge {
+    // Time of the edge from the start of the waveform, in nanoseconds
+    uint32_t time_ns;
+    // The GPIO pin
+    uint8_t pin;
+    // Level driven, 0 (low) or 1 (high)
+    uint8_t level;
+} gpio_wave_edge_t;
+// One compiled step
+typedef struct gpio_wave_step {
+    // Pins driven high, as a 64-bit pin word
+    uint64_t set_mask;
+    // Pins driven low, as a 64-bit pin word
+    uint64_t clr_mask;
+    // Time from this step to the next, in nanoseconds
+    uint32_t delay_ns;
+} gpio_wave_step_t;
+// A compiled waveform over caller owned step storage
+typedef struct gpio_wave {
+    // Steps, in playback order
+    gpio_wave_step_t* steps;
+    // Number of steps
+    uint32_t num_steps;
+    // Pins the waveform drives
+    uint64_t pin_mask;
+} gpio_wave_t;
+// Edge timing achieved by a player
+typedef struct gpio_wave_timing {
+    // Steps emitted
+    uint64_t steps;
+    // Sum of the step lateness, in nanoseconds
+    uint64_t total_late_ns;
+    // Worst step lateness, in nanoseconds
+    uint64_t max_late_ns;
+} gpio_wave_timing_t;
+// Waveform player
+typedef struct gpio_wave_player {
+    // Group the waveform is written through
+    gpio_bulk_t* _bulk;
+    // Waveform playing
+    gpio_wave_t* _active;
+    // Waveform to swap in at the next loop boundary
+    GPIO_ATOMIC(gpio_wave_t *) _pending;
+    // Last waveform swapped out, not yet handed back
+    GPIO_ATOMIC(gpio_wave_t *) _retired;
+    // Set by a queue, cleared to stop the playback
+    GPIO_ATOMIC(bool) _running;
+    // Timing of the playback so far
+    gpio_wave_timing_t _timing;
+} gpio_wave_player_t;
+/// FUNCTIONS ///
+/* Compile edges (any order) into steps, storage must hold one more step than there are edges.
+ * The last step lasts until period_ns, the length of one loop of the waveform, which cannot be 0. */
+int32_t compile_gpio_wave(gpio_wave_t *, const gpio_wave_edge_t *, uint32_t, uint32_t, 
+                          gpio_wave_step_t *, uint32_t);
+/* Initialize a player writing through a requested bulk group */
+int32_t init_gpio_wave_player(gpio_wave_player_t *, gpio_bulk_t *);
+/* Queue a waveform and arm the player, it starts at the next loop boundary (or the next play), may
+ * be called while playing. ETHREAD while a waveform queued earlier has not been picked up */
+int32_t queue_gpio_wave(gpio_wave_player_t *, gpio_wave_t *);
+/* Play on the calling thread for the given number of loops, 0 loops until stop_gpio_wave(). Returns
+ * at once, having played nothing, when the player was stopped since the last queue */
+int32_t play_gpio_wave(gpio_wave_player_t *, uint32_t);
+/* Stop a playing waveform at the end of its current step, or the next play before it starts */
+int32_t stop_gpio_wave(gpio_wave_player_t *);
+/* The last waveform retired since the previous call, NULL if none, see above */
+gpio_wave_t* reclaim_gpio_wave(gpio_wave_player_t *);
+/* Edge timing achieved by the last playback */
+int32_t get_gpio_wave_timing(gpio_wave_player_t *, gpio_wave_timing_t *);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -1,10 +1,13 @@
 #include <stdbool.h>
+#include <pthread.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <gpiod.h>
+#include <gpiod_internals.h>
+#include <gpiod_regs.h>
 #include <gpio_addressing.h>
 #include <stddef.h>
 #include <fcntl.h>
-#include <stdlib.h>
 #include <unistd.h>
 
 /// ENUMS /// 
@@ -21,135 +24,60 @@ enum BitValue {
 };
 /// GLOBALS ///
 // Max Pin Count
-static const uint8_t PIN_MAX        = 57;
-// Max Pin bit value in bit-mapped register
-static const uint8_t PIN_MAX_BIT    = 32;
-// Base 10 const
-static const uint8_t BASE_TEN       = 10;
+static const uint8_t PIN_MAX        = GPIO_PIN_MAX;
+// Two bit mask
+static const uint8_t TWO_BIT_MASK   = 0x03;
 // Three bit mask
 static const uint8_t THREE_BIT_MASK = 0x07;
 // Size of a 32-bit int 
 static const uint8_t BIT32_SIZE    = 32;
-// Function Selection Registers
-static const uint32_t FNSEL_REGS[]  = {
-    GPFN_SEL0_OFF,
-    GPFN_SEL1_OFF,
-    GPFN_SEL2_OFF,
-    GPFN_SEL3_OFF,
-    GPFN_SEL4_OFF,
-    GPFN_SEL5_OFF
-};
-// Pull-up/Pull-down Registers
-static const uint32_t PUP_PDN_REGS [] = {
-    GP_PUP_PDN_CNTRL_REG0,
-    GP_PUP_PDN_CNTRL_REG1,
-    GP_PUP_PDN_CNTRL_REG2,
-    GP_PUP_PDN_CNTRL_REG3
-};
-// GPIO Set Registers
-static const uint32_t GPSET_REGS [] = {
-    GPSET0_OFF,
-    GPSET1_OFF
-};
-// GPIO Clear Registers
-static const uint32_t GPCLR_REGS [] = {
-    GPCLR0_OFF,
-    GPCLR1_OFF
-};
-// GPIO Level Registers 
-static const uint32_t GPLEV_REGS [] = {
-    GPLEV0_OFF,
-    GPLEV1_OFF
-};
-// GPIO Event Detection Status Registers 
-static const uint32_t GPEDS_REGS [] = {
-    GPEDS0_OFF,
-    GPEDS1_OFF
-};
-// GPIO Rising Edge Detect Enable Registers
-static const uint32_t GPREN_REGS [] = {
-    GPREN0_OFF,
-    GPREN1_OFF
-};
-// GPIO Falling Edge Detect Enable Registers
-static const uint32_t GPFEN_REGS [] = {
-    GPFEN0_OFF,
-    GPFEN1_OFF
-};
-// GPIO High Level Detect Enable Registers
-static const uint32_t GPHEN_REGS [] = {
-    GPHEN0_OFF,
-    GPHEN1_OFF
-};
-// GPIO Low Level Detect Enable Registers
-static const uint32_t GPLEN_REGS [] = {
-    GPLEN0_OFF,
-    GPLEN1_OFF
-};
-// GPIO Asynchronous Rising Edge Detect Enable Registers
-static const uint32_t GPAREN_REGS [] = {
-    GPAREN0_OFF,
-    GPAREN1_OFF
+// Pins per function select register
+#define PINS_PER_FSEL_REG    10
+// Pins per pull-up/pull-down register
+#define PINS_PER_PUP_PDN_REG 16
+// Pins per 1-bit mapped register
+#define PINS_PER_BIT_REG     32
+// Descriptor of pin n, computed by the compiler
+#define GPIO_PIN_DESC(n) {                                     \
+    ._fsel_reg      = (n) / PINS_PER_FSEL_REG,                 \
+    ._pup_pdn_reg   = (n) / PINS_PER_PUP_PDN_REG,              \
+    ._bank          = (n) / PINS_PER_BIT_REG,                  \
+    ._fsel_shift    = ((n) % PINS_PER_FSEL_REG) * 3,           \
+    ._pup_pdn_shift = ((n) % PINS_PER_PUP_PDN_REG) * 2,        \
+    ._bank_shift    = (n) % PINS_PER_BIT_REG,                  \
+}
+/// LOCKS ///
+// Register locks, see the concurrency model in gpiod_internals.h
+_gpio_reg_lock_t gpio_reg_locks[GPIO_ADDR_RANGE_SIZE / GPIO_REG_SIZE];
+// Serialises opening and closing the chip context
+static pthread_mutex_t gpio_chip_lock = PTHREAD_MUTEX_INITIALIZER;
+/// PIN DESCRIPTORS ///
+// Descriptors of every pin, four bytes each
+const _gpio_pin_desc_t gpio_pin_desc[GPIO_PIN_MAX + 1] = {
+    GPIO_PIN_DESC(0),  GPIO_PIN_DESC(1),  GPIO_PIN_DESC(2),  GPIO_PIN_DESC(3),  GPIO_PIN_DESC(4),
+    GPIO_PIN_DESC(5),  GPIO_PIN_DESC(6),  GPIO_PIN_DESC(7),  GPIO_PIN_DESC(8),  GPIO_PIN_DESC(9),
+    GPIO_PIN_DESC(10), GPIO_PIN_DESC(11), GPIO_PIN_DESC(12), GPIO_PIN_DESC(13), GPIO_PIN_DESC(14),
+    GPIO_PIN_DESC(15), GPIO_PIN_DESC(16), GPIO_PIN_DESC(17), GPIO_PIN_DESC(18), GPIO_PIN_DESC(19),
+    GPIO_PIN_DESC(20), GPIO_PIN_DESC(21), GPIO_PIN_DESC(22), GPIO_PIN_DESC(23), GPIO_PIN_DESC(24),
+    GPIO_PIN_DESC(25), GPIO_PIN_DESC(26), GPIO_PIN_DESC(27), GPIO_PIN_DESC(28), GPIO_PIN_DESC(29),
+    GPIO_PIN_DESC(30), GPIO_PIN_DESC(31), GPIO_PIN_DESC(32), GPIO_PIN_DESC(33), GPIO_PIN_DESC(34),
+    GPIO_PIN_DESC(35), GPIO_PIN_DESC(36), GPIO_PIN_DESC(37), GPIO_PIN_DESC(38), GPIO_PIN_DESC(39),
+    GPIO_PIN_DESC(40), GPIO_PIN_DESC(41), GPIO_PIN_DESC(42), GPIO_PIN_DESC(43), GPIO_PIN_DESC(44),
+    GPIO_PIN_DESC(45), GPIO_PIN_DESC(46), GPIO_PIN_DESC(47), GPIO_PIN_DESC(48), GPIO_PIN_DESC(49),
+    GPIO_PIN_DESC(50), GPIO_PIN_DESC(51), GPIO_PIN_DESC(52), GPIO_PIN_DESC(53), GPIO_PIN_DESC(54),
+    GPIO_PIN_DESC(55), GPIO_PIN_DESC(56), GPIO_PIN_DESC(57),
 };
-// GPIO Asynchronous Falling Edge Detect Enable Registers
-static const uint32_t GPAFEN_REGS [] = {
-    GPAFEN0_OFF,
-    GPAFEN1_OFF
+/// LINE POOL ///
+// Every requested line holds one slot, nothing is allocated on request
+_gpio_internals_t gpio_line_pool[GPIO_LINE_POOL_SIZE];
+/// CHIP CONTEXT ///
+// The one chip context of this process
+_gpio_chip_t gpio_chip = {
+    ._backend   = BACKEND_DEV_MEM,
+    ._fd        = -1,
+    ._ref_count = 0,
+    ._base      = NULL,
 };
-// Number of Pull-up/Pull-down Registers
-static const uint8_t PUP_PDN_REGS_SZ = sizeof(PUP_PDN_REGS)/sizeof(PUP_PDN_REGS[0]);
-// Number of Function Selection Offsets
-static const uint8_t FNSEL_REGS_SZ   = sizeof(FNSEL_REGS)/sizeof(FNSEL_REGS[0]);
-// Number of 1-bit mapped registers in a given array
-static const uint8_t BIT_1_REGS_SZ   = sizeof(GPSET_REGS)/sizeof(GPSET_REGS[0]);
-/// STRUCTS ///
-// Private data struct definition 
-typedef struct _gpio_internals {
-    /// File descriptor & Pin Value ///
-    // File descriptor used in the memory mapped space
-    int32_t _fd;
-    // The Pin selected
-    uint8_t _pin_value;
-    /// Bit Masks ///
-    // Write 1-bit mapped register mask
-    uint32_t _1_bit_map_mask;
-    // Write 2-bit mapped register mask
-    uint32_t _2_bit_map_mask;
-    // Write 3-bit mapped register mask
-    uint32_t _3_bit_map_mask;
-    /// Bit Shift ///
-    // TODO: ...
-    /// Functions ///
-    // Function to set the gpio pin high/low
-    int32_t (*_write_gpio)(_gpio_internals_t *, uint8_t);
-    // Function to set the gpio pin function
-    int32_t (*_set_gpio_fn)(_gpio_internals_t *, enum FunctionSelect);
-    /// Registers ///
-    // GPIO Function Selection Register
-    void* _fn_sel_reg;
-    // GPIO Pull Up/Pull Down Register
-    void* _pup_pdn_reg;
-    // GPIO Set Register
-    void* _set_reg;
-    // GPIO Clear Register
-    void* _clr_reg;
-    // GPIO Level Register
-    void* _lvl_reg;
-    // GPIO Event Detect Status Register
-    void* _eds_reg;
-    // GPIO Rising Edge Detect Register
-    void* _ren_reg;
-    // GPIO Falling Edge Detect Register
-    void* _fen_reg;
-    // GPIO High Level Detect Enable Register
-    void* _hen_reg;
-    // GPIO Low Level Detect Enable Register
-    void* _len_reg;
-    // GPIO Asynchronous Rising Edge Detect Enable
-    void* _aren_reg;
-    // GPIO Asynchronous Falling Edge Detect Enable
-    void* _afen_reg;
-}_gpio_internals_t;
 /// FUNCTION DECLARATIONS ///
 /* Check that the pin is in range */
 int32_t pin_in_range(uint8_t);
@@ -164,143 +92,622 @@ int32_t __set_gpio_fn(_gpio_internals_t *,
 
 /// FUNCTION DEFINITIONS ///
 /* "Public" Functions */
+// Open the chip context
+int32_t open_gpio_chip(const char* path)
+{
+    return __get_gpio_chip(BACKEND_DEV_MEM, path);
+}
+// Open the chip context on a backend
+int32_t open_gpio_backend(enum GpioBackend backend,
+                          const char* path)
+{
+    return __get_gpio_chip(backend, path);
+}
+// Close the chip context
+int32_t close_gpio_chip(void)
+{
+    return __put_gpio_chip();
+}
+// Base of the chip context mapping
+void* get_gpio_chip_base(void)
+{
+    return gpio_chip._base;
+}
 // Request a gpio line
 int32_t request_gpio_line(gpio_line_t * gpio_line_req, 
                           uint8_t pin_value)
 {
-    // Function selection register index
-    uint32_t fn_sel_reg_ind     = 0; 
-    // Single bit-map register
-    uint32_t single_bit_reg_ind = 0;
-    // Pull-up/pull down register 
-    uint32_t pup_pdn_reg_ind    = 0;
     // Return value for this request
     int32_t req_retval = 0;
-    // File descriptor for handle to /dev/mem
-    int32_t fd = -1;
-    // The GPIO base address from ARM peripheral space
-    void* gpio_base_uaddr = (void *) 0;
+    // Return value of taking the chip reference
+    int32_t chip_retval = 0;
+    // Pool slot index
+    uint8_t slot_ind    = 0;
+    // Nothing taken yet, make sure the failure path releases nothing
+    gpio_line_req->priv_dat = NULL;
     // Check that the pin is in range
     if (-1 == pin_in_range(pin_value))
     {
         req_retval = EBAD_PIN;
     }
-    // Open a file descriptor to devmem
-    else if (-1 == (fd = open("/dev/mem", O_RDWR)))
+    // Take a reference on the shared mapping, opening /dev/mem if no one has yet
+    else if (0 != (chip_retval = __get_gpio_chip(BACKEND_DEV_MEM, NULL)))
     {
-        req_retval = EDEVMEM_OPEN;
+        req_retval = chip_retval;
     } 
-    /* 
-     * Refer to the man page for mmap for the anatomy of this
-     * system call
-     */
-    // Memory map of GPIO memory address space to user space 
-    // MAP_FAILED = (void *) -1, the return value for value on an unsuccessful mmap
-    else if ((void *) -1 == (gpio_base_uaddr = mmap(0, GPIO_ADDR_RANGE_SIZE, PROT_READ | PROT_WRITE, 
-                                                    MAP_SHARED, fd, GPIO_BASE_REG_ADDR)))
+    // Claim the first free slot of the pool
+    else
     {
-        req_retval = EMAP_FAIL;
+        for (slot_ind = 0; (NULL == gpio_line_req->priv_dat) && (slot_ind < GPIO_LINE_POOL_SIZE); slot_ind++)
+        {
+            if (false == atomic_exchange(&gpio_line_pool[slot_ind]._in_use, true))
+            {
+                gpio_line_req->priv_dat = &gpio_line_pool[slot_ind];
+            }
+        }
+        // Every slot is held
+        if (NULL == gpio_line_req->priv_dat)
+        {
+            req_retval = EMALLOC;
+            __put_gpio_chip();
+        }
+        // The handle is the shared base and the pin, the rest comes from the pin's descriptor
+        else
+        {
+            gpio_line_req->priv_dat->_base       = gpio_chip._base;
+            gpio_line_req->priv_dat->_fd         = -1;
+            gpio_line_req->priv_dat->_pin_value  = pin_value;
+            gpio_line_req->priv_dat->_cdev_index = GPIO_CDEV_SOLO;
+            gpio_line_req->priv_dat->_cdev_flags = 0;
+            // On the character device the kernel must grant the line
+            if ((BACKEND_CHARDEV == gpio_chip._backend) && (0 != (req_retval = __cdev_request_line(gpio_line_req->priv_dat))))
+            {
+                atomic_store(&gpio_line_req->priv_dat->_in_use, false);
+                gpio_line_req->priv_dat = NULL;
+                __put_gpio_chip();
+            }
+        }
     }
-    // Allocate storage on the heap for the underlying private data structure
-    // Check that the malloc call did not fail
-    else if(NULL == (gpio_line_req->priv_dat = (_gpio_internals_t *) malloc(sizeof(_gpio_internals_t))))
+    return req_retval;
+}
+// Release a gpio line
+int32_t release_gpio_line(gpio_line_t* line)
+{
+    // The release return value
+    int32_t rel_retval = 0;
+
+    // Check the line was requested
+    if (NULL == line->priv_dat)
     {
-        req_retval = EMALLOC;
+        rel_retval = EPDAT_NULL;
     }
-    // Pin is in range, the /dev/mem open succeeded, GPIO register space is mapped, and malloc'ing the internals
-    // succeeded. Now, set the internal "private" data
     else
     {
-        /// Setting local(s) /// 
-        // Figure the function selection (more generally 3-bit mapped) register 
-        fn_sel_reg_ind     = ((pin_value / BASE_TEN) % FNSEL_REGS_SZ); 
-        // Figure the pull-up/pull-down (more generally 2-bit mapped) register
-        pup_pdn_reg_ind    = ((pin_value / (BIT32_SIZE / BIT_VALUE_1)) % PUP_PDN_REGS_SZ); // 16 pins per 2-bit allocated register (only pup_pdn)
-        // Figure the one bit mapped registers
-        single_bit_reg_ind = ((pin_value / PIN_MAX_BIT) % BIT_1_REGS_SZ);
-        /// Set internal private fields ///
-        // Internal file descriptor
-        gpio_line_req->priv_dat->_fd = fd;
-        // Internal pin value
-        gpio_line_req->priv_dat->_pin_value = pin_value;
-        // Bit masking for writing a function selection register specifically,
-        // generally referred to as "3-bit" mapped register
-        gpio_line_req->priv_dat->_3_bit_map_mask = fn_sel_reg_ind != (FNSEL_REGS_SZ - 1) ? 
-                                                       GPREG0_4_3BIT_WRITE_MASK :
-                                                       GPREG5_3BIT_WRITE_MASK;
-
-        // Bit masking for writing a pull up/pull down register specifically
-        gpio_line_req->priv_dat->_2_bit_map_mask = pup_pdn_reg_ind != (PUP_PDN_REGS_SZ - 1) ? 
-                                                       GPREG0_2_2BIT_WRITE_MASK :
-                                                       GPREG3_2BIT_WRITE_MASK;
-        // Bit masking for writing all 1-bit masked registers
-        gpio_line_req->priv_dat->_1_bit_map_mask = single_bit_reg_ind != (BIT_1_REGS_SZ - 1) ? 
-                                                       GPREG0_1BIT_WRITE_MASK :
-                                                       GPREG1_1BIT_WRITE_MASK;
-        /// Register selection ///
-        // The function selection register to use 
-        gpio_line_req->priv_dat->_fn_sel_reg  = gpio_base_uaddr + FNSEL_REGS[fn_sel_reg_ind];
-        // The pull-up/pull-down register to use 
-        gpio_line_req->priv_dat->_pup_pdn_reg = gpio_base_uaddr + PUP_PDN_REGS[pup_pdn_reg_ind];
-        // The set register to use
-        gpio_line_req->priv_dat->_set_reg     = gpio_base_uaddr + GPSET_REGS[single_bit_reg_ind];
-        // The clear register to use 
-        gpio_line_req->priv_dat->_clr_reg     = gpio_base_uaddr + GPCLR_REGS[single_bit_reg_ind];
-        // The level register to use
-        gpio_line_req->priv_dat->_lvl_reg     = gpio_base_uaddr + GPLEV_REGS[single_bit_reg_ind];
-        // The event detect register to use 
-        gpio_line_req->priv_dat->_eds_reg     = gpio_base_uaddr + GPEDS_REGS[single_bit_reg_ind];
-        // The rising edge detect enable register to use
-        gpio_line_req->priv_dat->_ren_reg     = gpio_base_uaddr + GPREN_REGS[single_bit_reg_ind];
-        // The falling edge detect enable register to use 
-        gpio_line_req->priv_dat->_fen_reg     = gpio_base_uaddr + GPFEN_REGS[single_bit_reg_ind];
-        // The high level detect enable register to use
-        gpio_line_req->priv_dat->_hen_reg     = gpio_base_uaddr + GPHEN_REGS[single_bit_reg_ind];
-        // The low level detect enable register to use 
-        gpio_line_req->priv_dat->_len_reg     = gpio_base_uaddr + GPLEN_REGS[single_bit_reg_ind];
-        // The async rising edge detect register to use
-        gpio_line_req->priv_dat->_aren_reg    = gpio_base_uaddr + GPAREN_REGS[single_bit_reg_ind];
-        // The async falling edge detect register to use 
-        gpio_line_req->priv_dat->_afen_reg    = gpio_base_uaddr + GPAFEN_REGS[single_bit_reg_ind];
-        /// Setting internal Functions ///
-        // Set the gpio function
-        gpio_line_req->priv_dat->_set_gpio_fn = __set_gpio_fn;
-        // Write the gpio line
-        gpio_line_req->priv_dat->_write_gpio  = __write_gpio;
-    }
-
-    // If the return value was set to anything non-nominal, then free the inner private data
-    // of the request object and close the file descriptor
-    if (0 != req_retval)
-    {
-        // Close the file descriptor even if it was not open
-        close(fd);
-        // Free the private data
-        free(gpio_line_req->priv_dat);
+        // Hand the slot back, the line no longer refers to the mapping or its kernel request
+        if (-1 != line->priv_dat->_fd)
+        {
+            __cdev_release_line(line->priv_dat);
+        }
+        line->priv_dat->_base = NULL;
+        atomic_store(&line->priv_dat->_in_use, false);
+        line->priv_dat = NULL;
+        rel_retval = __put_gpio_chip();
     }
-
-    return req_retval;
+    return rel_retval;
 }
 // Write GPIO value 
 int32_t write_gpio(gpio_line_t* line, 
                    uint8_t high_low)
 {
-    return (NULL != line->priv_dat) && line->priv_dat->_write_gpio(line->priv_dat, high_low);
+    /// LOCALS ///
+    // Start of the call
+    GPIO_STATS_START(start_ns);
+    // The write return value
+    int32_t write_retval = (NULL == line->priv_dat) ? EPDAT_NULL :
+                           (NULL == line->priv_dat->_base) ? __cdev_write_gpio(line->priv_dat, high_low) :
+                                                         __write_gpio(line->priv_dat, high_low);
+
+    GPIO_STATS_RECORD(GPIO_STATS_LINE(line), STAT_WRITE, write_retval, start_ns);
+    return write_retval;
+}
+// Read GPIO value
+int32_t read_gpio(gpio_line_t* line)
+{
+    /// LOCALS ///
+    // Start of the call
+    GPIO_STATS_START(start_ns);
+    // The read return value
+    int32_t read_retval = 0;
+
+    // Check the line was requested
+    if (NULL == line->priv_dat)
+    {
+        read_retval = EPDAT_NULL;
+    }
+    else if (NULL == line->priv_dat->_base)
+    {
+        read_retval = __cdev_read_gpio(line->priv_dat);
+    }
+    // Level of the pin in its bank's level register
+    else
+    {
+        read_retval = (gpio_reg_read(__gpio_bank_reg(line->priv_dat, GPLEV0_OFF)) >> 
+                       gpio_pin_desc[line->priv_dat->_pin_value]._bank_shift) & 0x01;
+    }
+    GPIO_STATS_RECORD(GPIO_STATS_LINE(line), STAT_READ, read_retval, start_ns);
+    return read_retval;
+}
+// Read all GPIO values
+int32_t read_gpio_levels(uint64_t* levels)
+{
+    /// LOCALS ///
+    // Start of the call
+    GPIO_STATS_START(start_ns);
+    // The read return value
+    int32_t read_retval = __read_gpio_levels(levels);
+
+    GPIO_STATS_RECORD(GPIO_STATS_CHIP, STAT_READ, read_retval, start_ns);
+    return read_retval;
 }
 // Set the GPIO function 
 int32_t set_gpio_fn(gpio_line_t* line, 
                     enum FunctionSelect sel)
 {
-    return (NULL != line->priv_dat) && line->priv_dat->_write_gpio(line->priv_dat, sel);
+    /// LOCALS ///
+    // Start of the call
+    GPIO_STATS_START(start_ns);
+    // The set return value
+    int32_t set_retval = (NULL == line->priv_dat) ? EPDAT_NULL :
+                         (NULL == line->priv_dat->_base) ? __cdev_set_gpio_fn(line->priv_dat, sel) :
+                                                       __set_gpio_fn(line->priv_dat, sel);
+
+    GPIO_STATS_RECORD(GPIO_STATS_LINE(line), STAT_SET_FN, set_retval, start_ns);
+    return set_retval;
+}
+// Select the GPIO pull resistor
+int32_t set_gpio_pull(gpio_line_t* line,
+                      enum PullSelect pull)
+{
+    /// LOCALS ///
+    // Start of the call
+    GPIO_STATS_START(start_ns);
+    // The pull return value
+    int32_t pull_retval = 0;
+    // Shift of the pin's field
+    uint32_t bit_shift  = 0x00;
+
+    // Check the line was requested
+    if (NULL == line->priv_dat)
+    {
+        pull_retval = EPDAT_NULL;
+    }
+    // 0b11 is reserved
+    else if (pull > PULL_DOWN)
+    {
+        pull_retval = EOUT_OF_RANGE;
+    }
+    else if (NULL == line->priv_dat->_base)
+    {
+        pull_retval = __cdev_set_gpio_pull(line->priv_dat, pull);
+    }
+    // Two bits per pin, sixteen pins per register, updated under the register's lock
+    else
+    {
+        bit_shift = gpio_pin_desc[line->priv_dat->_pin_value]._pup_pdn_shift;
+        __update_gpio_reg(__gpio_pup_pdn_reg(line->priv_dat), ((uint32_t) TWO_BIT_MASK) << bit_shift,
+                          ((uint32_t) pull) << bit_shift, __gpio_pup_pdn_mask(line->priv_dat));
+    }
+    GPIO_STATS_RECORD(GPIO_STATS_LINE(line), STAT_SET_PULL, pull_retval, start_ns);
+    return pull_retval;
+}
+// Locked read-modify-write of a register
+int32_t update_gpio_reg(uint32_t offset,
+                        uint32_t mask,
+                        uint32_t bits)
+{
+    /// LOCALS ///
+    // The update return value
+    int32_t update_retval = 0;
+
+    // Nothing mapped to write to
+    if (NULL == gpio_chip._base)
+    {
+        update_retval = __gpio_regs_retval();
+    }
+    // Whole registers of the mapped range only
+    else if ((offset >= GPIO_ADDR_RANGE_SIZE) || (0 != (offset % GPIO_REG_SIZE)))
+    {
+        update_retval = EOUT_OF_RANGE;
+    }
+    else
+    {
+        __update_gpio_reg((volatile uint32_t *)(gpio_chip._base + offset), mask, bits, 0xFFFFFFFF);
+    }
+    return update_retval;
+}
+// Request a bulk group
+int32_t request_gpio_bulk(gpio_bulk_t* bulk,
+                          gpio_line_t* lines,
+                          uint8_t num_lines)
+{
+    /// LOCALS ///
+    // The request return value
+    int32_t req_retval = 0;
+    // Pins of the group
+    uint64_t pin_mask  = 0x00;
+    // Line index
+    uint8_t line_ind   = 0;
+
+    // Nothing requested yet
+    bulk->pin_mask = 0x00;
+    bulk->_base    = NULL;
+    bulk->_fd      = -1;
+    // Validate every line once here, so that writes need not read back FSEL
+    for (line_ind = 0; (0 == req_retval) && (line_ind < num_lines); line_ind++)
+    {
+        // Line must have been requested
+        if (NULL == lines[line_ind].priv_dat)
+        {
+            req_retval = EPDAT_NULL;
+        }
+        // And configured as an output
+        else if (OUTPUT != __get_gpio_fn(lines[line_ind].priv_dat))
+        {
+            req_retval = EPIN_CONFIG;
+        }
+        else
+        {
+            pin_mask |= GPIO_PIN_BIT(lines[line_ind].priv_dat->_pin_value);
+        }
+    }
+    // The group keeps the mapping alive for as long as it exists
+    if ((0 == req_retval) && (0 == (req_retval = __get_gpio_chip(BACKEND_DEV_MEM, NULL))))
+    {
+        bulk->pin_mask = pin_mask;
+        bulk->_base    = gpio_chip._base;
+        // On the character device the group becomes one multi-line kernel request
+        if ((BACKEND_CHARDEV == gpio_chip._backend) && (0 != (req_retval = __cdev_request_gpio_bulk(bulk, lines, num_lines))))
+        {
+            bulk->pin_mask = 0x00;
+            __put_gpio_chip();
+        }
+    }
+    return req_retval;
+}
+// Write a bulk group
+int32_t write_gpio_bulk(gpio_bulk_t* bulk,
+                        uint64_t value,
+                        uint64_t mask)
+{
+    /// LOCALS ///
+    // Start of the call
+    GPIO_STATS_START(start_ns);
+    // The write return value
+    int32_t write_retval = 0;
+    // Pins driven high
+    uint64_t set_bits    = value & mask;
+    // Pins driven low
+    uint64_t clr_bits    = ~value & mask;
+
+    // Check the group was requested
+    if ((NULL == bulk->_base) && (-1 == bulk->_fd))
+    {
+        write_retval = EPDAT_NULL;
+    }
+    // Only the pins validated at request time may be written
+    else if (0 != (mask & ~bulk->pin_mask))
+    {
+        write_retval = EOUT_OF_RANGE;
+    }
+    // One SET_VALUES ioctl for the whole group
+    else if (-1 != bulk->_fd)
+    {
+        write_retval = __cdev_write_gpio_bulk(bulk, value, mask);
+    }
+    // At most one store per SET/CLR register
+    else
+    {
+        __write_gpio_masks(bulk->_base, set_bits, clr_bits);
+    }
+    GPIO_STATS_RECORD(GPIO_STATS_CHIP, STAT_WRITE, write_retval, start_ns);
+    return write_retval;
+}
+// Configure a fast path handle
+int32_t config_gpio_fast(gpio_fast_t* fast,
+                         gpio_line_t* line)
+{
+    /// LOCALS ///
+    // The configure return value
+    int32_t cfg_retval = 0;
+
+    // Check the line was requested
+    if (NULL == line->priv_dat)
+    {
+        cfg_retval = EPDAT_NULL;
+    }
+    // The fast path is a register store
+    else if (NULL == line->priv_dat->_base)
+    {
+        cfg_retval = EBACKEND;
+    }
+    // Direction is checked here once rather than on every write
+    else if (OUTPUT != __get_gpio_fn(line->priv_dat))
+    {
+        cfg_retval = EPIN_CONFIG;
+    }
+    // Cache the registers and pin bit
+    else
+    {
+        fast->_set_reg  = __gpio_bank_reg(line->priv_dat, GPSET0_OFF);
+        fast->_clr_reg  = __gpio_bank_reg(line->priv_dat, GPCLR0_OFF);
+        fast->_pin_mask = __gpio_bank_bit(line->priv_dat);
+    }
+    return cfg_retval;
+}
+// Release a bulk group
+int32_t release_gpio_bulk(gpio_bulk_t* bulk)
+{
+    /// LOCALS ///
+    // The release return value
+    int32_t rel_retval  = 0;
+    // Error of the group's lines taking their own requests back
+    int32_t line_retval = 0;
+
+    // Check the group was requested
+    if ((NULL == bulk->_base) && (-1 == bulk->_fd))
+    {
+        rel_retval = EPDAT_NULL;
+    }
+    else
+    {
+        // A line left without a kernel request is reported, the group is released all the same
+        if (-1 != bulk->_fd)
+        {
+            line_retval = __cdev_release_gpio_bulk(bulk);
+        }
+        bulk->pin_mask = 0x00;
+        bulk->_base    = NULL;
+        bulk->_fd      = -1;
+        rel_retval     = __put_gpio_chip();
+        rel_retval     = (0 != line_retval) ? line_retval : rel_retval;
+    }
+    return rel_retval;
+}
+// Write a line and timestamp it
+int32_t write_gpio_ts(gpio_line_t* line,
+                      uint8_t high_low,
+                      uint64_t* stamp_ns)
+{
+    /// LOCALS ///
+    // The write return value
+    int32_t write_retval = write_gpio(line, high_low);
+
+    *stamp_ns = gpio_time_ns();
+    return write_retval;
+}
+// Read a line and timestamp it
+int32_t read_gpio_ts(gpio_line_t* line,
+                     uint64_t* stamp_ns)
+{
+    /// LOCALS ///
+    // The read return value
+    int32_t read_retval = read_gpio(line);
+
+    *stamp_ns = gpio_time_ns();
+    return read_retval;
+}
+// Snapshot the levels and timestamp them
+int32_t read_gpio_levels_ts(uint64_t* levels,
+                            uint64_t* stamp_ns)
+{
+    /// LOCALS ///
+    // The read return value
+    int32_t read_retval = read_gpio_levels(levels);
+
+    *stamp_ns = gpio_time_ns();
+    return read_retval;
+}
+// Write a bulk group and timestamp it
+int32_t write_gpio_bulk_ts(gpio_bulk_t* bulk,
+                           uint64_t value,
+                           uint64_t mask,
+                           uint64_t* stamp_ns)
+{
+    /// LOCALS ///
+    // The write return value
+    int32_t write_retval = write_gpio_bulk(bulk, value, mask);
+
+    *stamp_ns = gpio_time_ns();
+    return write_retval;
 }
 
 /* "Private" Functions */
+// Take a reference on the chip context
+int32_t __get_gpio_chip(enum GpioBackend backend,
+                        const char * path)
+{
+    /// LOCALS ///
+    // The get return value
+    int32_t get_retval = 0;
+    // File descriptor for handle to the register space
+    int32_t fd = -1;
+    // Offset of the register space in the file, the peripheral address for /dev/mem, the
+    // start of the file for /dev/gpiomem which only exposes the GPIO block
+    off_t map_off = (BACKEND_DEV_MEM == backend) ? GPIO_BASE_REG_ADDR : 0;
+    // Status of the opened file
+    struct stat fd_stat;
+    // The GPIO base address from ARM peripheral space
+    void* gpio_base_uaddr = (void *) 0;
+
+    // Every timestamp taken through the chip comes from the timebase, calibrated on the first open
+    init_gpio_timebase();
+    // Opens and closes from different threads are serialised
+    pthread_mutex_lock(&gpio_chip_lock);
+#ifdef GPIOD_STATS
+    __open_gpio_stats();
+#endif
+#ifdef GPIOD_TRACE
+    __open_gpio_trace();
+#endif
+    // Already mapped, only take the reference
+    if (0 != gpio_chip._ref_count)
+    {
+        gpio_chip._ref_count++;
+    }
+    // The simulator has no file behind it, its register file is process memory
+    else if (BACKEND_SIM == backend)
+    {
+#ifdef GPIOD_SIM
+        gpio_chip._backend   = backend;
+        gpio_chip._base      = __gpio_sim_regs();
+        gpio_chip._ref_count = 1;
+#else
+        get_retval = EBACKEND;
+#endif
+    }
+    // The character device is not mapped, lines are requested from the kernel through it
+    else if (BACKEND_CHARDEV == backend)
+    {
+        if (0 > (fd = __cdev_open_chip(NULL != path ? path : GPIO_DEV_GPIOCHIP_PATH)))
+        {
+            get_retval = fd;
+            fd         = -1;
+        }
+        else
+        {
+            gpio_chip._backend   = backend;
+            gpio_chip._fd        = fd;
+            gpio_chip._base      = NULL;
+            gpio_chip._ref_count = 1;
+        }
+    }
+    // Open a file descriptor to the register space
+    else if (-1 == (fd = open(NULL != path ? path : 
+                              (BACKEND_GPIOMEM == backend) ? GPIO_DEV_GPIOMEM_PATH : GPIO_DEV_MEM_PATH, O_RDWR)))
+    {
+        get_retval = EDEVMEM_OPEN;
+    }
+    else if (-1 == fstat(fd, &fd_stat))
+    {
+        get_retval = EDEVMEM_OPEN;
+    }
+    else
+    {
+        // A regular file stands in for the register space, it is mapped from the start of the file
+        // and must be at least the size of the register range
+        if (S_ISREG(fd_stat.st_mode))
+        {
+            map_off = 0;
+        }
+        if (S_ISREG(fd_stat.st_mode) && (fd_stat.st_size < (off_t) GPIO_ADDR_RANGE_SIZE) &&
+            (-1 == ftruncate(fd, GPIO_ADDR_RANGE_SIZE)))
+        {
+            get_retval = EDEVMEM_OPEN;
+        }
+        /* 
+         * Refer to the man page for mmap for the anatomy of this
+         * system call
+         */
+        // Memory map of GPIO memory address space to user space 
+        // MAP_FAILED = (void *) -1, the return value for value on an unsuccessful mmap
+        else if ((void *) -1 == (gpio_base_uaddr = mmap(0, GPIO_ADDR_RANGE_SIZE, PROT_READ | PROT_WRITE, 
+                                                        MAP_SHARED, fd, map_off)))
+        {
+            get_retval = EMAP_FAIL;
+        }
+        // Mapping made, publish it with its first reference
+        else
+        {
+            gpio_chip._backend   = backend;
+            gpio_chip._fd        = fd;
+            gpio_chip._base      = gpio_base_uaddr;
+            gpio_chip._ref_count = 1;
+        }
+    }
+
+    // Close the file descriptor on failure, even if it was not open
+    if (0 != get_retval)
+    {
+        close(fd);
+    }
+    pthread_mutex_unlock(&gpio_chip_lock);
+    return get_retval;
+}
+// Drop a reference on the chip context
+int32_t __put_gpio_chip(void)
+{
+    /// LOCALS ///
+    // The put return value
+    int32_t put_retval = 0;
+
+    pthread_mutex_lock(&gpio_chip_lock);
+    // Nothing to drop
+    if (0 == gpio_chip._ref_count)
+    {
+        put_retval = ECHIP_CLOSED;
+    }
+    // Last reference, tear down the mapping
+    else if (0 == --gpio_chip._ref_count)
+    {
+        if (BACKEND_CHARDEV == gpio_chip._backend)
+        {
+            close(gpio_chip._fd);
+        }
+        else if (BACKEND_SIM != gpio_chip._backend)
+        {
+            munmap(gpio_chip._base, GPIO_ADDR_RANGE_SIZE);
+            close(gpio_chip._fd);
+        }
+        gpio_chip._base = NULL;
+        gpio_chip._fd   = -1;
+    }
+    pthread_mutex_unlock(&gpio_chip_lock);
+    return put_retval;
+}
 // Check the pin is in range
 int32_t pin_in_range(uint8_t pin)
 {
     // Very simply, check if greater than the max pin value
     return pin > PIN_MAX ? -1 : 0;
 }
+// Register access status
+int32_t __gpio_regs_retval(void)
+{
+    return (NULL != gpio_chip._base) ? 0 : ((0 != gpio_chip._ref_count) && (BACKEND_CHARDEV == gpio_chip._backend)) ?
+                                           EBACKEND : ECHIP_CLOSED;
+}
+// Read all GPIO values, uncounted
+int32_t __read_gpio_levels(uint64_t* levels)
+{
+    /// LOCALS ///
+    // The read return value
+    int32_t read_retval = 0;
+
+    // Nothing mapped to read from
+    if (NULL == gpio_chip._base)
+    {
+        read_retval = __gpio_regs_retval();
+    }
+    // One read per level register, the unused upper bits of GPLEV1 are masked out
+    else
+    {
+        *levels = ((uint64_t) (gpio_reg_read((volatile uint32_t *)(gpio_chip._base + GPLEV0_OFF)) & GPREG0_1BIT_READ_MASK)) |
+                  ((uint64_t) (gpio_reg_read((volatile uint32_t *)(gpio_chip._base + GPLEV1_OFF)) & GPREG1_1BIT_READ_MASK) << BIT32_SIZE);
+    }
+    return read_retval;
+}
+// Read back the pin function
+enum FunctionSelect __get_gpio_fn(_gpio_internals_t * __this_gpio_pdat)
+{
+    // The kernel holds the direction of character device lines
+    if (NULL == __this_gpio_pdat->_base)
+    {
+        return __cdev_get_gpio_fn(__this_gpio_pdat);
+    }
+    // Each FNSEL register is used for 10 pins, three bits per pin
+    return (enum FunctionSelect) ((gpio_reg_read(__gpio_fsel_reg(__this_gpio_pdat)) >> 
+                                   gpio_pin_desc[__this_gpio_pdat->_pin_value]._fsel_shift) & THREE_BIT_MASK);
+}
 // Internal set gpio function 
 int32_t __set_gpio_fn(_gpio_internals_t * __this_gpio_pdat,
                       enum FunctionSelect __fn_sel)
@@ -308,10 +715,8 @@ int32_t __set_gpio_fn(_gpio_internals_t * __this_gpio_pdat,
     /// LOCALS ///
     // Bit value that corresponds to the three bit value for function selection
     uint32_t fn_sel_bits    = 0x00;
-    // The clear value, used to unset the bits in registers corollary to this pin
-    uint32_t clear_bits     = 0x00;
-    // Register state
-    uint32_t register_state = 0x00;
+    // The pin's field of the register
+    uint32_t field_bits     = 0x00;
     // The bit shift that will be used to set the appropriate bits
     uint32_t bit_shift      = 0x00;
     // The set return value
@@ -333,17 +738,13 @@ int32_t __set_gpio_fn(_gpio_internals_t * __this_gpio_pdat,
         // Figure how far to shift the bits for setting function  
         // Explanation: Each FNSEL register is used for 10 pins, bits 0:2 belong to pin n,
         //              3:5 belong to pin n+1, ... 29:27 belong to pin n+9
-        bit_shift   = ((__this_gpio_pdat->_pin_value % BASE_TEN) * 3);
+        bit_shift   = gpio_pin_desc[__this_gpio_pdat->_pin_value]._fsel_shift;
         // The function selection bits, shifted for the appropriate pin
-        fn_sel_bits = (__fn_sel << bit_shift); 
-        // Clear bits, used to clear whatever was set in that register previously. Essentially unsetting
-        // any bits that were set for the pin we want to modify.
-        clear_bits  = ((0x03 << bit_shift) ^ __this_gpio_pdat->_3_bit_map_mask); 
-        // Read the register, mask out the bits we don't care about to 0
-        register_state = *(uint32_t *)__this_gpio_pdat->_fn_sel_reg & __this_gpio_pdat->_3_bit_map_mask; 
-        // Clear the register of bits pertaining to our pin, then write with what we wish to set
-        *(uint32_t *)__this_gpio_pdat->_fn_sel_reg = (register_state & clear_bits) | fn_sel_bits;
-        /*                                           ^---- clear operation         ^--- set operation */
+        fn_sel_bits = (((uint32_t) __fn_sel) << bit_shift); 
+        // The bits of our pin, whatever was set there previously is replaced
+        field_bits  = (((uint32_t) THREE_BIT_MASK) << bit_shift); 
+        // The register is shared by ten pins, update it under its lock so no other pin's change is lost
+        __update_gpio_reg(__gpio_fsel_reg(__this_gpio_pdat), field_bits, fn_sel_bits, __gpio_fsel_mask(__this_gpio_pdat));
     }
     return set_retval;
 }
@@ -354,18 +755,8 @@ int32_t __write_gpio(_gpio_internals_t * __this_gpio_pdat,
     /// LOCALS /// 
     // The write return value
     int32_t write_retval = 0;
-    // Figure the bits that correspond to the function selection register
-    uint32_t fn_sel_bit_shift = 0x00;
-    // The bit shift for set/clear registers
-    uint32_t setclr_bit_shift = 0x00;
     // The bit that will be set in the set/clear registers
-    uint32_t setclr_bit       = 0x00;
-    // The clear value, used to unset the bits in registers corollary to this pin
-    uint32_t clear_bits       = 0x00;
-    // Register state
-    uint32_t register_state   = 0x00;
-    // The bits to set
-    uint32_t bits_set         = 0x00;
+    uint32_t setclr_bit  = 0x00;
 
     // Check the private data is not NULL
     if (NULL == __this_gpio_pdat)
@@ -379,37 +770,26 @@ int32_t __write_gpio(_gpio_internals_t * __this_gpio_pdat,
     }
     else
     {
-        // The function selection bit shift
-        fn_sel_bit_shift = ((__this_gpio_pdat->_pin_value % BASE_TEN) * 3);
         // Check that the pin is configured with it's function as output
-        if (OUTPUT != ((*(uint32_t *)__this_gpio_pdat->_fn_sel_reg >> fn_sel_bit_shift) & THREE_BIT_MASK))
+        if (OUTPUT != __get_gpio_fn(__this_gpio_pdat))
         {
             write_retval = EPIN_CONFIG;
         }
         // Safety checks passing, write the pin
         else
         {
-            // Bit shift for set clear
-            setclr_bit_shift = (__this_gpio_pdat->_pin_value % PIN_MAX_BIT);
-            // Figure the bit shift for set/clear
-            setclr_bit = 0x01 << setclr_bit_shift;
-            // Figure the bit to clear
-            clear_bits  = ((0x01 << setclr_bit_shift) ^ __this_gpio_pdat->_1_bit_map_mask); 
-            // If write high, then write the set register 
+            // The bit that will be set in the set/clear registers
+            setclr_bit = __gpio_bank_bit(__this_gpio_pdat);
+            // SET/CLR are write only and a 0 bit has no effect, one store changes our pin alone
+            // and needs no lock. If write high, then write the set register 
             if (1 == high_low)
             {
-                // Read the register state, mask out bits we don't care about
-                register_state = *(uint32_t *)__this_gpio_pdat->_set_reg & __this_gpio_pdat->_1_bit_map_mask;
-                // Now, clear the corollary and set it appropriately 
-                *(uint32_t *)__this_gpio_pdat->_set_reg = (register_state & clear_bits) | setclr_bit;
+                gpio_reg_write(__gpio_bank_reg(__this_gpio_pdat, GPSET0_OFF), setclr_bit);
             }
             // If write low, then write the clear register
             else if (0 == high_low)
             {
-                // Read the register state, mask out bits we don't care about
-                register_state = *(uint32_t *)__this_gpio_pdat->_clr_reg & __this_gpio_pdat->_1_bit_map_mask;
-                // Now, clear the corollary and set it appropriately 
-                *(uint32_t *)__this_gpio_pdat->_clr_reg = (register_state & clear_bits) | setclr_bit;
+                gpio_reg_write(__gpio_bank_reg(__this_gpio_pdat, GPCLR0_OFF), setclr_bit);
             }
             // Otherwise the supplied value is out of range, don't write anything
             else
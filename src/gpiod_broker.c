@@ -0,0 +1,1102 @@
+#define _GNU_SOURCE
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/eventfd.h>
+#include <gpiod.h>
+#include <gpiod_broker.h>
+#include <gpiod_internals.h>
+
+/// GLOBALS ///
+// Every pin of the chip as a 64-bit pin word
+static const uint64_t BROKER_ALL_PINS     = (GPIO_PIN_BIT(GPIO_PIN_MAX) << 1) - 1;
+// Ring index mask
+static const uint32_t BROKER_RING_MASK    = GPIO_BROKER_RING_SIZE - 1;
+// Yields of a waiting client between checks that the broker is still there
+static const uint32_t BROKER_HUP_YIELDS   = 1024;
+// Spins before yielding, none on a single CPU where the other side cannot run while this one spins
+static uint32_t broker_spins              = GPIO_BROKER_SPINS;
+// File descriptors handed over by the handshake, the segment and the wake eventfd
+#define BROKER_HANDOVER_FDS 2
+
+/// FUNCTION DECLARATIONS ///
+/* Broker: accept a connection into a pending slot */
+static void __accept_gpio_broker_client(gpio_broker_t *);
+/* Broker: take what has arrived of a pending connection's handshake, answering it once complete */
+static void __greet_gpio_broker_client(gpio_broker_t *, _gpio_broker_pending_t *);
+/* Broker: close a pending connection */
+static void __close_gpio_broker_pending(_gpio_broker_pending_t *);
+/* Broker: request the pins of a new client and create its segment, the segment's fd is stored */
+static int32_t __admit_gpio_broker_client(gpio_broker_t *, _gpio_broker_conn_t *, uint64_t, int32_t *);
+/* Broker: drop a client and release its pins */
+static void __drop_gpio_broker_client(gpio_broker_t *, _gpio_broker_conn_t *);
+/* Broker: take up to GPIO_BROKER_BATCH commands of a client, returns the number taken */
+static uint32_t __serve_gpio_broker_client(gpio_broker_t *, _gpio_broker_conn_t *);
+/* Broker: run one command, storing the value of its response */
+static int32_t __run_gpio_broker_cmd(gpio_broker_t *, _gpio_broker_conn_t *, const gpio_broker_cmd_t *, uint64_t *);
+/* Broker: store the pending writes */
+static void __flush_gpio_broker(gpio_broker_t *);
+/* Broker: levels of the pins in mask */
+static int32_t __read_gpio_broker_levels(gpio_broker_t *, uint64_t, uint64_t *);
+/* Broker: mark every client's broker idle, false if a command arrived meanwhile */
+static bool __idle_gpio_broker(gpio_broker_t *);
+/* Broker: wait for socket activity up to timeout ms, accepting, greeting and dropping clients */
+static void __poll_gpio_broker(gpio_broker_t *, int32_t);
+/* Client: post a command */
+static int32_t __post_gpio_broker_cmd(gpio_broker_client_t *, const gpio_broker_cmd_t *);
+/* Client: post a command and wait for its response unless it has GPIO_BROKER_NO_REPLY */
+static int32_t __call_gpio_broker(gpio_broker_client_t *, gpio_broker_cmd_t *, uint64_t *);
+/* Client: wait one step, spinning then yielding. EBROKER once the broker is gone */
+static int32_t __backoff_gpio_broker(gpio_broker_client_t *, uint32_t *);
+/* Spin-wait hint to the CPU */
+static inline void __relax_gpio_broker(void);
+
+/// FUNCTION DEFINITIONS ///
+/* "Public" Functions */
+// Listen for clients
+int32_t init_gpio_broker(gpio_broker_t* broker,
+                         const char* path,
+                         uint32_t mode)
+{
+    /// LOCALS ///
+    // The init return value
+    int32_t init_retval     = 0;
+    // Address of the socket
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    // What is at the path already
+    struct stat path_stat;
+    // Probe of a socket already at the path
+    int32_t probe           = -1;
+    // The process umask while the socket is bound
+    mode_t old_mask         = 0;
+    // The bind return value
+    int32_t bind_retval     = 0;
+    // Connection index
+    uint8_t conn_ind        = 0;
+
+    broker_spins = (1 < sysconf(_SC_NPROCESSORS_ONLN)) ? GPIO_BROKER_SPINS : 0;
+    memset(broker, 0, sizeof(*broker));
+    broker->_listen_fd = -1;
+    broker->_wake_fd   = -1;
+    for (conn_ind = 0; conn_ind < GPIO_BROKER_MAX_CLIENTS; conn_ind++)
+    {
+        broker->_conns[conn_ind]._sock   = -1;
+        broker->_pending[conn_ind]._sock = -1;
+    }
+    path = (NULL != path) ? path : GPIO_BROKER_SOCKET_PATH;
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        init_retval = EOUT_OF_RANGE;
+    }
+    // Only a socket is the broker's to replace
+    else if ((0 == lstat(path, &path_stat)) && !S_ISSOCK(path_stat.st_mode))
+    {
+        init_retval = EBROKER;
+    }
+    else
+    {
+        strcpy(addr.sun_path, path);
+        strcpy(broker->_path, path);
+        // A socket nobody listens on is stale and replaced, a live broker keeps its own
+        if ((-1 != (probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0))) &&
+            (0 == connect(probe, (struct sockaddr *) &addr, sizeof(addr))))
+        {
+            init_retval = EBROKER;
+        }
+        else if ((-1 == (broker->_listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0))) ||
+                 ((0 != unlink(path)) && (ENOENT != errno)))
+        {
+            init_retval = EBROKER;
+        }
+        else
+        {
+            // The socket is created with its mode, it is never open to more than that
+            old_mask    = umask(~((mode_t) mode) & (S_IRWXU | S_IRWXG | S_IRWXO));
+            bind_retval = bind(broker->_listen_fd, (struct sockaddr *) &addr, sizeof(addr));
+            umask(old_mask);
+            if ((0 != bind_retval) ||
+                (0 != listen(broker->_listen_fd, GPIO_BROKER_MAX_CLIENTS)) ||
+                (-1 == (broker->_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))))
+            {
+                init_retval = EBROKER;
+            }
+        }
+        if (-1 != probe)
+        {
+            close(probe);
+        }
+    }
+    if (0 != init_retval)
+    {
+        if (-1 != broker->_listen_fd)
+        {
+            close(broker->_listen_fd);
+            broker->_listen_fd = -1;
+        }
+        if (-1 != broker->_wake_fd)
+        {
+            close(broker->_wake_fd);
+            broker->_wake_fd = -1;
+        }
+    }
+    atomic_store(&broker->_running, 0 == init_retval);
+    return init_retval;
+}
+// Serve clients
+int32_t run_gpio_broker(gpio_broker_t* broker)
+{
+    /// LOCALS ///
+    // Time of the last pass that took a command
+    uint64_t busy_ns         = gpio_time_ns();
+    // Passes since the socket was last checked
+    uint32_t passes          = 0;
+    // Passes since the last command
+    uint32_t empty           = 0;
+    // Commands taken in a pass
+    uint32_t taken           = 0;
+    // The connection served
+    _gpio_broker_conn_t* conn = NULL;
+    // Connection index
+    uint8_t conn_ind         = 0;
+
+    while (atomic_load_explicit(&broker->_running, memory_order_relaxed))
+    {
+        taken = 0;
+        for (conn_ind = 0; conn_ind < GPIO_BROKER_MAX_CLIENTS; conn_ind++)
+        {
+            if (-1 != broker->_conns[conn_ind]._sock)
+            {
+                taken += __serve_gpio_broker_client(broker, &broker->_conns[conn_ind]);
+            }
+        }
+        // Every write of the pass is stored before any of its responses is seen
+        __flush_gpio_broker(broker);
+        for (conn_ind = 0; conn_ind < GPIO_BROKER_MAX_CLIENTS; conn_ind++)
+        {
+            conn = &broker->_conns[conn_ind];
+            if ((-1 != conn->_sock) &&
+                (conn->_resp_head != atomic_load_explicit(&conn->_shm->_resp_head, memory_order_relaxed)))
+            {
+                atomic_store_explicit(&conn->_shm->_resp_head, conn->_resp_head, memory_order_release);
+            }
+        }
+        if (0 != taken)
+        {
+            busy_ns = gpio_time_ns();
+            empty   = 0;
+        }
+        else if (GPIO_BROKER_IDLE_NS <= (gpio_time_ns() - busy_ns))
+        {
+            if (__idle_gpio_broker(broker))
+            {
+                __poll_gpio_broker(broker, -1);
+            }
+            for (conn_ind = 0; conn_ind < GPIO_BROKER_MAX_CLIENTS; conn_ind++)
+            {
+                if (-1 != broker->_conns[conn_ind]._sock)
+                {
+                    atomic_store_explicit(&broker->_conns[conn_ind]._shm->_broker_idle, false, memory_order_relaxed);
+                }
+            }
+            busy_ns = gpio_time_ns();
+            passes  = 0;
+            empty   = 0;
+        }
+        else if (broker_spins > ++empty)
+        {
+            __relax_gpio_broker();
+        }
+        else
+        {
+            // A client waiting on the same CPU gets to post its next command
+            sched_yield();
+        }
+        // Clients keeping the broker busy must not keep new ones out
+        if (GPIO_BROKER_POLL_PASSES <= ++passes)
+        {
+            __poll_gpio_broker(broker, 0);
+            passes = 0;
+        }
+    }
+    return 0;
+}
+// Stop the broker
+void stop_gpio_broker(gpio_broker_t* broker)
+{
+    atomic_store(&broker->_running, false);
+    if (-1 != broker->_wake_fd)
+    {
+        eventfd_write(broker->_wake_fd, 1);
+    }
+}
+// Drop every client
+int32_t release_gpio_broker(gpio_broker_t* broker)
+{
+    /// LOCALS ///
+    // Connection index
+    uint8_t conn_ind = 0;
+
+    for (conn_ind = 0; conn_ind < GPIO_BROKER_MAX_CLIENTS; conn_ind++)
+    {
+        if (-1 != broker->_conns[conn_ind]._sock)
+        {
+            __drop_gpio_broker_client(broker, &broker->_conns[conn_ind]);
+        }
+        if (-1 != broker->_pending[conn_ind]._sock)
+        {
+            __close_gpio_broker_pending(&broker->_pending[conn_ind]);
+        }
+    }
+    if (-1 != broker->_listen_fd)
+    {
+        close(broker->_listen_fd);
+        unlink(broker->_path);
+        broker->_listen_fd = -1;
+    }
+    if (-1 != broker->_wake_fd)
+    {
+        close(broker->_wake_fd);
+        broker->_wake_fd = -1;
+    }
+    return 0;
+}
+// Connect to the broker
+int32_t open_gpio_broker(gpio_broker_client_t* client,
+                         const char* path,
+                         uint64_t pin_mask)
+{
+    /// LOCALS ///
+    // The open return value
+    int32_t open_retval          = 0;
+    // Address of the socket
+    struct sockaddr_un addr      = { .sun_family = AF_UNIX };
+    // Handshake
+    gpio_broker_hello_t hello    = { .magic = GPIO_BROKER_MAGIC, .version = GPIO_BROKER_VERSION, .pin_mask = pin_mask };
+    gpio_broker_welcome_t welcome;
+    // Message carrying the welcome and the handed over descriptors
+    struct iovec iov             = { .iov_base = &welcome, .iov_len = sizeof(welcome) };
+    union {
+        char buf[CMSG_SPACE(sizeof(int) * BROKER_HANDOVER_FDS)];
+        struct cmsghdr align;
+    } control;
+    struct msghdr msg            = { .msg_iov = &iov, .msg_iovlen = 1, .msg_control = control.buf,
+                                     .msg_controllen = sizeof(control.buf) };
+    struct cmsghdr* cmsg         = NULL;
+    // Descriptors handed over, the segment and the wake eventfd
+    int32_t fds[BROKER_HANDOVER_FDS] = { -1, -1 };
+    // The segment
+    gpio_broker_shm_t* shm       = MAP_FAILED;
+
+    path             = (NULL != path) ? path : GPIO_BROKER_SOCKET_PATH;
+    broker_spins     = (1 < sysconf(_SC_NPROCESSORS_ONLN)) ? GPIO_BROKER_SPINS : 0;
+    client->_shm     = NULL;
+    client->_sock    = -1;
+    client->_wake_fd = -1;
+    client->_seq     = 0;
+    client->pin_mask = 0x00;
+    if ((0 == pin_mask) || (0 != (pin_mask & ~BROKER_ALL_PINS)))
+    {
+        open_retval = EBAD_PIN;
+    }
+    else if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        open_retval = EOUT_OF_RANGE;
+    }
+    else
+    {
+        strcpy(addr.sun_path, path);
+        if ((-1 == (client->_sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0))) ||
+            (0 != connect(client->_sock, (struct sockaddr *) &addr, sizeof(addr))) ||
+            (sizeof(hello) != send(client->_sock, &hello, sizeof(hello), MSG_NOSIGNAL)) ||
+            (sizeof(welcome) != recvmsg(client->_sock, &msg, MSG_WAITALL | MSG_CMSG_CLOEXEC)) ||
+            (GPIO_BROKER_MAGIC != welcome.magic) || (GPIO_BROKER_VERSION != welcome.version))
+        {
+            open_retval = EBROKER;
+        }
+        else if (0 != welcome.status)
+        {
+            open_retval = welcome.status;
+        }
+        else if ((NULL == (cmsg = CMSG_FIRSTHDR(&msg))) || (SOL_SOCKET != cmsg->cmsg_level) ||
+                 (SCM_RIGHTS != cmsg->cmsg_type) || (CMSG_LEN(sizeof(fds)) != cmsg->cmsg_len))
+        {
+            open_retval = EBROKER;
+        }
+    }
+    if (0 == open_retval)
+    {
+        memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+        if (MAP_FAILED == (shm = mmap(NULL, sizeof(gpio_broker_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0)))
+        {
+            open_retval = EMAP_FAIL;
+        }
+        else if ((GPIO_BROKER_MAGIC != shm->magic) || (GPIO_BROKER_VERSION != shm->version))
+        {
+            open_retval = EBROKER;
+        }
+        else
+        {
+            client->_shm     = shm;
+            client->_wake_fd = fds[1];
+            client->pin_mask = shm->pin_mask;
+            fds[1]           = -1;
+        }
+    }
+    // The mapping outlives the segment's descriptor
+    if (-1 != fds[0])
+    {
+        close(fds[0]);
+    }
+    if (0 != open_retval)
+    {
+        if (-1 != fds[1])
+        {
+            close(fds[1]);
+        }
+        if (MAP_FAILED != shm)
+        {
+            munmap(shm, sizeof(gpio_broker_shm_t));
+        }
+        if (-1 != client->_sock)
+        {
+            close(client->_sock);
+            client->_sock = -1;
+        }
+    }
+    return open_retval;
+}
+// Disconnect
+int32_t close_gpio_broker(gpio_broker_client_t* client)
+{
+    /// LOCALS ///
+    // The close return value
+    int32_t close_retval = 0;
+
+    if (NULL == client->_shm)
+    {
+        close_retval = EPDAT_NULL;
+    }
+    else
+    {
+        munmap(client->_shm, sizeof(gpio_broker_shm_t));
+        close(client->_wake_fd);
+        close(client->_sock);
+        client->_shm     = NULL;
+        client->_sock    = -1;
+        client->_wake_fd = -1;
+        client->pin_mask = 0x00;
+    }
+    return close_retval;
+}
+// Write and wait
+int32_t write_gpio_broker(gpio_broker_client_t* client,
+                          uint64_t value,
+                          uint64_t mask)
+{
+    /// LOCALS ///
+    // The command
+    gpio_broker_cmd_t cmd = { .set_bits = value & mask, .clr_bits = ~value & mask, .op = BROKER_WRITE };
+
+    return __call_gpio_broker(client, &cmd, NULL);
+}
+// Write without waiting
+int32_t post_gpio_broker_write(gpio_broker_client_t* client,
+                               uint64_t value,
+                               uint64_t mask)
+{
+    /// LOCALS ///
+    // The command
+    gpio_broker_cmd_t cmd = { .set_bits = value & mask, .clr_bits = ~value & mask, .op = BROKER_WRITE,
+                              .flags = GPIO_BROKER_NO_REPLY };
+
+    return __call_gpio_broker(client, &cmd, NULL);
+}
+// Read the levels
+int32_t read_gpio_broker_levels(gpio_broker_client_t* client,
+                                uint64_t* levels)
+{
+    /// LOCALS ///
+    // The command
+    gpio_broker_cmd_t cmd = { .op = BROKER_READ_LEVELS };
+
+    return __call_gpio_broker(client, &cmd, levels);
+}
+// Set the function of a pin
+int32_t set_gpio_broker_fn(gpio_broker_client_t* client,
+                           uint8_t pin,
+                           enum FunctionSelect sel)
+{
+    /// LOCALS ///
+    // The command
+    gpio_broker_cmd_t cmd = { .op = BROKER_SET_FN, .pin = pin, .arg = (uint8_t) sel };
+
+    return __call_gpio_broker(client, &cmd, NULL);
+}
+// Set the pull of a pin
+int32_t set_gpio_broker_pull(gpio_broker_client_t* client,
+                             uint8_t pin,
+                             enum PullSelect pull)
+{
+    /// LOCALS ///
+    // The command
+    gpio_broker_cmd_t cmd = { .op = BROKER_SET_PULL, .pin = pin, .arg = (uint8_t) pull };
+
+    return __call_gpio_broker(client, &cmd, NULL);
+}
+// Wait for the posted commands
+int32_t sync_gpio_broker(gpio_broker_client_t* client)
+{
+    /// LOCALS ///
+    // The command
+    gpio_broker_cmd_t cmd = { .op = BROKER_SYNC };
+
+    return __call_gpio_broker(client, &cmd, NULL);
+}
+// Failed posted writes
+uint64_t gpio_broker_async_errors(gpio_broker_client_t* client)
+{
+    return (NULL != client->_shm) ? atomic_load_explicit(&client->_shm->_async_errors, memory_order_relaxed) : 0;
+}
+
+/* "Private" Functions */
+// Accept a connection
+static void __accept_gpio_broker_client(gpio_broker_t* broker)
+{
+    /// LOCALS ///
+    // The connection
+    int32_t sock                     = -1;
+    _gpio_broker_pending_t* pending  = NULL;
+    // Connection index
+    uint8_t conn_ind                 = 0;
+
+    if (-1 == (sock = accept4(broker->_listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)))
+    {
+        return;
+    }
+    for (conn_ind = 0; (NULL == pending) && (conn_ind < GPIO_BROKER_MAX_CLIENTS); conn_ind++)
+    {
+        pending = (-1 == broker->_pending[conn_ind]._sock) ? &broker->_pending[conn_ind] : NULL;
+    }
+    // Every slot holds a handshake not yet overdue, the client sees its connection closed
+    if (NULL == pending)
+    {
+        close(sock);
+    }
+    else
+    {
+        pending->_sock      = sock;
+        pending->_len       = 0;
+        pending->_accept_ns = gpio_time_ns();
+    }
+}
+// Greet a client
+static void __greet_gpio_broker_client(gpio_broker_t* broker,
+                                       _gpio_broker_pending_t* pending)
+{
+    /// LOCALS ///
+    // Handshake
+    gpio_broker_hello_t* hello    = &pending->_hello;
+    gpio_broker_welcome_t welcome = { .magic = GPIO_BROKER_MAGIC, .version = GPIO_BROKER_VERSION, .status = 0 };
+    // Bytes of the handshake received now
+    ssize_t got                   = 0;
+    // Message carrying the welcome and, on success, the descriptors
+    struct iovec iov              = { .iov_base = &welcome, .iov_len = sizeof(welcome) };
+    union {
+        char buf[CMSG_SPACE(sizeof(int) * BROKER_HANDOVER_FDS)];
+        struct cmsghdr align;
+    } control;
+    struct msghdr msg             = { .msg_iov = &iov, .msg_iovlen = 1 };
+    struct cmsghdr* cmsg          = NULL;
+    // Descriptors handed over
+    int32_t fds[BROKER_HANDOVER_FDS] = { -1, broker->_wake_fd };
+    // The connection
+    int32_t sock                  = pending->_sock;
+    _gpio_broker_conn_t* conn     = NULL;
+    // Connection index
+    uint8_t conn_ind              = 0;
+
+    got = recv(pending->_sock, (uint8_t *) hello + pending->_len, sizeof(*hello) - pending->_len, 0);
+    if (0 < got)
+    {
+        pending->_len += (uint32_t) got;
+    }
+    // The rest of the handshake is still on its way
+    if ((0 < got) && (sizeof(*hello) > pending->_len))
+    {
+        return;
+    }
+    if ((-1 == got) && ((EAGAIN == errno) || (EWOULDBLOCK == errno) || (EINTR == errno)))
+    {
+        return;
+    }
+    // Complete, closed or failed, the handshake leaves its slot
+    pending->_sock = -1;
+    for (conn_ind = 0; (NULL == conn) && (conn_ind < GPIO_BROKER_MAX_CLIENTS); conn_ind++)
+    {
+        conn = (-1 == broker->_conns[conn_ind]._sock) ? &broker->_conns[conn_ind] : NULL;
+    }
+    if ((sizeof(*hello) != pending->_len) ||
+        (GPIO_BROKER_MAGIC != hello->magic) || (GPIO_BROKER_VERSION != hello->version))
+    {
+        welcome.status = EBROKER;
+    }
+    else if ((0 == hello->pin_mask) || (0 != (hello->pin_mask & ~BROKER_ALL_PINS)))
+    {
+        welcome.status = EBAD_PIN;
+    }
+    // A pin has one owner at a time
+    else if (0 != (hello->pin_mask & broker->_owned))
+    {
+        welcome.status = EPIN_CONFIG;
+    }
+    else if (NULL == conn)
+    {
+        welcome.status = EMALLOC;
+    }
+    else
+    {
+        welcome.status = __admit_gpio_broker_client(broker, conn, hello->pin_mask, &fds[0]);
+    }
+    if (0 == welcome.status)
+    {
+        msg.msg_control    = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+        cmsg               = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level   = SOL_SOCKET;
+        cmsg->cmsg_type    = SCM_RIGHTS;
+        cmsg->cmsg_len     = CMSG_LEN(sizeof(fds));
+        memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+        conn->_sock        = sock;
+    }
+    // The welcome fits the empty socket buffer, a client gone before it is dropped at once
+    if ((sizeof(welcome) != sendmsg(sock, &msg, MSG_NOSIGNAL)) && (0 == welcome.status))
+    {
+        __drop_gpio_broker_client(broker, conn);
+    }
+    else if (0 != welcome.status)
+    {
+        close(sock);
+    }
+    if (-1 != fds[0])
+    {
+        close(fds[0]);
+    }
+}
+// Close a pending connection
+static void __close_gpio_broker_pending(_gpio_broker_pending_t* pending)
+{
+    close(pending->_sock);
+    pending->_sock = -1;
+}
+// Admit a client
+static int32_t __admit_gpio_broker_client(gpio_broker_t* broker,
+                                          _gpio_broker_conn_t* conn,
+                                          uint64_t pin_mask,
+                                          int32_t* shm_fd)
+{
+    /// LOCALS ///
+    // The admit return value
+    int32_t admit_retval   = 0;
+    // Pins requested so far, and those of them configured as OUTPUT
+    uint64_t requested     = 0x00;
+    uint64_t outputs       = 0x00;
+    // The segment
+    gpio_broker_shm_t* shm = MAP_FAILED;
+    // Pin index
+    uint8_t pin            = 0;
+
+    for (pin = 0; (0 == admit_retval) && (pin <= GPIO_PIN_MAX); pin++)
+    {
+        if ((0 != (pin_mask & GPIO_PIN_BIT(pin))) &&
+            (0 == (admit_retval = request_gpio_line(&broker->_lines[pin], pin))))
+        {
+            requested |= GPIO_PIN_BIT(pin);
+            outputs   |= (OUTPUT == __get_gpio_fn(broker->_lines[pin].priv_dat)) ? GPIO_PIN_BIT(pin) : 0x00;
+        }
+    }
+    if ((0 == admit_retval) &&
+        ((-1 == (*shm_fd = memfd_create("gpiod-broker", MFD_CLOEXEC))) ||
+         (0 != ftruncate(*shm_fd, sizeof(gpio_broker_shm_t))) ||
+         (MAP_FAILED == (shm = mmap(NULL, sizeof(gpio_broker_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, *shm_fd, 0)))))
+    {
+        admit_retval = EMALLOC;
+    }
+    if (0 == admit_retval)
+    {
+        // The segment starts zeroed, every ring empty
+        shm->magic       = GPIO_BROKER_MAGIC;
+        shm->version     = GPIO_BROKER_VERSION;
+        shm->pin_mask    = pin_mask;
+        conn->_shm       = shm;
+        conn->_pin_mask  = pin_mask;
+        conn->_resp_head = 0;
+        broker->_owned   |= pin_mask;
+        broker->_outputs |= outputs;
+    }
+    else
+    {
+        for (pin = 0; pin <= GPIO_PIN_MAX; pin++)
+        {
+            if (0 != (requested & GPIO_PIN_BIT(pin)))
+            {
+                release_gpio_line(&broker->_lines[pin]);
+            }
+        }
+        if (-1 != *shm_fd)
+        {
+            close(*shm_fd);
+            *shm_fd = -1;
+        }
+    }
+    return admit_retval;
+}
+// Drop a client
+static void __drop_gpio_broker_client(gpio_broker_t* broker,
+                                      _gpio_broker_conn_t* conn)
+{
+    /// LOCALS ///
+    // Pin index
+    uint8_t pin = 0;
+
+    // Writes still pending may be the client's
+    __flush_gpio_broker(broker);
+    for (pin = 0; pin <= GPIO_PIN_MAX; pin++)
+    {
+        if (0 != (conn->_pin_mask & GPIO_PIN_BIT(pin)))
+        {
+            release_gpio_line(&broker->_lines[pin]);
+        }
+    }
+    broker->_owned   &= ~conn->_pin_mask;
+    broker->_outputs &= ~conn->_pin_mask;
+    munmap(conn->_shm, sizeof(gpio_broker_shm_t));
+    close(conn->_sock);
+    conn->_shm      = NULL;
+    conn->_sock     = -1;
+    conn->_pin_mask = 0x00;
+}
+// Take a client's commands
+static uint32_t __serve_gpio_broker_client(gpio_broker_t* broker,
+                                           _gpio_broker_conn_t* conn)
+{
+    /// LOCALS ///
+    // The segment
+    gpio_broker_shm_t* shm  = conn->_shm;
+    // Next command taken, and the client's next slot
+    uint32_t tail           = atomic_load_explicit(&shm->_cmd_tail, memory_order_relaxed);
+    uint32_t head           = atomic_load_explicit(&shm->_cmd_head, memory_order_acquire);
+    // Responses the client has taken
+    uint32_t resp_tail      = atomic_load_explicit(&shm->_resp_tail, memory_order_acquire);
+    // Commands taken
+    uint32_t taken          = 0;
+    // Copy of the command, the client cannot change it once checked
+    gpio_broker_cmd_t cmd;
+    // Response slot
+    gpio_broker_resp_t* resp = NULL;
+    // Value and status of the command
+    uint64_t value          = 0x00;
+    int32_t status          = 0;
+
+    while ((tail != head) && (taken < GPIO_BROKER_BATCH))
+    {
+        cmd = shm->_cmds[tail & BROKER_RING_MASK];
+        // The response ring is full, the rest waits for the client to take some
+        if ((0 == (cmd.flags & GPIO_BROKER_NO_REPLY)) && (GPIO_BROKER_RING_SIZE == (conn->_resp_head - resp_tail)))
+        {
+            break;
+        }
+        status = __run_gpio_broker_cmd(broker, conn, &cmd, &value);
+        if (0 == (cmd.flags & GPIO_BROKER_NO_REPLY))
+        {
+            resp         = &shm->_resps[conn->_resp_head & BROKER_RING_MASK];
+            resp->value  = value;
+            resp->seq    = cmd.seq;
+            resp->status = status;
+            conn->_resp_head++;
+        }
+        else if (0 != status)
+        {
+            atomic_fetch_add_explicit(&shm->_async_errors, 1, memory_order_relaxed);
+        }
+        tail++;
+        taken++;
+    }
+    if (0 != taken)
+    {
+        atomic_store_explicit(&shm->_cmd_tail, tail, memory_order_release);
+    }
+    return taken;
+}
+// Run one command
+static int32_t __run_gpio_broker_cmd(gpio_broker_t* broker,
+                                     _gpio_broker_conn_t* conn,
+                                     const gpio_broker_cmd_t* cmd,
+                                     uint64_t* value)
+{
+    /// LOCALS ///
+    // The run return value
+    int32_t run_retval = 0;
+    // Pins the command writes
+    uint64_t write_mask = cmd->set_bits | cmd->clr_bits;
+
+    *value = 0x00;
+    broker->commands++;
+    if (BROKER_WRITE == cmd->op)
+    {
+        broker->writes++;
+        if (0 != (write_mask & ~conn->_pin_mask))
+        {
+            run_retval = EBAD_PIN;
+        }
+        else if (0 != (cmd->set_bits & cmd->clr_bits))
+        {
+            run_retval = EOUT_OF_RANGE;
+        }
+        else if (0 != (write_mask & ~broker->_outputs))
+        {
+            run_retval = EPIN_CONFIG;
+        }
+        else
+        {
+            // A pin pending at the other level is stored first, its level must be seen
+            if (0 != ((cmd->set_bits & broker->_pending_clr) | (cmd->clr_bits & broker->_pending_set)))
+            {
+                __flush_gpio_broker(broker);
+            }
+            broker->_pending_set |= cmd->set_bits;
+            broker->_pending_clr |= cmd->clr_bits;
+        }
+    }
+    else if (((BROKER_SET_FN == cmd->op) || (BROKER_SET_PULL == cmd->op)) &&
+             ((GPIO_PIN_MAX < cmd->pin) || (0 == (conn->_pin_mask & GPIO_PIN_BIT(cmd->pin)))))
+    {
+        run_retval = EBAD_PIN;
+    }
+    else if (((BROKER_SET_FN == cmd->op) && (ALT_3 < cmd->arg)) || ((BROKER_SET_PULL == cmd->op) && (PULL_DOWN < cmd->arg)))
+    {
+        run_retval = EOUT_OF_RANGE;
+    }
+    // Everything else runs after the writes taken before it
+    else if (BROKER_SET_FN == cmd->op)
+    {
+        __flush_gpio_broker(broker);
+        if (0 == (run_retval = set_gpio_fn(&broker->_lines[cmd->pin], (enum FunctionSelect) cmd->arg)))
+        {
+            broker->_outputs = (broker->_outputs & ~GPIO_PIN_BIT(cmd->pin)) |
+                               ((OUTPUT == cmd->arg) ? GPIO_PIN_BIT(cmd->pin) : 0x00);
+        }
+    }
+    else if (BROKER_SET_PULL == cmd->op)
+    {
+        __flush_gpio_broker(broker);
+        run_retval = set_gpio_pull(&broker->_lines[cmd->pin], (enum PullSelect) cmd->arg);
+    }
+    else if (BROKER_READ_LEVELS == cmd->op)
+    {
+        __flush_gpio_broker(broker);
+        run_retval = __read_gpio_broker_levels(broker, conn->_pin_mask, value);
+    }
+    else if (BROKER_SYNC == cmd->op)
+    {
+        __flush_gpio_broker(broker);
+    }
+    else
+    {
+        run_retval = EOUT_OF_RANGE;
+    }
+    return run_retval;
+}
+// Store the pending writes
+static void __flush_gpio_broker(gpio_broker_t* broker)
+{
+    /// LOCALS ///
+    // Pin index
+    uint8_t pin = 0;
+
+    if (0 == (broker->_pending_set | broker->_pending_clr))
+    {
+        return;
+    }
+    // At most one store per SET/CLR register for every client's writes
+    if (NULL != gpio_chip._base)
+    {
+        __write_gpio_masks(gpio_chip._base, broker->_pending_set, broker->_pending_clr);
+    }
+    // The character device has no registers, each line is written through its request
+    else
+    {
+        for (pin = 0; pin <= GPIO_PIN_MAX; pin++)
+        {
+            if (0 != ((broker->_pending_set | broker->_pending_clr) & GPIO_PIN_BIT(pin)))
+            {
+                write_gpio(&broker->_lines[pin], 0 != (broker->_pending_set & GPIO_PIN_BIT(pin)));
+            }
+        }
+    }
+    broker->_pending_set = 0x00;
+    broker->_pending_clr = 0x00;
+    broker->flushes++;
+}
+// Levels of some pins
+static int32_t __read_gpio_broker_levels(gpio_broker_t* broker,
+                                         uint64_t pin_mask,
+                                         uint64_t* levels)
+{
+    /// LOCALS ///
+    // The read return value
+    int32_t read_retval = __read_gpio_levels(levels);
+    // Level of one pin
+    int32_t level       = 0;
+    // Pin index
+    uint8_t pin         = 0;
+
+    // Without registers the pins are read one line at a time
+    if (EBACKEND == read_retval)
+    {
+        read_retval = 0;
+        *levels     = 0x00;
+        for (pin = 0; (0 == read_retval) && (pin <= GPIO_PIN_MAX); pin++)
+        {
+            if ((0 != (pin_mask & GPIO_PIN_BIT(pin))) && (0 <= (level = read_gpio(&broker->_lines[pin]))))
+            {
+                *levels |= (0 != level) ? GPIO_PIN_BIT(pin) : 0x00;
+            }
+            else if (0 != (pin_mask & GPIO_PIN_BIT(pin)))
+            {
+                read_retval = level;
+            }
+        }
+    }
+    *levels &= pin_mask;
+    return read_retval;
+}
+// Mark the broker idle
+static bool __idle_gpio_broker(gpio_broker_t* broker)
+{
+    /// LOCALS ///
+    // Whether the broker may sleep
+    bool idle        = true;
+    // Connection index
+    uint8_t conn_ind = 0;
+
+    for (conn_ind = 0; conn_ind < GPIO_BROKER_MAX_CLIENTS; conn_ind++)
+    {
+        if (-1 != broker->_conns[conn_ind]._sock)
+        {
+            atomic_store(&broker->_conns[conn_ind]._shm->_broker_idle, true);
+        }
+    }
+    // Pairs with the fence a client takes between publishing a command and reading the flag, either
+    // the client sees the flag and wakes the broker or the broker sees the command here
+    atomic_thread_fence(memory_order_seq_cst);
+    for (conn_ind = 0; idle && (conn_ind < GPIO_BROKER_MAX_CLIENTS); conn_ind++)
+    {
+        if (-1 != broker->_conns[conn_ind]._sock)
+        {
+            idle = (atomic_load(&broker->_conns[conn_ind]._shm->_cmd_head) ==
+                    atomic_load_explicit(&broker->_conns[conn_ind]._shm->_cmd_tail, memory_order_relaxed));
+        }
+    }
+    return idle && atomic_load(&broker->_running);
+}
+// Wait for socket activity
+static void __poll_gpio_broker(gpio_broker_t* broker,
+                               int32_t timeout_ms)
+{
+    /// LOCALS ///
+    // Listening socket, wake eventfd, one entry per client and one per pending handshake
+    struct pollfd fds[2 + (2 * GPIO_BROKER_MAX_CLIENTS)];
+    // Connection or pending slot of each entry after the first two
+    uint8_t fd_conn[2 * GPIO_BROKER_MAX_CLIENTS];
+    // Entries used, and the first pending handshake entry
+    uint8_t num_fds        = 2;
+    uint8_t pending_fd     = 0;
+    // Wake count drained
+    eventfd_t wakes        = 0;
+    // Time a pending handshake may still take, in milliseconds
+    int32_t hello_ms       = (int32_t) (GPIO_BROKER_HELLO_NS / 1000000);
+    // The poll return value
+    int32_t poll_retval    = 0;
+    // Connection and entry index
+    uint8_t conn_ind       = 0;
+    uint8_t fd_ind         = 0;
+
+    fds[0].fd     = broker->_listen_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd     = broker->_wake_fd;
+    fds[1].events = POLLIN;
+    for (conn_ind = 0; conn_ind < GPIO_BROKER_MAX_CLIENTS; conn_ind++)
+    {
+        if (-1 != broker->_conns[conn_ind]._sock)
+        {
+            fd_conn[num_fds - 2]    = conn_ind;
+            fds[num_fds].fd         = broker->_conns[conn_ind]._sock;
+            fds[num_fds++].events   = POLLIN;
+        }
+    }
+    pending_fd = num_fds;
+    for (conn_ind = 0; conn_ind < GPIO_BROKER_MAX_CLIENTS; conn_ind++)
+    {
+        if (-1 != broker->_pending[conn_ind]._sock)
+        {
+            fd_conn[num_fds - 2]    = conn_ind;
+            fds[num_fds].fd         = broker->_pending[conn_ind]._sock;
+            fds[num_fds++].events   = POLLIN;
+        }
+    }
+    // An idle broker with handshakes pending wakes up to close the overdue ones
+    if ((pending_fd != num_fds) && ((0 > timeout_ms) || (hello_ms < timeout_ms)))
+    {
+        timeout_ms = hello_ms;
+    }
+    poll_retval = poll(fds, num_fds, timeout_ms);
+    if ((0 < poll_retval) && (0 != (fds[1].revents & POLLIN)))
+    {
+        eventfd_read(broker->_wake_fd, &wakes);
+    }
+    // A client sends nothing after its handshake, anything readable is its hangup
+    for (fd_ind = 2; (0 < poll_retval) && (fd_ind < pending_fd); fd_ind++)
+    {
+        if (0 != fds[fd_ind].revents)
+        {
+            __drop_gpio_broker_client(broker, &broker->_conns[fd_conn[fd_ind - 2]]);
+        }
+    }
+    for (fd_ind = pending_fd; (0 < poll_retval) && (fd_ind < num_fds); fd_ind++)
+    {
+        if (0 != fds[fd_ind].revents)
+        {
+            __greet_gpio_broker_client(broker, &broker->_pending[fd_conn[fd_ind - 2]]);
+        }
+    }
+    for (conn_ind = 0; conn_ind < GPIO_BROKER_MAX_CLIENTS; conn_ind++)
+    {
+        if ((-1 != broker->_pending[conn_ind]._sock) &&
+            (GPIO_BROKER_HELLO_NS <= (gpio_time_ns() - broker->_pending[conn_ind]._accept_ns)))
+        {
+            __close_gpio_broker_pending(&broker->_pending[conn_ind]);
+        }
+    }
+    if ((0 < poll_retval) && (0 != (fds[0].revents & POLLIN)))
+    {
+        __accept_gpio_broker_client(broker);
+    }
+}
+// Post a command
+static int32_t __post_gpio_broker_cmd(gpio_broker_client_t* client,
+                                      const gpio_broker_cmd_t* cmd)
+{
+    /// LOCALS ///
+    // The post return value
+    int32_t post_retval    = 0;
+    // The segment
+    gpio_broker_shm_t* shm = client->_shm;
+    // Next command slot
+    uint32_t head          = atomic_load_explicit(&shm->_cmd_head, memory_order_relaxed);
+    // Waits for a free slot
+    uint32_t spins         = 0;
+
+    while ((0 == post_retval) &&
+           (GPIO_BROKER_RING_SIZE == (head - atomic_load_explicit(&shm->_cmd_tail, memory_order_acquire))))
+    {
+        post_retval = __backoff_gpio_broker(client, &spins);
+    }
+    if (0 == post_retval)
+    {
+        shm->_cmds[head & BROKER_RING_MASK] = *cmd;
+        atomic_store_explicit(&shm->_cmd_head, head + 1, memory_order_release);
+        // Pairs with the fence in __idle_gpio_broker(), only the client that clears the flag wakes the broker
+        atomic_thread_fence(memory_order_seq_cst);
+        if (atomic_load_explicit(&shm->_broker_idle, memory_order_relaxed) &&
+            atomic_exchange(&shm->_broker_idle, false))
+        {
+            eventfd_write(client->_wake_fd, 1);
+        }
+    }
+    return post_retval;
+}
+// Post a command and wait for its response
+static int32_t __call_gpio_broker(gpio_broker_client_t* client,
+                                  gpio_broker_cmd_t* cmd,
+                                  uint64_t* value)
+{
+    /// LOCALS ///
+    // The call return value
+    int32_t call_retval = 0;
+    // Next response taken
+    uint32_t tail       = 0;
+    // Waits for the response
+    uint32_t spins      = 0;
+    // The response
+    gpio_broker_resp_t resp;
+
+    cmd->seq = client->_seq++;
+    if (NULL == client->_shm)
+    {
+        call_retval = EPDAT_NULL;
+    }
+    else if ((0 != (call_retval = __post_gpio_broker_cmd(client, cmd))) || (0 != (cmd->flags & GPIO_BROKER_NO_REPLY)))
+    {
+        // Failed to post, or nothing to wait for
+    }
+    else
+    {
+        tail = atomic_load_explicit(&client->_shm->_resp_tail, memory_order_relaxed);
+        while ((0 == call_retval) && (tail == atomic_load_explicit(&client->_shm->_resp_head, memory_order_acquire)))
+        {
+            call_retval = __backoff_gpio_broker(client, &spins);
+        }
+        if (0 == call_retval)
+        {
+            resp = client->_shm->_resps[tail & BROKER_RING_MASK];
+            atomic_store_explicit(&client->_shm->_resp_tail, tail + 1, memory_order_release);
+            // Responses come in command order, another sequence number is a broken protocol
+            call_retval = (resp.seq == cmd->seq) ? resp.status : EBROKER;
+            if ((0 == call_retval) && (NULL != value))
+            {
+                *value = resp.value;
+            }
+        }
+    }
+    return call_retval;
+}
+// Wait one step
+static int32_t __backoff_gpio_broker(gpio_broker_client_t* client,
+                                     uint32_t* spins)
+{
+    /// LOCALS ///
+    // The backoff return value
+    int32_t backoff_retval = 0;
+    // Check of the socket, the broker never writes to it after the handshake
+    struct pollfd pfd      = { .fd = client->_sock, .events = POLLIN };
+
+    if (broker_spins > ++*spins)
+    {
+        __relax_gpio_broker();
+    }
+    else
+    {
+        sched_yield();
+        if ((0 == ((*spins - broker_spins) % BROKER_HUP_YIELDS)) && (0 < poll(&pfd, 1, 0)))
+        {
+            backoff_retval = EBROKER;
+        }
+    }
+    return backoff_retval;
+}
+// Spin-wait hint
+static inline void __relax_gpio_broker(void)
+{
+#if defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
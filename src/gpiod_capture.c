@@ -0,0 +1,356 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <gpiod.h>
+#include <gpiod_capture.h>
+#include <gpiod_internals.h>
+#include <gpiod_time.h>
+
+/// GLOBALS ///
+// Longest delta a record holds, an unchanged level is re-recorded before it overflows
+static const uint64_t DELTA_MAX_NS     = UINT32_MAX;
+// Samples between publishing the sample count to the header
+static const uint32_t PUBLISH_INTERVAL = 65536;
+// First printable VCD identifier character
+static const char VCD_ID_BASE          = '!';
+
+/// FUNCTION DECLARATIONS ///
+/* Store one record in the next slot, moving the time base once the ring wraps */
+static inline void __store_gpio_capture_record(gpio_capture_t *, uint64_t *, uint64_t *, uint64_t, uint64_t);
+
+/// FUNCTION DEFINITIONS ///
+/* "Public" Functions */
+// Open a capture file
+int32_t open_gpio_capture(gpio_capture_t* capture,
+                          const char* path,
+                          uint64_t capacity,
+                          uint64_t pin_mask,
+                          uint64_t max_gap_ns)
+{
+    /// LOCALS ///
+    // The open return value
+    int32_t open_retval = 0;
+    // File descriptor of the capture file
+    int32_t fd          = -1;
+    // Size of the file
+    uint64_t map_size   = sizeof(gpio_capture_header_t) + (capacity * sizeof(gpio_capture_record_t));
+    // The mapping
+    void* map_addr      = MAP_FAILED;
+
+    capture->_header = NULL;
+    if (0 == capacity)
+    {
+        open_retval = EOUT_OF_RANGE;
+    }
+    else if (-1 == (fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644)))
+    {
+        open_retval = EFILE_IO;
+    }
+    // Allocate the blocks now, a sparse file would fault and allocate on the hot path
+    else if (0 != posix_fallocate(fd, 0, (off_t) map_size))
+    {
+        open_retval = EFILE_IO;
+    }
+    // Pre-fault the whole ring
+    else if (MAP_FAILED == (map_addr = mmap(0, map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0)))
+    {
+        open_retval = EMAP_FAIL;
+    }
+    else
+    {
+        capture->_header   = (gpio_capture_header_t *) map_addr;
+        capture->_records  = (gpio_capture_record_t *) (capture->_header + 1);
+        capture->_map_size = map_size;
+        atomic_init(&capture->_running, false);
+        memset(capture->_header, 0, sizeof(gpio_capture_header_t));
+        capture->_header->magic      = GPIO_CAPTURE_MAGIC;
+        capture->_header->version    = GPIO_CAPTURE_VERSION;
+        capture->_header->capacity   = capacity;
+        capture->_header->pin_mask   = pin_mask;
+        capture->_header->max_gap_ns = max_gap_ns;
+    }
+    // The mapping outlives the descriptor
+    if (-1 != fd)
+    {
+        close(fd);
+    }
+    return open_retval;
+}
+// Run the capture loop
+int32_t run_gpio_capture(gpio_capture_t* capture,
+                         uint64_t duration_ns)
+{
+    /// LOCALS ///
+    // The run return value
+    int32_t run_retval              = 0;
+    // Header of the capture
+    gpio_capture_header_t* header   = capture->_header;
+    // Next slot, and the slot count
+    uint64_t slot                   = 0;
+    // Records written
+    uint64_t head                   = 0;
+    // Samples taken and drops seen
+    uint64_t samples                = 0;
+    uint64_t drops                  = 0;
+    // Levels of the sample and of the last record
+    uint64_t levels                 = 0x00;
+    uint64_t last_levels            = 0x00;
+    // Time of the sample, of the previous sample and of the last record
+    uint64_t now_ns                 = 0;
+    uint64_t prev_ns                = 0;
+    uint64_t last_ns                = 0;
+    // Start and end of the capture
+    uint64_t start_ns               = 0;
+    uint64_t end_ns                 = 0;
+    // Samples until the next header publish
+    uint32_t publish                = PUBLISH_INTERVAL;
+
+    if ((NULL == header) || (NULL == gpio_chip._base))
+    {
+        run_retval = (NULL == header) ? EPDAT_NULL : __gpio_regs_retval();
+    }
+    else
+    {
+        head    = header->head;
+        samples = header->samples;
+        drops   = header->drops;
+        slot    = head % header->capacity;
+        atomic_store(&capture->_running, true);
+        start_ns = gpio_time_ns();
+        end_ns   = (0 != duration_ns) ? (start_ns + duration_ns) : UINT64_MAX;
+        prev_ns  = start_ns;
+        // A resumed capture counts its first delta from its last record, across the idle time
+        last_ns  = (0 != head) ? header->last_ns : start_ns;
+        if (0 == head)
+        {
+            header->base_ns = start_ns;
+        }
+        // Force a first record holding the initial levels
+        __read_gpio_levels(&last_levels);
+        last_levels = ~last_levels;
+        while (atomic_load_explicit(&capture->_running, memory_order_relaxed) && (prev_ns < end_ns))
+        {
+            __read_gpio_levels(&levels);
+            now_ns = gpio_time_ns();
+            samples++;
+            drops += ((now_ns - prev_ns) > header->max_gap_ns) ? 1 : 0;
+            prev_ns = now_ns;
+            // Only changes are recorded, and an unchanged level before its delta overflows
+            if ((0 != ((levels ^ last_levels) & header->pin_mask)) || ((now_ns - last_ns) >= DELTA_MAX_NS))
+            {
+                // A gap too long for one delta is bridged by keep-alive records of the levels held
+                while ((0 != head) && ((now_ns - last_ns) > DELTA_MAX_NS))
+                {
+                    __store_gpio_capture_record(capture, &slot, &head,
+                                                capture->_records[((0 == slot) ? header->capacity : slot) - 1].levels,
+                                                DELTA_MAX_NS);
+                    last_ns += DELTA_MAX_NS;
+                }
+                __store_gpio_capture_record(capture, &slot, &head, levels, (0 == head) ? 0 : (now_ns - last_ns));
+                if (1 == head)
+                {
+                    header->base_ns = now_ns;
+                }
+                header->last_ns = now_ns;
+                last_levels     = levels;
+                last_ns         = now_ns;
+            }
+            if (0 == --publish)
+            {
+                publish         = PUBLISH_INTERVAL;
+                header->samples = samples;
+                header->drops   = drops;
+            }
+        }
+        header->samples     = samples;
+        header->drops       = drops;
+        header->elapsed_ns += prev_ns - start_ns;
+        atomic_store(&capture->_running, false);
+    }
+    return run_retval;
+}
+// Stop the capture loop
+int32_t stop_gpio_capture(gpio_capture_t* capture)
+{
+    atomic_store(&capture->_running, false);
+    return 0;
+}
+// Capture statistics
+int32_t get_gpio_capture_stats(gpio_capture_t* capture,
+                               gpio_capture_stats_t* stats)
+{
+    /// LOCALS ///
+    // The stats return value
+    int32_t stats_retval = 0;
+
+    if (NULL == capture->_header)
+    {
+        stats_retval = EPDAT_NULL;
+    }
+    else
+    {
+        stats->samples         = capture->_header->samples;
+        stats->records         = capture->_header->head;
+        stats->drops           = capture->_header->drops;
+        stats->samples_per_sec = (0 != capture->_header->elapsed_ns) ?
+                                     ((double) stats->samples * 1e9 / (double) capture->_header->elapsed_ns) : 0.0;
+        stats->drop_rate       = (0 != stats->samples) ? ((double) stats->drops / (double) stats->samples) : 0.0;
+    }
+    return stats_retval;
+}
+// Close a capture
+int32_t close_gpio_capture(gpio_capture_t* capture)
+{
+    /// LOCALS ///
+    // The close return value
+    int32_t close_retval = 0;
+
+    if (NULL == capture->_header)
+    {
+        close_retval = EPDAT_NULL;
+    }
+    else
+    {
+        msync(capture->_header, capture->_map_size, MS_SYNC);
+        munmap(capture->_header, capture->_map_size);
+        capture->_header  = NULL;
+        capture->_records = NULL;
+    }
+    return close_retval;
+}
+// Export a capture as VCD
+int32_t export_gpio_capture_vcd(const char* capture_path,
+                                const char* vcd_path)
+{
+    /// LOCALS ///
+    // The export return value
+    int32_t export_retval                = 0;
+    // File descriptor of the capture file
+    int32_t fd                           = -1;
+    // Status of the capture file
+    struct stat fd_stat;
+    // The mapped capture
+    void* map_addr                       = MAP_FAILED;
+    // Header and records of the capture
+    const gpio_capture_header_t* header  = NULL;
+    const gpio_capture_record_t* records = NULL;
+    // Record being exported
+    const gpio_capture_record_t* record  = NULL;
+    // The VCD file
+    FILE* vcd                            = NULL;
+    // Oldest record held, and the number held
+    uint64_t first                       = 0;
+    uint64_t held                        = 0;
+    // Record index
+    uint64_t rec_ind                     = 0;
+    // Time of the record, and of the first one
+    uint64_t rec_ns                      = 0;
+    uint64_t first_ns                    = 0;
+    // Levels of the previous record
+    uint64_t prev_levels                 = 0x00;
+    // Pins changed by the record
+    uint64_t changed                     = 0x00;
+    // Pin index
+    uint8_t pin                          = 0;
+
+    if ((-1 == (fd = open(capture_path, O_RDONLY))) || (-1 == fstat(fd, &fd_stat)) ||
+        (fd_stat.st_size < (off_t) sizeof(gpio_capture_header_t)))
+    {
+        export_retval = EFILE_IO;
+    }
+    else if (MAP_FAILED == (map_addr = mmap(0, fd_stat.st_size, PROT_READ, MAP_SHARED, fd, 0)))
+    {
+        export_retval = EMAP_FAIL;
+    }
+    else if ((GPIO_CAPTURE_MAGIC != ((const gpio_capture_header_t *) map_addr)->magic) ||
+             (GPIO_CAPTURE_VERSION != ((const gpio_capture_header_t *) map_addr)->version) ||
+             (fd_stat.st_size < (off_t) (sizeof(gpio_capture_header_t) +
+                                         (((const gpio_capture_header_t *) map_addr)->capacity * sizeof(gpio_capture_record_t)))))
+    {
+        export_retval = EFILE_IO;
+    }
+    else if (NULL == (vcd = fopen(vcd_path, "w")))
+    {
+        export_retval = EFILE_IO;
+    }
+    else
+    {
+        header  = (const gpio_capture_header_t *) map_addr;
+        records = (const gpio_capture_record_t *) (header + 1);
+        held    = (header->head < header->capacity) ? header->head : header->capacity;
+        first   = header->head - held;
+        fprintf(vcd, "$timescale 1ns $end\n$scope module gpio $end\n");
+        for (pin = 0; pin <= GPIO_PIN_MAX; pin++)
+        {
+            if (0 != (header->pin_mask & GPIO_PIN_BIT(pin)))
+            {
+                fprintf(vcd, "$var wire 1 %c gpio%u $end\n", VCD_ID_BASE + pin, pin);
+            }
+        }
+        fprintf(vcd, "$upscope $end\n$enddefinitions $end\n");
+        // Walk the ring oldest first, times relative to the oldest record held
+        rec_ns = header->base_ns;
+        for (rec_ind = first; rec_ind < header->head; rec_ind++)
+        {
+            record   = &records[rec_ind % header->capacity];
+            rec_ns += (rec_ind == first) ? 0 : record->delta_ns;
+            first_ns = (rec_ind == first) ? rec_ns : first_ns;
+            changed  = (rec_ind == first) ? header->pin_mask : ((record->levels ^ prev_levels) & header->pin_mask);
+            if (0 != changed)
+            {
+                fprintf(vcd, "#%llu\n", (unsigned long long) (rec_ns - first_ns));
+                for (pin = 0; pin <= GPIO_PIN_MAX; pin++)
+                {
+                    if (0 != (changed & GPIO_PIN_BIT(pin)))
+                    {
+                        fprintf(vcd, "%u%c\n", GPIO_PIN_LEVEL(record->levels, pin), VCD_ID_BASE + pin);
+                    }
+                }
+            }
+            prev_levels = record->levels;
+        }
+        if (0 != fclose(vcd))
+        {
+            export_retval = EFILE_IO;
+        }
+    }
+    if (MAP_FAILED != map_addr)
+    {
+        munmap(map_addr, fd_stat.st_size);
+    }
+    if (-1 != fd)
+    {
+        close(fd);
+    }
+    return export_retval;
+}
+
+/* "Private" Functions */
+// Store a record
+static inline void __store_gpio_capture_record(gpio_capture_t* capture,
+                                               uint64_t* slot,
+                                               uint64_t* head,
+                                               uint64_t levels,
+                                               uint64_t delta_ns)
+{
+    /// LOCALS ///
+    // Header of the capture
+    gpio_capture_header_t* header = capture->_header;
+    // Record slot written
+    gpio_capture_record_t* record = &capture->_records[*slot];
+
+    record->levels   = levels;
+    record->delta_ns = (uint32_t) delta_ns;
+    *slot = (*slot + 1 == header->capacity) ? 0 : (*slot + 1);
+    // Overwriting the oldest record makes the next one the oldest, the time base moves on
+    // by that record's delta (from the overwritten one to it)
+    if (*head >= header->capacity)
+    {
+        header->base_ns += capture->_records[*slot].delta_ns;
+    }
+    header->head = ++(*head);
+}
@@ -0,0 +1,531 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+#include <gpiod.h>
+#include <gpiod_event.h>
+#include <gpiod_internals.h>
+
+/*******************************************************************************/
+//
+// DESCRIPTION : BACKEND_CHARDEV, lines requested from the kernel through the
+//               GPIO character device (uAPI v2).
+//
+// DETAILS     : A line takes a request of its own "as-is", so neither its direction
+//               nor its output level change on request, and keeps the kernel flags it
+//               was configured with in its pool slot. A bulk group moves its lines
+//               into one multi-line request, with the lines in ascending pin order, so
+//               a group write is a single GPIO_V2_LINE_SET_VALUES ioctl. The group is
+//               requested with its lines' flags, which must all be the same. When a
+//               group fails or is released its lines get requests of their own back
+//               with the flags and levels they had, the kernel resets the bias of a
+//               line it frees. A line the kernel refuses is left without a request,
+//               and every call on it returns EKERNEL until it is released. Every
+//               request is non-blocking, a poll pass reads what the kernel has
+//               buffered for each edge armed line and returns. tools/gpiod_cdev_check.sh
+//               runs the backend against a gpio-sim chip.
+//
+/*******************************************************************************/
+
+/// GLOBALS ///
+// Consumer label of every request
+static const char CDEV_CONSUMER[]        = "gpiod-lib";
+// Kernel flags kept for a line, its direction and bias
+static const uint64_t CDEV_DIR_FLAGS     = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_OUTPUT;
+static const uint64_t CDEV_BIAS_FLAGS    = GPIO_V2_LINE_FLAG_BIAS_PULL_UP | GPIO_V2_LINE_FLAG_BIAS_PULL_DOWN |
+                                           GPIO_V2_LINE_FLAG_BIAS_DISABLED;
+// Kernel flags of an edge armed line
+static const uint64_t CDEV_EDGE_FLAGS    = GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING |
+                                           GPIO_V2_LINE_FLAG_EVENT_CLOCK_HTE;
+// Bias flag of each enum PullSelect
+static const uint64_t CDEV_PULL_FLAGS[]  = {
+    GPIO_V2_LINE_FLAG_BIAS_DISABLED,
+    GPIO_V2_LINE_FLAG_BIAS_PULL_UP,
+    GPIO_V2_LINE_FLAG_BIAS_PULL_DOWN
+};
+// Events read from a line request per read()
+#define CDEV_EVENT_BATCH 16
+
+/// FUNCTION DECLARATIONS ///
+/* Request lines from the chip, output values are indexed like the offsets. Returns the request's descriptor or an error */
+static int32_t __cdev_request(const uint32_t *, uint32_t, uint64_t, uint64_t);
+/* Give a line of a group a request of its own again, with the flags and level it had in the group */
+static int32_t __cdev_rerequest_line(_gpio_internals_t *, uint64_t, uint8_t);
+/* Reconfigure the line's own request, keeping the level of an output */
+static int32_t __cdev_set_config(_gpio_internals_t *, uint64_t);
+/* Bit of the line in its request */
+static uint64_t __cdev_line_bit(_gpio_internals_t *);
+
+/// FUNCTION DEFINITIONS ///
+/* "Private" Functions */
+// Open and check a GPIO character device
+int32_t __cdev_open_chip(const char* path)
+{
+    /// LOCALS ///
+    // The open return value, the descriptor on success
+    int32_t open_retval = 0;
+    // Chip information, only checked for
+    struct gpiochip_info info;
+
+    if (-1 == (open_retval = open(path, O_RDWR | O_CLOEXEC)))
+    {
+        open_retval = EDEVMEM_OPEN;
+    }
+    // Anything else opened here is not a GPIO chip
+    else if (-1 == ioctl(open_retval, GPIO_GET_CHIPINFO_IOCTL, &info))
+    {
+        close(open_retval);
+        open_retval = EKERNEL;
+    }
+    return open_retval;
+}
+// Take the line's own kernel request
+int32_t __cdev_request_line(_gpio_internals_t* __this_gpio_pdat)
+{
+    /// LOCALS ///
+    // The request return value
+    int32_t req_retval = 0;
+    // Line offset, the chip's lines are numbered like the pins
+    uint32_t offset    = __this_gpio_pdat->_pin_value;
+    // Current state of the line
+    struct gpio_v2_line_info info;
+
+    memset(&info, 0, sizeof(info));
+    info.offset = offset;
+    // The chip may have fewer lines than there are pins
+    if (-1 == ioctl(gpio_chip._fd, GPIO_V2_GET_LINEINFO_IOCTL, &info))
+    {
+        req_retval = EBAD_PIN;
+    }
+    // No direction flag requests the line as it is
+    else if (0 <= (req_retval = __cdev_request(&offset, 1, 0x00, 0x00)))
+    {
+        __this_gpio_pdat->_fd         = req_retval;
+        __this_gpio_pdat->_cdev_index = GPIO_CDEV_SOLO;
+        __this_gpio_pdat->_cdev_flags = (uint16_t) (info.flags & (CDEV_DIR_FLAGS | CDEV_BIAS_FLAGS));
+        req_retval                    = 0;
+    }
+    return req_retval;
+}
+// Drop the line's own kernel request
+void __cdev_release_line(_gpio_internals_t* __this_gpio_pdat)
+{
+    // A group's request is the group's to drop
+    if (GPIO_CDEV_SOLO == __this_gpio_pdat->_cdev_index)
+    {
+        close(__this_gpio_pdat->_fd);
+    }
+    __this_gpio_pdat->_fd         = -1;
+    __this_gpio_pdat->_cdev_index = GPIO_CDEV_SOLO;
+    __this_gpio_pdat->_cdev_flags = 0;
+}
+// Drive the line
+int32_t __cdev_write_gpio(_gpio_internals_t* __this_gpio_pdat,
+                          uint8_t high_low)
+{
+    /// LOCALS ///
+    // The line's bit in its request
+    uint64_t line_bit = __cdev_line_bit(__this_gpio_pdat);
+    // Value of the line
+    struct gpio_v2_line_values values = {.bits = (0 != high_low) ? line_bit : 0x00, .mask = line_bit};
+
+    return (-1 == __this_gpio_pdat->_fd) ? EKERNEL :
+           (0 == ioctl(__this_gpio_pdat->_fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &values)) ? 0 :
+           (EPERM == errno) ? EPIN_CONFIG : EKERNEL;
+}
+// Read the line level
+int32_t __cdev_read_gpio(_gpio_internals_t* __this_gpio_pdat)
+{
+    /// LOCALS ///
+    // The line's bit in its request
+    uint64_t line_bit = __cdev_line_bit(__this_gpio_pdat);
+    // Value of the line
+    struct gpio_v2_line_values values = {.bits = 0x00, .mask = line_bit};
+
+    return (-1 == __this_gpio_pdat->_fd) ? EKERNEL :
+           (0 == ioctl(__this_gpio_pdat->_fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values)) ?
+           (int32_t) (0 != (values.bits & line_bit)) : EKERNEL;
+}
+// Function of the line
+enum FunctionSelect __cdev_get_gpio_fn(_gpio_internals_t* __this_gpio_pdat)
+{
+    return (0 != (__this_gpio_pdat->_cdev_flags & GPIO_V2_LINE_FLAG_OUTPUT)) ? OUTPUT : INPUT;
+}
+// Select INPUT or OUTPUT
+int32_t __cdev_set_gpio_fn(_gpio_internals_t* __this_gpio_pdat,
+                           enum FunctionSelect sel)
+{
+    /// LOCALS ///
+    // The set return value
+    int32_t set_retval = 0;
+
+    // The kernel only switches direction, the alternate functions belong to pinctrl
+    if ((INPUT != sel) && (OUTPUT != sel))
+    {
+        set_retval = EBACKEND;
+    }
+    // An output keeps no edge detection
+    else
+    {
+        set_retval = __cdev_set_config(__this_gpio_pdat, (__this_gpio_pdat->_cdev_flags & CDEV_BIAS_FLAGS) |
+                                       ((INPUT == sel) ? (GPIO_V2_LINE_FLAG_INPUT | (__this_gpio_pdat->_cdev_flags & CDEV_EDGE_FLAGS)) :
+                                                         GPIO_V2_LINE_FLAG_OUTPUT));
+    }
+    return set_retval;
+}
+// Select the bias
+int32_t __cdev_set_gpio_pull(_gpio_internals_t* __this_gpio_pdat,
+                             enum PullSelect pull)
+{
+    return __cdev_set_config(__this_gpio_pdat, (__this_gpio_pdat->_cdev_flags & ~CDEV_BIAS_FLAGS) | CDEV_PULL_FLAGS[pull]);
+}
+// Select the edges reported by the line
+int32_t __cdev_set_gpio_event(_gpio_internals_t* __this_gpio_pdat,
+                              uint8_t detect)
+{
+    /// LOCALS ///
+    // The set return value
+    int32_t set_retval = 0;
+    // Kernel edge flags of the detectors, the asynchronous ones are the same edges to the kernel
+    uint64_t edges     = ((0 != (detect & (EVENT_RISING | EVENT_ASYNC_RISING))) ? GPIO_V2_LINE_FLAG_EDGE_RISING : 0x00) |
+                         ((0 != (detect & (EVENT_FALLING | EVENT_ASYNC_FALLING))) ? GPIO_V2_LINE_FLAG_EDGE_FALLING : 0x00);
+    // Flags of the line without its edges
+    uint64_t flags     = __this_gpio_pdat->_cdev_flags & ~CDEV_EDGE_FLAGS;
+
+    // There is no level detection in the uAPI
+    if (0 != (detect & (EVENT_HIGH | EVENT_LOW)))
+    {
+        set_retval = EBACKEND;
+    }
+    // Edges are only detected on inputs
+    else if ((0x00 != edges) && (0 == (flags & GPIO_V2_LINE_FLAG_INPUT)))
+    {
+        set_retval = EPIN_CONFIG;
+    }
+    // Hardware timestamps where the chip has a timestamp engine, the kernel's monotonic clock otherwise
+    else if ((0x00 == edges) ||
+             (0 != (set_retval = __cdev_set_config(__this_gpio_pdat, flags | edges | GPIO_V2_LINE_FLAG_EVENT_CLOCK_HTE))))
+    {
+        set_retval = __cdev_set_config(__this_gpio_pdat, flags | edges);
+    }
+    return set_retval;
+}
+// Deliver buffered edge events
+int32_t __cdev_poll_gpio_events(gpio_event_t* events,
+                                uint32_t max_events)
+{
+    /// LOCALS ///
+    // The poll return value, the number of events on success
+    int32_t poll_retval = 0;
+    // Events read from one line
+    struct gpio_v2_line_event batch[CDEV_EVENT_BATCH];
+    // Bytes read
+    ssize_t num_read    = 0;
+    // Number of events delivered
+    uint32_t num_events = 0;
+    // Events read in one read() and their index
+    uint32_t batch_len  = 0;
+    uint32_t batch_ind  = 0;
+    // Pool slot index
+    uint8_t slot_ind    = 0;
+    // The slot
+    _gpio_internals_t* slot = NULL;
+
+    // Lowest slots first, what does not fit stays buffered in the kernel for the next pass
+    for (slot_ind = 0; (0 <= poll_retval) && (slot_ind < GPIO_LINE_POOL_SIZE) && (num_events < max_events); slot_ind++)
+    {
+        slot = &gpio_line_pool[slot_ind];
+        if (!atomic_load(&slot->_in_use) || (-1 == slot->_fd) || (0 == (slot->_cdev_flags & CDEV_EDGE_FLAGS)))
+        {
+            continue;
+        }
+        // Drain the line, a short read means its queue is empty
+        do
+        {
+            batch_len = max_events - num_events;
+            batch_len = (batch_len > CDEV_EVENT_BATCH) ? CDEV_EVENT_BATCH : batch_len;
+            num_read  = read(slot->_fd, batch, batch_len * sizeof(batch[0]));
+            if (0 > num_read)
+            {
+                poll_retval = (EAGAIN == errno) ? 0 : EKERNEL;
+                num_read    = 0;
+            }
+            for (batch_ind = 0; batch_ind < (uint32_t) num_read / sizeof(batch[0]); batch_ind++)
+            {
+                events[num_events].timestamp_ns = batch[batch_ind].timestamp_ns;
+                events[num_events].pin          = (uint8_t) batch[batch_ind].offset;
+                events[num_events].level        = (GPIO_V2_LINE_EVENT_RISING_EDGE == batch[batch_ind].id) ? 1 : 0;
+                num_events++;
+            }
+        } while ((0 < num_read) && ((size_t) num_read == batch_len * sizeof(batch[0])) && (num_events < max_events));
+    }
+    return (0 <= poll_retval) ? (int32_t) num_events : poll_retval;
+}
+// Move the group's lines into one multi-line request
+int32_t __cdev_request_gpio_bulk(gpio_bulk_t* bulk,
+                                 gpio_line_t* lines,
+                                 uint8_t num_lines)
+{
+    /// LOCALS ///
+    // The request return value
+    int32_t req_retval = 0;
+    // Line offsets of the request, ascending
+    uint32_t offsets[GPIO_V2_LINES_MAX];
+    // Levels of the lines, indexed like the offsets
+    uint64_t values    = 0x00;
+    // Pins left to place
+    uint64_t pins      = bulk->pin_mask;
+    // Number of lines in the request
+    uint32_t num_offsets = 0;
+    // Line index
+    uint8_t line_ind   = 0;
+    // Level of a line
+    int32_t level      = 0;
+    // Flags of the group's request, those of its lines
+    uint64_t flags     = (0 != num_lines) ? lines[0].priv_dat->_cdev_flags : GPIO_V2_LINE_FLAG_OUTPUT;
+
+    // The lines keep their levels, and a line already in a group cannot join another
+    for (line_ind = 0; (0 == req_retval) && (line_ind < num_lines); line_ind++)
+    {
+        if ((-1 == lines[line_ind].priv_dat->_fd) || (GPIO_CDEV_SOLO != lines[line_ind].priv_dat->_cdev_index))
+        {
+            req_retval = EPIN_CONFIG;
+        }
+        // One request has one set of flags, a line with another bias would silently lose it
+        else if (flags != lines[line_ind].priv_dat->_cdev_flags)
+        {
+            req_retval = EPIN_CONFIG;
+        }
+        else if (0 > (level = __cdev_read_gpio(lines[line_ind].priv_dat)))
+        {
+            req_retval = level;
+        }
+        else if (0 != level)
+        {
+            values |= ((uint64_t) 1) << __builtin_popcountll(bulk->pin_mask & (GPIO_PIN_BIT(lines[line_ind].priv_dat->_pin_value) - 1));
+        }
+    }
+    if (0 == req_retval)
+    {
+        while (0 != pins)
+        {
+            offsets[num_offsets++] = (uint32_t) __builtin_ctzll(pins);
+            pins &= pins - 1;
+        }
+        // The kernel will not hand out a line twice, the lines' own requests go first
+        for (line_ind = 0; line_ind < num_lines; line_ind++)
+        {
+            if (GPIO_CDEV_SOLO == lines[line_ind].priv_dat->_cdev_index)
+            {
+                close(lines[line_ind].priv_dat->_fd);
+                lines[line_ind].priv_dat->_cdev_index = 0;
+            }
+        }
+        req_retval = __cdev_request(offsets, num_offsets, flags, values);
+        for (line_ind = 0; line_ind < num_lines; line_ind++)
+        {
+            lines[line_ind].priv_dat->_fd         = (0 <= req_retval) ? req_retval : -1;
+            lines[line_ind].priv_dat->_cdev_index = (0 <= req_retval) ?
+                (uint8_t) __builtin_popcountll(bulk->pin_mask & (GPIO_PIN_BIT(lines[line_ind].priv_dat->_pin_value) - 1)) :
+                GPIO_CDEV_SOLO;
+        }
+        // Failed, the lines go back to requests of their own with the flags and levels read above.
+        // A line the kernel refuses is left without one and fails every call.
+        if (0 > req_retval)
+        {
+            for (line_ind = 0; line_ind < num_lines; line_ind++)
+            {
+                __cdev_rerequest_line(lines[line_ind].priv_dat, flags, (uint8_t) ((values >> __builtin_popcountll(
+                    bulk->pin_mask & (GPIO_PIN_BIT(lines[line_ind].priv_dat->_pin_value) - 1))) & 0x01));
+            }
+        }
+        else
+        {
+            bulk->_fd  = req_retval;
+            req_retval = 0;
+        }
+    }
+    return req_retval;
+}
+// Write the group's pins selected by mask
+int32_t __cdev_write_gpio_bulk(gpio_bulk_t* bulk,
+                               uint64_t value,
+                               uint64_t mask)
+{
+    /// LOCALS ///
+    // Values and mask by line index of the request
+    struct gpio_v2_line_values values = {.bits = 0x00, .mask = 0x00};
+    // Line index of a pin
+    uint64_t line_bit = 0x00;
+
+    // Pin bits to line bits, a line's index is the number of group pins below it
+    while (0 != mask)
+    {
+        line_bit     = ((uint64_t) 1) << __builtin_popcountll(bulk->pin_mask & ((mask & -mask) - 1));
+        values.mask |= line_bit;
+        values.bits |= (0 != (value & mask & -mask)) ? line_bit : 0x00;
+        mask        &= mask - 1;
+    }
+    return (0 == ioctl(bulk->_fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &values)) ? 0 : EKERNEL;
+}
+// Give the group's lines their own requests back
+int32_t __cdev_release_gpio_bulk(gpio_bulk_t* bulk)
+{
+    /// LOCALS ///
+    // The release return value, the first line refused its request
+    int32_t rel_retval  = 0;
+    // The request return value of a line
+    int32_t line_retval = 0;
+    // Pool slots of the group's lines
+    uint64_t members    = 0x00;
+    // Levels of the group's lines, by line index of the request
+    struct gpio_v2_line_values values = {.bits = 0x00, .mask = 0x00};
+    // Pool slot index
+    uint8_t slot_ind    = 0;
+
+    // Members are found before the descriptor is closed, the new requests may reuse its number
+    for (slot_ind = 0; slot_ind < GPIO_LINE_POOL_SIZE; slot_ind++)
+    {
+        if (atomic_load(&gpio_line_pool[slot_ind]._in_use) && (bulk->_fd == gpio_line_pool[slot_ind]._fd))
+        {
+            members     |= ((uint64_t) 1) << slot_ind;
+            values.mask |= ((uint64_t) 1) << gpio_line_pool[slot_ind]._cdev_index;
+        }
+    }
+    // Levels are read while the group still holds the lines, the kernel resets a line it frees
+    if (-1 == ioctl(bulk->_fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values))
+    {
+        values.bits = 0x00;
+        rel_retval  = EKERNEL;
+    }
+    close(bulk->_fd);
+    // Each line gets the flags it kept in its slot (bias included) and its level back
+    while (0 != members)
+    {
+        slot_ind    = (uint8_t) __builtin_ctzll(members);
+        line_retval = __cdev_rerequest_line(&gpio_line_pool[slot_ind], gpio_line_pool[slot_ind]._cdev_flags,
+                                            (uint8_t) ((values.bits >> gpio_line_pool[slot_ind]._cdev_index) & 0x01));
+        rel_retval  = (0 != rel_retval) ? rel_retval : line_retval;
+        members    &= members - 1;
+    }
+    return rel_retval;
+}
+// Request lines from the chip
+static int32_t __cdev_request(const uint32_t* offsets,
+                              uint32_t num_offsets,
+                              uint64_t flags,
+                              uint64_t out_values)
+{
+    /// LOCALS ///
+    // The request return value, the descriptor on success
+    int32_t req_retval = 0;
+    // The request
+    struct gpio_v2_line_request req;
+
+    memset(&req, 0, sizeof(req));
+    memcpy(req.offsets, offsets, num_offsets * sizeof(offsets[0]));
+    strncpy(req.consumer, CDEV_CONSUMER, sizeof(req.consumer) - 1);
+    req.num_lines    = num_offsets;
+    req.config.flags = flags;
+    // Outputs are driven to their levels by the request itself, there is no glitch to a default
+    if (0 != (flags & GPIO_V2_LINE_FLAG_OUTPUT))
+    {
+        req.config.num_attrs              = 1;
+        req.config.attrs[0].attr.id       = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+        req.config.attrs[0].attr.values   = out_values;
+        req.config.attrs[0].mask          = (GPIO_V2_LINES_MAX == num_offsets) ? ~0ULL : ((1ULL << num_offsets) - 1);
+    }
+    if (-1 == ioctl(gpio_chip._fd, GPIO_V2_GET_LINE_IOCTL, &req))
+    {
+        req_retval = EKERNEL;
+    }
+    // A poll pass never waits on an empty event queue
+    else if (-1 == fcntl(req.fd, F_SETFL, O_NONBLOCK))
+    {
+        close(req.fd);
+        req_retval = EKERNEL;
+    }
+    else
+    {
+        req_retval = req.fd;
+    }
+    return req_retval;
+}
+// Request a line of a group again
+static int32_t __cdev_rerequest_line(_gpio_internals_t* __this_gpio_pdat,
+                                     uint64_t flags,
+                                     uint8_t level)
+{
+    /// LOCALS ///
+    // The request return value
+    int32_t req_retval = 0;
+    // Line offset
+    uint32_t offset    = __this_gpio_pdat->_pin_value;
+
+    // Not "as-is", the freed line has lost its bias and an output its level
+    req_retval = __cdev_request(&offset, 1, flags, level);
+    __this_gpio_pdat->_fd         = (0 <= req_retval) ? req_retval : -1;
+    __this_gpio_pdat->_cdev_index = GPIO_CDEV_SOLO;
+    __this_gpio_pdat->_cdev_flags = (uint16_t) flags;
+    return (0 <= req_retval) ? 0 : req_retval;
+}
+// Reconfigure the line's own request
+static int32_t __cdev_set_config(_gpio_internals_t* __this_gpio_pdat,
+                                 uint64_t flags)
+{
+    /// LOCALS ///
+    // The set return value
+    int32_t set_retval = 0;
+    // Level an output keeps
+    int32_t level      = 0;
+    // The line's configuration
+    struct gpio_v2_line_config config;
+
+    memset(&config, 0, sizeof(config));
+    config.flags = flags;
+    // A line in a group is reconfigured with the group
+    if (GPIO_CDEV_SOLO != __this_gpio_pdat->_cdev_index)
+    {
+        set_retval = EPIN_CONFIG;
+    }
+    // The line lost its request
+    else if (-1 == __this_gpio_pdat->_fd)
+    {
+        set_retval = EKERNEL;
+    }
+    // An output stays at its level, a new one starts low
+    else if ((0 != (flags & GPIO_V2_LINE_FLAG_OUTPUT)) &&
+             (0 != (__this_gpio_pdat->_cdev_flags & GPIO_V2_LINE_FLAG_OUTPUT)) &&
+             (0 > (level = __cdev_read_gpio(__this_gpio_pdat))))
+    {
+        set_retval = level;
+    }
+    else
+    {
+        if (0 != (flags & GPIO_V2_LINE_FLAG_OUTPUT))
+        {
+            config.num_attrs            = 1;
+            config.attrs[0].attr.id     = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+            config.attrs[0].attr.values = (uint64_t) level;
+            config.attrs[0].mask        = 0x01;
+        }
+        if (-1 == ioctl(__this_gpio_pdat->_fd, GPIO_V2_LINE_SET_CONFIG_IOCTL, &config))
+        {
+            set_retval = EKERNEL;
+        }
+        else
+        {
+            __this_gpio_pdat->_cdev_flags = (uint16_t) flags;
+        }
+    }
+    return set_retval;
+}
+// Bit of the line in its request
+static uint64_t __cdev_line_bit(_gpio_internals_t* __this_gpio_pdat)
+{
+    return ((uint64_t) 1) << ((GPIO_CDEV_SOLO == __this_gpio_pdat->_cdev_index) ? 0 : __this_gpio_pdat->_cdev_index);
+}
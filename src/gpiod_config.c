@@ -0,0 +1,190 @@
+#include <stddef.h>
+#include <string.h>
+#include <gpiod.h>
+#include <gpiod_config.h>
+#include <gpiod_event.h>
+#include <gpiod_internals.h>
+#include <gpiod_regs.h>
+#include <gpio_addressing.h>
+
+/// GLOBALS ///
+// Transaction index of the first pull-up/pull-down register, function selects come first
+static const uint8_t CONFIG_PUP_PDN_IND = 6;
+// Transaction index of the first detect enable register, two banks per detector
+static const uint8_t CONFIG_EVENT_IND   = 10;
+// Two bit mask
+static const uint32_t TWO_BIT_MASK      = 0x03;
+// Three bit mask
+static const uint32_t THREE_BIT_MASK    = 0x07;
+// Register offsets, in commit order
+static const uint32_t CONFIG_REGS[GPIO_CONFIG_REGS] = {
+    GPFN_SEL0_OFF, GPFN_SEL1_OFF, GPFN_SEL2_OFF, GPFN_SEL3_OFF, GPFN_SEL4_OFF, GPFN_SEL5_OFF,
+    GP_PUP_PDN_CNTRL_REG0, GP_PUP_PDN_CNTRL_REG1, GP_PUP_PDN_CNTRL_REG2, GP_PUP_PDN_CNTRL_REG3,
+    GPREN0_OFF,  GPREN1_OFF,
+    GPFEN0_OFF,  GPFEN1_OFF,
+    GPHEN0_OFF,  GPHEN1_OFF,
+    GPLEN0_OFF,  GPLEN1_OFF,
+    GPAREN0_OFF, GPAREN1_OFF,
+    GPAFEN0_OFF, GPAFEN1_OFF,
+};
+// Writable bits of each register
+static const uint32_t CONFIG_WRITE_MASKS[GPIO_CONFIG_REGS] = {
+    GPREG0_4_3BIT_WRITE_MASK, GPREG0_4_3BIT_WRITE_MASK, GPREG0_4_3BIT_WRITE_MASK,
+    GPREG0_4_3BIT_WRITE_MASK, GPREG0_4_3BIT_WRITE_MASK, GPREG5_3BIT_WRITE_MASK,
+    GPREG0_2_2BIT_WRITE_MASK, GPREG0_2_2BIT_WRITE_MASK, GPREG0_2_2BIT_WRITE_MASK, GPREG3_2BIT_WRITE_MASK,
+    GPREG0_1BIT_WRITE_MASK, GPREG1_1BIT_WRITE_MASK,
+    GPREG0_1BIT_WRITE_MASK, GPREG1_1BIT_WRITE_MASK,
+    GPREG0_1BIT_WRITE_MASK, GPREG1_1BIT_WRITE_MASK,
+    GPREG0_1BIT_WRITE_MASK, GPREG1_1BIT_WRITE_MASK,
+    GPREG0_1BIT_WRITE_MASK, GPREG1_1BIT_WRITE_MASK,
+    GPREG0_1BIT_WRITE_MASK, GPREG1_1BIT_WRITE_MASK,
+};
+// Detector flags, in the order of the detect enable registers above
+static const uint8_t CONFIG_DETECTORS[] = {
+    EVENT_RISING,
+    EVENT_FALLING,
+    EVENT_HIGH,
+    EVENT_LOW,
+    EVENT_ASYNC_RISING,
+    EVENT_ASYNC_FALLING
+};
+// Number of detectors
+static const uint8_t CONFIG_DETECTORS_SZ = sizeof(CONFIG_DETECTORS)/sizeof(CONFIG_DETECTORS[0]);
+
+/// FUNCTION DECLARATIONS ///
+/* Stage a field of a register */
+static inline void __stage_gpio_field(gpio_config_t *, uint8_t, uint32_t, uint32_t);
+
+/// FUNCTION DEFINITIONS ///
+/* "Public" Functions */
+// Start an empty transaction
+int32_t init_gpio_config(gpio_config_t* config)
+{
+    memset(config, 0, sizeof(gpio_config_t));
+    return 0;
+}
+// Stage a pin function
+int32_t stage_gpio_fn(gpio_config_t* config,
+                      uint8_t pin,
+                      enum FunctionSelect fn)
+{
+    /// LOCALS ///
+    // The stage return value
+    int32_t stage_retval = 0;
+
+    if (pin > GPIO_PIN_MAX)
+    {
+        stage_retval = EBAD_PIN;
+    }
+    else
+    {
+        __stage_gpio_field(config, gpio_pin_desc[pin]._fsel_reg, THREE_BIT_MASK << gpio_pin_desc[pin]._fsel_shift,
+                           ((uint32_t) fn) << gpio_pin_desc[pin]._fsel_shift);
+    }
+    return stage_retval;
+}
+// Stage a pin pull resistor
+int32_t stage_gpio_pull(gpio_config_t* config,
+                        uint8_t pin,
+                        enum PullSelect pull)
+{
+    /// LOCALS ///
+    // The stage return value
+    int32_t stage_retval = 0;
+
+    if (pin > GPIO_PIN_MAX)
+    {
+        stage_retval = EBAD_PIN;
+    }
+    // 0b11 is reserved
+    else if (pull > PULL_DOWN)
+    {
+        stage_retval = EOUT_OF_RANGE;
+    }
+    else
+    {
+        __stage_gpio_field(config, CONFIG_PUP_PDN_IND + gpio_pin_desc[pin]._pup_pdn_reg,
+                           TWO_BIT_MASK << gpio_pin_desc[pin]._pup_pdn_shift,
+                           ((uint32_t) pull) << gpio_pin_desc[pin]._pup_pdn_shift);
+    }
+    return stage_retval;
+}
+// Stage pin event detectors
+int32_t stage_gpio_event(gpio_config_t* config,
+                         uint8_t pin,
+                         uint8_t detect)
+{
+    /// LOCALS ///
+    // The stage return value
+    int32_t stage_retval = 0;
+    // Bit of the pin in its bank
+    uint32_t pin_bit     = 0x00;
+    // Detector index
+    uint8_t det_ind      = 0;
+
+    if (pin > GPIO_PIN_MAX)
+    {
+        stage_retval = EBAD_PIN;
+    }
+    // Every detector's bit is staged, enabled or not
+    else
+    {
+        pin_bit = ((uint32_t) 1) << gpio_pin_desc[pin]._bank_shift;
+        for (det_ind = 0; det_ind < CONFIG_DETECTORS_SZ; det_ind++)
+        {
+            __stage_gpio_field(config, CONFIG_EVENT_IND + (det_ind * 2) + gpio_pin_desc[pin]._bank, pin_bit,
+                               (0 != (detect & CONFIG_DETECTORS[det_ind])) ? pin_bit : 0x00);
+        }
+    }
+    return stage_retval;
+}
+// Apply a transaction
+int32_t commit_gpio_config(const gpio_config_t* config)
+{
+    /// LOCALS ///
+    // The commit return value
+    int32_t commit_retval   = 0;
+    // Register being committed
+    volatile uint32_t* reg  = NULL;
+    // Register state
+    uint32_t register_state = 0x00;
+    // Register index
+    uint8_t reg_ind         = 0;
+
+    // Nothing mapped to write to
+    if (NULL == gpio_chip._base)
+    {
+        commit_retval = __gpio_regs_retval();
+    }
+    else
+    {
+        for (reg_ind = 0; reg_ind < GPIO_CONFIG_REGS; reg_ind++)
+        {
+            // Untouched registers are not accessed at all
+            if (0 != config->_mask[reg_ind])
+            {
+                reg = (volatile uint32_t *)(gpio_chip._base + CONFIG_REGS[reg_ind]);
+                // Held across the read and write, like every other update of a shared register
+                __lock_gpio_reg(reg);
+                // A fully staged register needs no read, every bit it keeps is overwritten
+                register_state = ((config->_mask[reg_ind] & CONFIG_WRITE_MASKS[reg_ind]) == CONFIG_WRITE_MASKS[reg_ind]) ?
+                                     0x00 : gpio_reg_read(reg);
+                gpio_reg_write(reg, ((register_state & ~config->_mask[reg_ind]) | config->_bits[reg_ind]) &
+                                    CONFIG_WRITE_MASKS[reg_ind]);
+                __unlock_gpio_reg(reg);
+            }
+        }
+    }
+    return commit_retval;
+}
+
+/* "Private" Functions */
+// Stage a field
+static inline void __stage_gpio_field(gpio_config_t* config,
+                                      uint8_t reg_ind,
+                                      uint32_t field_mask,
+                                      uint32_t field_bits)
+{
+    config->_mask[reg_ind] |= field_mask;
+    config->_bits[reg_ind]  = (config->_bits[reg_ind] & ~field_mask) | (field_bits & field_mask);
+}
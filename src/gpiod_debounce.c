@@ -0,0 +1,85 @@
+#include <stddef.h>
+#include <string.h>
+#include <gpiod.h>
+#include <gpiod_debounce.h>
+#include <gpiod_internals.h>
+
+/// GLOBALS ///
+// Every pin of the chip as a 64-bit pin word
+static const uint64_t DEBOUNCE_ALL_PINS = (GPIO_PIN_BIT(GPIO_PIN_MAX) << 1) - 1;
+
+/// FUNCTION DEFINITIONS ///
+/* "Public" Functions */
+// Initialize a debouncer
+int32_t init_gpio_debounce(gpio_debounce_t* deb,
+                           uint64_t pin_mask,
+                           uint64_t levels,
+                           uint8_t samples)
+{
+    /// LOCALS ///
+    // The init return value
+    int32_t init_retval = 0;
+
+    if (0 != (pin_mask & ~DEBOUNCE_ALL_PINS))
+    {
+        init_retval = EBAD_PIN;
+    }
+    else if ((0 == samples) || (GPIO_DEBOUNCE_MAX < samples))
+    {
+        init_retval = EOUT_OF_RANGE;
+    }
+    else
+    {
+        memset(deb, 0, sizeof(*deb));
+        deb->levels   = levels;
+        deb->pin_mask = pin_mask;
+        init_retval   = set_gpio_debounce_threshold(deb, pin_mask, samples);
+    }
+    return init_retval;
+}
+// Set the threshold of some pins
+int32_t set_gpio_debounce_threshold(gpio_debounce_t* deb,
+                                    uint64_t pin_mask,
+                                    uint8_t samples)
+{
+    /// LOCALS ///
+    // The set return value
+    int32_t set_retval = 0;
+    // Count bit index
+    uint8_t bit        = 0;
+
+    if (0 != (pin_mask & ~DEBOUNCE_ALL_PINS))
+    {
+        set_retval = EBAD_PIN;
+    }
+    else if ((0 == samples) || (GPIO_DEBOUNCE_MAX < samples))
+    {
+        set_retval = EOUT_OF_RANGE;
+    }
+    else
+    {
+        for (bit = 0; bit < GPIO_DEBOUNCE_BITS; bit++)
+        {
+            deb->_threshold[bit] = (deb->_threshold[bit] & ~pin_mask) | ((0 != ((samples >> bit) & 0x01)) ? pin_mask : 0);
+            // A count kept against the old threshold could already be past the new one
+            deb->_count[bit]    &= ~pin_mask;
+        }
+    }
+    return set_retval;
+}
+// Read the levels and debounce them
+int32_t sample_gpio_debounce(gpio_debounce_t* deb,
+                             uint64_t* changed)
+{
+    /// LOCALS ///
+    // The sample return value
+    int32_t sample_retval = 0;
+    // Levels read
+    uint64_t levels       = 0x00;
+
+    if (0 == (sample_retval = __read_gpio_levels(&levels)))
+    {
+        *changed = update_gpio_debounce(deb, levels);
+    }
+    return sample_retval;
+}
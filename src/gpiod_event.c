@@ -0,0 +1,200 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <gpiod.h>
+#include <gpiod_event.h>
+#include <gpiod_internals.h>
+#include <gpiod_time.h>
+#include <gpiod_regs.h>
+#include <gpio_addressing.h>
+
+/// GLOBALS ///
+// Size of a 32-bit int 
+static const uint8_t BIT32_SIZE = 32;
+// Detector flags, in the order of the line's enable registers below
+static const uint8_t EVENT_DETECTORS[] = {
+    EVENT_RISING,
+    EVENT_FALLING,
+    EVENT_HIGH,
+    EVENT_LOW,
+    EVENT_ASYNC_RISING,
+    EVENT_ASYNC_FALLING
+};
+// Number of detectors
+static const uint8_t EVENT_DETECTORS_SZ = sizeof(EVENT_DETECTORS)/sizeof(EVENT_DETECTORS[0]);
+
+/// FUNCTION DECLARATIONS ///
+/* Read both event status registers */
+static uint64_t __read_gpio_eds(void);
+/* Write-1-to-clear the given event status bits, one store per register with bits to clear */
+static void __clear_gpio_eds(uint64_t);
+
+/// FUNCTION DEFINITIONS ///
+/* "Public" Functions */
+// Select the event detectors of a line
+int32_t set_gpio_event(gpio_line_t* line,
+                       uint8_t detect)
+{
+    /// LOCALS ///
+    // The set return value
+    int32_t set_retval = 0;
+    // Enable registers of the line, in the order of EVENT_DETECTORS
+    volatile uint32_t* enable_regs[6];
+    // Bit of the pin in its bank
+    uint32_t pin_bit   = 0x00;
+    // Detector index
+    uint8_t det_ind    = 0;
+
+    // Check the line was requested
+    if (NULL == line->priv_dat)
+    {
+        set_retval = EPDAT_NULL;
+    }
+    // The kernel's edge detection on character device lines
+    else if (NULL == line->priv_dat->_base)
+    {
+        set_retval = __cdev_set_gpio_event(line->priv_dat, detect);
+    }
+    else
+    {
+        enable_regs[0] = __gpio_bank_reg(line->priv_dat, GPREN0_OFF);
+        enable_regs[1] = __gpio_bank_reg(line->priv_dat, GPFEN0_OFF);
+        enable_regs[2] = __gpio_bank_reg(line->priv_dat, GPHEN0_OFF);
+        enable_regs[3] = __gpio_bank_reg(line->priv_dat, GPLEN0_OFF);
+        enable_regs[4] = __gpio_bank_reg(line->priv_dat, GPAREN0_OFF);
+        enable_regs[5] = __gpio_bank_reg(line->priv_dat, GPAFEN0_OFF);
+        pin_bit = __gpio_bank_bit(line->priv_dat);
+        // Update the pin's bit in each enable register under the register's lock, leaving the other pins as they were
+        for (det_ind = 0; det_ind < EVENT_DETECTORS_SZ; det_ind++)
+        {
+            __update_gpio_reg(enable_regs[det_ind], pin_bit, (0 != (detect & EVENT_DETECTORS[det_ind])) ? pin_bit : 0x00,
+                              __gpio_bank_mask(line->priv_dat));
+        }
+    }
+    return set_retval;
+}
+// Read and clear all fired event bits
+int32_t poll_gpio_event_bits(uint64_t* fired)
+{
+    return __poll_gpio_event_bits(UINT64_MAX, fired);
+}
+// Deliver a batch of events
+int32_t poll_gpio_events(gpio_event_t* events,
+                         uint32_t max_events)
+{
+    /// LOCALS ///
+    // The poll return value, the number of events on success
+    int32_t poll_retval = 0;
+    // Fired event status bits
+    uint64_t fired      = 0x00;
+    // Bits delivered in this batch
+    uint64_t delivered  = 0x00;
+    // Pin levels at the time of the poll
+    uint64_t levels     = 0x00;
+    // Timestamp shared by the batch
+    uint64_t now_ns     = 0;
+    // Number of events delivered
+    uint32_t num_events = 0;
+    // Pin of the event
+    uint8_t pin         = 0;
+
+    // Events of character device lines are queued by the kernel
+    if (BACKEND_CHARDEV == gpio_chip._backend && 0 != gpio_chip._ref_count)
+    {
+        poll_retval = __cdev_poll_gpio_events(events, max_events);
+    }
+    // Nothing mapped to poll
+    else if (NULL == gpio_chip._base)
+    {
+        poll_retval = ECHIP_CLOSED;
+    }
+    // Only read the levels and the time if something fired
+    else if (0 != (fired = __read_gpio_eds()))
+    {
+        now_ns = gpio_time_ns();
+        __read_gpio_levels(&levels);
+        // Lowest pins first, the rest stay pending for the next pass
+        while ((0 != fired) && (num_events < max_events))
+        {
+            pin = (uint8_t) __builtin_ctzll(fired);
+            events[num_events].timestamp_ns = now_ns;
+            events[num_events].pin          = pin;
+            events[num_events].level        = GPIO_PIN_LEVEL(levels, pin);
+            delivered |= GPIO_PIN_BIT(pin);
+            fired     &= fired - 1;
+            num_events++;
+        }
+        __clear_gpio_eds(delivered);
+        poll_retval = (int32_t) num_events;
+    }
+    return poll_retval;
+}
+// Pollable fd of the line's events
+int32_t get_gpio_event_fd(gpio_line_t* line)
+{
+    /// LOCALS ///
+    // The get return value, the fd on success
+    int32_t get_retval = 0;
+
+    // Check the line was requested
+    if (NULL == line->priv_dat)
+    {
+        get_retval = EPDAT_NULL;
+    }
+    // Only a kernel line request has a queue to poll, the register backends go through the poller
+    else if (NULL != line->priv_dat->_base)
+    {
+        get_retval = EBACKEND;
+    }
+    // The line lost its request
+    else if (-1 == line->priv_dat->_fd)
+    {
+        get_retval = EKERNEL;
+    }
+    else
+    {
+        get_retval = line->priv_dat->_fd;
+    }
+    return get_retval;
+}
+
+/* "Private" Functions */
+// Read and clear the fired event bits of some pins
+int32_t __poll_gpio_event_bits(uint64_t pin_mask,
+                               uint64_t* fired)
+{
+    /// LOCALS ///
+    // The poll return value
+    int32_t poll_retval = 0;
+
+    // Nothing mapped to poll
+    if (NULL == gpio_chip._base)
+    {
+        poll_retval = __gpio_regs_retval();
+    }
+    // The other pins' bits stay set for whoever polls them
+    else
+    {
+        *fired = __read_gpio_eds() & pin_mask;
+        __clear_gpio_eds(*fired);
+    }
+    return poll_retval;
+}
+// Read both event status registers
+static uint64_t __read_gpio_eds(void)
+{
+    return ((uint64_t) (gpio_reg_read((volatile uint32_t *)(gpio_chip._base + GPEDS0_OFF)) & GPREG0_1BIT_READ_MASK)) |
+           ((uint64_t) (gpio_reg_read((volatile uint32_t *)(gpio_chip._base + GPEDS1_OFF)) & GPREG1_1BIT_READ_MASK) << BIT32_SIZE);
+}
+// Clear event status bits
+static void __clear_gpio_eds(uint64_t clear_bits)
+{
+    // Writing a 0 leaves a status bit untouched, so only registers with bits to clear are written
+    if (0 != (uint32_t) clear_bits)
+    {
+        gpio_reg_write((volatile uint32_t *)(gpio_chip._base + GPEDS0_OFF), (uint32_t) clear_bits & GPREG0_1BIT_WRITE_MASK);
+    }
+    if (0 != (uint32_t)(clear_bits >> BIT32_SIZE))
+    {
+        gpio_reg_write((volatile uint32_t *)(gpio_chip._base + GPEDS1_OFF), (uint32_t)(clear_bits >> BIT32_SIZE) & GPREG1_1BIT_WRITE_MASK);
+    }
+}
@@ -0,0 +1,339 @@
+#define _GNU_SOURCE
+#include <stddef.h>
+#include <string.h>
+#include <sched.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <gpiod.h>
+#include <gpiod_event.h>
+#include <gpiod_poller.h>
+#include <gpiod_internals.h>
+#include <gpiod_time.h>
+
+/// FUNCTION DECLARATIONS ///
+/* Make the ring's eventfd readable */
+static void __signal_gpio_ring(gpio_ring_t *);
+/* Push a record, producer side only */
+static void __push_gpio_ring(gpio_ring_t *, const gpio_change_t *);
+/* Poller thread body */
+static void* __gpio_poller_thread(void *);
+
+/// FUNCTION DEFINITIONS ///
+/* "Public" Functions */
+// Initialize a ring
+int32_t init_gpio_ring(gpio_ring_t* ring,
+                       gpio_change_t* records,
+                       uint32_t capacity,
+                       uint64_t pin_mask)
+{
+    /// LOCALS ///
+    // The init return value
+    int32_t init_retval = 0;
+
+    // Indices wrap with a mask, the capacity must be a power of two
+    if ((NULL == records) || (0 == capacity) || (0 != (capacity & (capacity - 1))))
+    {
+        init_retval = EOUT_OF_RANGE;
+    }
+    else
+    {
+        ring->_records = records;
+        ring->_mask    = capacity - 1;
+        ring->pin_mask = pin_mask;
+        atomic_init(&ring->_head, 0);
+        atomic_init(&ring->_tail, 0);
+        atomic_init(&ring->_overflows, 0);
+        atomic_init(&ring->_armed, false);
+        atomic_init(&ring->_event_fd, -1);
+        atomic_init(&ring->_signalling, 0);
+    }
+    return init_retval;
+}
+// Drain a ring
+uint32_t drain_gpio_ring(gpio_ring_t* ring,
+                         gpio_change_t* out,
+                         uint32_t max_records)
+{
+    /// LOCALS ///
+    // Consumer index, only this side writes it
+    uint32_t tail    = atomic_load_explicit(&ring->_tail, memory_order_relaxed);
+    // Producer index, acquire so the records before it are visible
+    uint32_t head    = atomic_load_explicit(&ring->_head, memory_order_acquire);
+    // Records drained
+    uint32_t drained = 0;
+    // The ring's eventfd, only the consumer opens and closes it
+    int32_t event_fd = atomic_load_explicit(&ring->_event_fd, memory_order_relaxed);
+
+    // Copy out the whole batch, then free the slots with one store
+    while ((tail != head) && (drained < max_records))
+    {
+        out[drained++] = ring->_records[tail & ring->_mask];
+        tail++;
+    }
+    atomic_store_explicit(&ring->_tail, tail, memory_order_release);
+    // Found empty, consume the signal and arm the fd for the next push
+    if ((-1 != event_fd) && (drained < max_records))
+    {
+        eventfd_read(event_fd, &(eventfd_t) {0});
+        atomic_store(&ring->_armed, true);
+        // A push since the drain may have gone unsignalled, or had its signal consumed above, signal it here instead
+        if (tail != atomic_load(&ring->_head))
+        {
+            atomic_store(&ring->_armed, false);
+            __signal_gpio_ring(ring);
+        }
+    }
+    return drained;
+}
+// Open the ring's eventfd
+int32_t open_gpio_ring_fd(gpio_ring_t* ring)
+{
+    /// LOCALS ///
+    // The open return value, the fd on success
+    int32_t open_retval = atomic_load(&ring->_event_fd);
+
+    // Non-blocking, a drain consuming the signal never waits
+    if ((-1 == open_retval) && (-1 == (open_retval = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))))
+    {
+        open_retval = EFILE_IO;
+    }
+    else if (-1 == atomic_load(&ring->_event_fd))
+    {
+        atomic_store(&ring->_event_fd, open_retval);
+        // Records pushed before the fd existed are signalled now, else the fd waits for the first push
+        if (atomic_load(&ring->_head) != atomic_load(&ring->_tail))
+        {
+            __signal_gpio_ring(ring);
+        }
+        else
+        {
+            atomic_store(&ring->_armed, true);
+        }
+    }
+    return open_retval;
+}
+// Close the ring's eventfd
+int32_t close_gpio_ring_fd(gpio_ring_t* ring)
+{
+    /// LOCALS ///
+    // The close return value
+    int32_t close_retval = 0;
+    // The fd closed
+    int32_t event_fd     = atomic_exchange(&ring->_event_fd, -1);
+
+    if (-1 == event_fd)
+    {
+        close_retval = EPDAT_NULL;
+    }
+    else
+    {
+        atomic_store(&ring->_armed, false);
+        // A producer that loaded the fd before the exchange is counted, it is done with it once the count drops
+        while (0 != atomic_load(&ring->_signalling))
+        {
+            sched_yield();
+        }
+        close(event_fd);
+    }
+    return close_retval;
+}
+// Ring overflows
+uint64_t gpio_ring_overflows(gpio_ring_t* ring)
+{
+    return atomic_load_explicit(&ring->_overflows, memory_order_relaxed);
+}
+// Initialize a poller
+int32_t init_gpio_poller(gpio_poller_t* poller,
+                         bool sample_events)
+{
+    memset(poller->_rings, 0, sizeof(poller->_rings));
+    poller->_num_rings     = 0;
+    poller->_watch_mask    = 0x00;
+    poller->_sample_events = sample_events;
+    atomic_init(&poller->_running, false);
+    return 0;
+}
+// Add a ring to a poller
+int32_t add_gpio_poller_ring(gpio_poller_t* poller,
+                             gpio_ring_t* ring)
+{
+    /// LOCALS ///
+    // The add return value
+    int32_t add_retval = 0;
+
+    // The ring table is read by the thread without a lock, it is fixed once started
+    if (atomic_load(&poller->_running))
+    {
+        add_retval = ETHREAD;
+    }
+    else if (GPIO_POLLER_MAX_RINGS == poller->_num_rings)
+    {
+        add_retval = EOUT_OF_RANGE;
+    }
+    else
+    {
+        poller->_rings[poller->_num_rings++] = ring;
+        poller->_watch_mask |= ring->pin_mask;
+    }
+    return add_retval;
+}
+// Start the poller
+int32_t start_gpio_poller(gpio_poller_t* poller,
+                          int32_t cpu)
+{
+    /// LOCALS ///
+    // The start return value
+    int32_t start_retval = 0;
+    // Thread attributes, carrying the CPU affinity
+    pthread_attr_t attr;
+    // CPU the thread is pinned to
+    cpu_set_t cpu_set;
+
+    if (atomic_load(&poller->_running))
+    {
+        start_retval = ETHREAD;
+    }
+    // The poller keeps the mapping alive while it runs, every pass reads the level registers
+    else if ((0 == (start_retval = __get_gpio_chip(BACKEND_DEV_MEM, NULL))) &&
+             (0 != (start_retval = __gpio_regs_retval())))
+    {
+        __put_gpio_chip();
+    }
+    else if (0 == start_retval)
+    {
+        pthread_attr_init(&attr);
+        if (0 <= cpu)
+        {
+            CPU_ZERO(&cpu_set);
+            CPU_SET(cpu, &cpu_set);
+            pthread_attr_setaffinity_np(&attr, sizeof(cpu_set), &cpu_set);
+        }
+        atomic_store(&poller->_running, true);
+        if (0 != pthread_create(&poller->_thread, &attr, __gpio_poller_thread, poller))
+        {
+            atomic_store(&poller->_running, false);
+            __put_gpio_chip();
+            start_retval = ETHREAD;
+        }
+        pthread_attr_destroy(&attr);
+    }
+    return start_retval;
+}
+// Stop the poller
+int32_t stop_gpio_poller(gpio_poller_t* poller)
+{
+    /// LOCALS ///
+    // The stop return value
+    int32_t stop_retval = 0;
+
+    if (!atomic_exchange(&poller->_running, false))
+    {
+        stop_retval = ETHREAD;
+    }
+    else
+    {
+        pthread_join(poller->_thread, NULL);
+        stop_retval = __put_gpio_chip();
+    }
+    return stop_retval;
+}
+
+/* "Private" Functions */
+// Push a record
+static void __push_gpio_ring(gpio_ring_t* ring,
+                             const gpio_change_t* change)
+{
+    /// LOCALS ///
+    // Producer index, only this side writes it
+    uint32_t head = atomic_load_explicit(&ring->_head, memory_order_relaxed);
+    // Consumer index, acquire so the slot it freed is no longer being read
+    uint32_t tail = atomic_load_explicit(&ring->_tail, memory_order_acquire);
+
+    // Full, drop the record rather than wait on the consumer
+    if ((head - tail) > ring->_mask)
+    {
+        atomic_fetch_add_explicit(&ring->_overflows, 1, memory_order_relaxed);
+    }
+    // Fill the slot, then publish it
+    else
+    {
+        ring->_records[head & ring->_mask] = *change;
+        atomic_store_explicit(&ring->_head, head + 1, memory_order_release);
+        // Only the first push after the consumer found the ring empty signals, ordered after the publish
+        // against the consumer's arm-then-check
+        if (-1 != atomic_load_explicit(&ring->_event_fd, memory_order_relaxed))
+        {
+            atomic_thread_fence(memory_order_seq_cst);
+            if (atomic_load_explicit(&ring->_armed, memory_order_relaxed) && atomic_exchange(&ring->_armed, false))
+            {
+                __signal_gpio_ring(ring);
+            }
+        }
+    }
+}
+// Signal the ring's eventfd
+static void __signal_gpio_ring(gpio_ring_t* ring)
+{
+    /// LOCALS ///
+    // The ring's eventfd, loaded once counted so a close cannot free it under the write
+    int32_t event_fd = -1;
+
+    atomic_fetch_add(&ring->_signalling, 1);
+    if (-1 != (event_fd = atomic_load(&ring->_event_fd)))
+    {
+        eventfd_write(event_fd, 1);
+    }
+    atomic_fetch_sub(&ring->_signalling, 1);
+}
+// Poller thread
+static void* __gpio_poller_thread(void* arg)
+{
+    /// LOCALS ///
+    // The poller this thread runs
+    gpio_poller_t* poller = (gpio_poller_t *) arg;
+    // Current sample
+    gpio_change_t change;
+    // Levels of the previous sample, valid once a read succeeded
+    uint64_t prev_levels  = 0x00;
+    bool primed           = (0 == __read_gpio_levels(&prev_levels));
+    // Ring index
+    uint8_t ring_ind      = 0;
+
+    change.events = 0x00;
+    while (atomic_load_explicit(&poller->_running, memory_order_relaxed))
+    {
+        // A failed read has nothing to compare, the pass is skipped
+        if (0 != __read_gpio_levels(&change.levels))
+        {
+            continue;
+        }
+        else if (!primed)
+        {
+            prev_levels = change.levels;
+            primed      = true;
+            continue;
+        }
+        // Only the watched pins' events are taken, another thread may poll the rest
+        if (poller->_sample_events)
+        {
+            __poll_gpio_event_bits(poller->_watch_mask, &change.events);
+        }
+        change.changed = change.levels ^ prev_levels;
+        prev_levels    = change.levels;
+        // Nothing any consumer cares about, go straight to the next sample
+        if (0 == ((change.changed | change.events) & poller->_watch_mask))
+        {
+            continue;
+        }
+        change.timestamp_ns = gpio_time_ns();
+        for (ring_ind = 0; ring_ind < poller->_num_rings; ring_ind++)
+        {
+            if (0 != ((change.changed | change.events) & poller->_rings[ring_ind]->pin_mask))
+            {
+                __push_gpio_ring(poller->_rings[ring_ind], &change);
+            }
+        }
+    }
+    return NULL;
+}
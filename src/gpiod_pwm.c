@@ -0,0 +1,255 @@
+#include <stddef.h>
+#include <string.h>
+#include <gpiod.h>
+#include <gpiod_pwm.h>
+#include <gpiod_internals.h>
+#include <gpiod_time.h>
+
+/// FUNCTION DECLARATIONS ///
+/* Rebuild the schedule of one period from the current duties */
+static void __build_gpio_pwm(gpio_pwm_t *);
+
+/// FUNCTION DEFINITIONS ///
+/* "Public" Functions */
+// Initialize a PWM engine
+int32_t init_gpio_pwm(gpio_pwm_t* pwm,
+                      gpio_bulk_t* bulk,
+                      uint32_t period_ns)
+{
+    /// LOCALS ///
+    // The init return value
+    int32_t init_retval = 0;
+    // Channel index
+    uint8_t chan_ind    = 0;
+
+    // Group must have been requested, the channels store to the registers
+    if (-1 != bulk->_fd)
+    {
+        init_retval = EBACKEND;
+    }
+    else if (NULL == bulk->_base)
+    {
+        init_retval = EPDAT_NULL;
+    }
+    else if (0 == period_ns)
+    {
+        init_retval = EOUT_OF_RANGE;
+    }
+    else
+    {
+        pwm->_bulk         = bulk;
+        pwm->_period_ns    = period_ns;
+        pwm->_num_channels = 0;
+        pwm->_num_steps    = 0;
+        for (chan_ind = 0; chan_ind < GPIO_PWM_MAX_CHANNELS; chan_ind++)
+        {
+            atomic_init(&pwm->_duty_ns[chan_ind], 0);
+        }
+        atomic_init(&pwm->_generation, 0);
+        atomic_init(&pwm->_running, false);
+        memset(&pwm->_timing, 0, sizeof(pwm->_timing));
+    }
+    return init_retval;
+}
+// Add a channel
+int32_t add_gpio_pwm_channel(gpio_pwm_t* pwm,
+                             uint8_t pin,
+                             uint32_t duty_ns)
+{
+    /// LOCALS ///
+    // The add return value, the channel index on success
+    int32_t add_retval = 0;
+    // Pins already driven by a channel
+    uint64_t chan_mask = 0x00;
+    // Channel index
+    uint8_t chan_ind   = 0;
+
+    for (chan_ind = 0; chan_ind < pwm->_num_channels; chan_ind++)
+    {
+        chan_mask |= GPIO_PIN_BIT(pwm->_pins[chan_ind]);
+    }
+    // Channels are fixed once the loop is started
+    if (atomic_load(&pwm->_running))
+    {
+        add_retval = ETHREAD;
+    }
+    else if (pin > GPIO_PIN_MAX)
+    {
+        add_retval = EBAD_PIN;
+    }
+    // Pins were validated as outputs when the group was requested, and one channel drives a pin
+    else if ((0 == (GPIO_PIN_BIT(pin) & pwm->_bulk->pin_mask)) || (0 != (GPIO_PIN_BIT(pin) & chan_mask)))
+    {
+        add_retval = EPIN_CONFIG;
+    }
+    else if (GPIO_PWM_MAX_CHANNELS == pwm->_num_channels)
+    {
+        add_retval = EOUT_OF_RANGE;
+    }
+    else
+    {
+        pwm->_pins[pwm->_num_channels] = pin;
+        add_retval = pwm->_num_channels++;
+        set_gpio_pwm_duty(pwm, (uint8_t) add_retval, duty_ns);
+    }
+    return add_retval;
+}
+// Set a channel's duty
+int32_t set_gpio_pwm_duty(gpio_pwm_t* pwm,
+                          uint8_t channel,
+                          uint32_t duty_ns)
+{
+    /// LOCALS ///
+    // The set return value
+    int32_t set_retval = 0;
+
+    if (channel >= pwm->_num_channels)
+    {
+        set_retval = EOUT_OF_RANGE;
+    }
+    // Publish the duty, then the generation the loop compares against
+    else
+    {
+        atomic_store_explicit(&pwm->_duty_ns[channel], (duty_ns < pwm->_period_ns) ? duty_ns : pwm->_period_ns, 
+                              memory_order_relaxed);
+        atomic_fetch_add_explicit(&pwm->_generation, 1, memory_order_release);
+    }
+    return set_retval;
+}
+// Arm the PWM loop
+int32_t start_gpio_pwm(gpio_pwm_t* pwm)
+{
+    atomic_store(&pwm->_running, true);
+    return 0;
+}
+// Run the PWM loop
+int32_t run_gpio_pwm(gpio_pwm_t* pwm,
+                     uint32_t periods)
+{
+    /// LOCALS ///
+    // Register base of the group
+    void* base            = pwm->_bulk->_base;
+    // Generation of the schedule built
+    uint32_t built_gen    = atomic_load_explicit(&pwm->_generation, memory_order_acquire);
+    // Generation published by the duty setters
+    uint32_t current_gen  = built_gen;
+    // Deadline of the next step
+    uint64_t deadline_ns  = 0;
+    // Time read while spinning
+    uint64_t now_ns       = 0;
+    // Periods run
+    uint32_t period_ind   = 0;
+    // Step index
+    uint32_t step_ind     = 0;
+
+    __build_gpio_pwm(pwm);
+    memset(&pwm->_timing, 0, sizeof(pwm->_timing));
+    deadline_ns = gpio_time_ns();
+    while (atomic_load_explicit(&pwm->_running, memory_order_relaxed) && ((0 == periods) || (period_ind < periods)))
+    {
+        // Period boundary, only re-sort the edges when a duty changed
+        if (built_gen != (current_gen = atomic_load_explicit(&pwm->_generation, memory_order_acquire)))
+        {
+            built_gen = current_gen;
+            __build_gpio_pwm(pwm);
+        }
+        for (step_ind = 0; step_ind < pwm->_num_steps; step_ind++)
+        {
+            while ((now_ns = gpio_time_ns()) < deadline_ns)
+            {
+            }
+            __write_gpio_masks(base, pwm->_steps[step_ind].set_mask, pwm->_steps[step_ind].clr_mask);
+            pwm->_timing.steps++;
+            pwm->_timing.total_late_ns += now_ns - deadline_ns;
+            pwm->_timing.max_late_ns    = ((now_ns - deadline_ns) > pwm->_timing.max_late_ns) ? 
+                                              (now_ns - deadline_ns) : pwm->_timing.max_late_ns;
+            deadline_ns += pwm->_steps[step_ind].delay_ns;
+        }
+        period_ind++;
+    }
+    atomic_store(&pwm->_running, false);
+    return 0;
+}
+// Stop the PWM loop
+int32_t stop_gpio_pwm(gpio_pwm_t* pwm)
+{
+    atomic_store(&pwm->_running, false);
+    return 0;
+}
+// Timing report
+int32_t get_gpio_pwm_timing(gpio_pwm_t* pwm,
+                            gpio_wave_timing_t* timing)
+{
+    *timing = pwm->_timing;
+    return 0;
+}
+
+/* "Private" Functions */
+// Build the schedule
+static void __build_gpio_pwm(gpio_pwm_t* pwm)
+{
+    /// LOCALS ///
+    // Duty of each partially on channel, sorted ascending
+    uint32_t edge_ns[GPIO_PWM_MAX_CHANNELS];
+    // Pin bit of each sorted edge
+    uint64_t edge_bit[GPIO_PWM_MAX_CHANNELS];
+    // Number of sorted edges
+    uint8_t num_edges = 0;
+    // Channels on at the start of the period
+    uint64_t on_bits  = 0x00;
+    // Channels off for the whole period
+    uint64_t off_bits = 0x00;
+    // Duty of the channel
+    uint32_t duty_ns  = 0;
+    // Start time of the current step
+    uint32_t step_ns  = 0;
+    // Channel and sort index
+    uint8_t chan_ind  = 0;
+    uint8_t sort_ind  = 0;
+
+    for (chan_ind = 0; chan_ind < pwm->_num_channels; chan_ind++)
+    {
+        duty_ns = atomic_load_explicit(&pwm->_duty_ns[chan_ind], memory_order_relaxed);
+        if (0 == duty_ns)
+        {
+            off_bits |= GPIO_PIN_BIT(pwm->_pins[chan_ind]);
+            continue;
+        }
+        on_bits |= GPIO_PIN_BIT(pwm->_pins[chan_ind]);
+        // Fully on channels are never cleared
+        if (duty_ns < pwm->_period_ns)
+        {
+            // Insertion sort, channels are few and this only runs on a duty change
+            for (sort_ind = num_edges; (sort_ind > 0) && (edge_ns[sort_ind - 1] > duty_ns); sort_ind--)
+            {
+                edge_ns[sort_ind]  = edge_ns[sort_ind - 1];
+                edge_bit[sort_ind] = edge_bit[sort_ind - 1];
+            }
+            edge_ns[sort_ind]  = duty_ns;
+            edge_bit[sort_ind] = GPIO_PIN_BIT(pwm->_pins[chan_ind]);
+            num_edges++;
+        }
+    }
+    // Step 0 sets every channel that is on and clears every channel that is off
+    pwm->_steps[0].set_mask = on_bits;
+    pwm->_steps[0].clr_mask = off_bits;
+    pwm->_num_steps = 1;
+    step_ns = 0;
+    // One clear per distinct edge, each step lasts until the next
+    for (sort_ind = 0; sort_ind < num_edges; sort_ind++)
+    {
+        if (edge_ns[sort_ind] == step_ns)
+        {
+            pwm->_steps[pwm->_num_steps - 1].clr_mask |= edge_bit[sort_ind];
+        }
+        else
+        {
+            pwm->_steps[pwm->_num_steps - 1].delay_ns = edge_ns[sort_ind] - step_ns;
+            pwm->_steps[pwm->_num_steps].set_mask     = 0x00;
+            pwm->_steps[pwm->_num_steps].clr_mask     = edge_bit[sort_ind];
+            pwm->_num_steps++;
+            step_ns = edge_ns[sort_ind];
+        }
+    }
+    pwm->_steps[pwm->_num_steps - 1].delay_ns = pwm->_period_ns - step_ns;
+}
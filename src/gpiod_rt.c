@@ -0,0 +1,212 @@
+#define _GNU_SOURCE
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <alloca.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include <gpiod.h>
+#include <gpiod_rt.h>
+#include <gpiod_internals.h>
+#include <gpiod_regs.h>
+#include <gpio_addressing.h>
+
+/// FUNCTION DECLARATIONS ///
+/* Fault in the given bytes of the heap and keep them */
+static int32_t __prefault_gpio_heap(uint32_t);
+/* Fault in the given bytes of the calling thread's stack */
+static void __attribute__((noinline)) __prefault_gpio_stack(uint32_t);
+/* Write one byte of each page of a block, the stores cannot be dropped as dead */
+static void __touch_gpio_pages(volatile uint8_t *, uint32_t);
+/* Touch the register mapping, if the chip context has one */
+static void __prefault_gpio_regs(void);
+
+/// FUNCTION DEFINITIONS ///
+/* "Public" Functions */
+// Default setup
+int32_t init_gpio_rt_config(gpio_rt_config_t* config)
+{
+    config->cpu         = -1;
+    config->priority    = GPIO_RT_PRIORITY;
+    config->lock_memory = true;
+    config->stack_bytes = GPIO_RT_STACK_BYTES;
+    config->heap_bytes  = GPIO_RT_HEAP_BYTES;
+    return 0;
+}
+// Set up the calling thread for real-time use
+int32_t setup_gpio_rt(const gpio_rt_config_t* config)
+{
+    /// LOCALS ///
+    // The setup return value
+    int32_t setup_retval = 0;
+    // CPUs online
+    long num_cpus        = sysconf(_SC_NPROCESSORS_ONLN);
+    // Affinity of the calling thread
+    cpu_set_t cpus;
+    // Priority of the calling thread
+    struct sched_param param;
+
+    if ((config->cpu < -1) || (config->cpu >= CPU_SETSIZE) || ((0 < num_cpus) && (config->cpu >= num_cpus)) ||
+        ((0 != config->priority) && ((config->priority < sched_get_priority_min(SCHED_FIFO)) ||
+                                     (config->priority > sched_get_priority_max(SCHED_FIFO)))))
+    {
+        setup_retval = EOUT_OF_RANGE;
+    }
+    else
+    {
+        CPU_ZERO(&cpus);
+        if (-1 != config->cpu)
+        {
+            CPU_SET(config->cpu, &cpus);
+        }
+        if ((-1 != config->cpu) && (0 != pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus)))
+        {
+            setup_retval = ERT_SETUP;
+        }
+        else if (config->lock_memory && (0 != mlockall(MCL_CURRENT | MCL_FUTURE)))
+        {
+            setup_retval = ERT_SETUP;
+        }
+        else if (0 == (setup_retval = __prefault_gpio_heap(config->heap_bytes)))
+        {
+            __prefault_gpio_stack(config->stack_bytes);
+            init_gpio_timebase();
+            __prefault_gpio_regs();
+            param.sched_priority = config->priority;
+            if ((0 != config->priority) && (0 != pthread_setschedparam(pthread_self(), SCHED_FIFO, &param)))
+            {
+                setup_retval = ERT_SETUP;
+            }
+        }
+    }
+    return setup_retval;
+}
+// Measure the jitter of a write loop
+int32_t run_gpio_rt_selftest(gpio_line_t* line,
+                             uint32_t iters,
+                             uint64_t period_ns,
+                             gpio_rt_report_t* report)
+{
+    /// LOCALS ///
+    // The selftest return value
+    int32_t selftest_retval = 0;
+    // Deadline of the next write, and the time its write completed
+    uint64_t deadline_ns    = 0;
+    uint64_t stamp_ns       = 0;
+    // Time from the deadline to the write completing
+    uint64_t late_ns        = 0;
+    // Sum of the times, for the mean
+    uint64_t total_ns       = 0;
+    // Write index
+    uint32_t iter           = 0;
+    // Histogram bucket
+    uint8_t bucket          = 0;
+
+    memset(report, 0, sizeof(*report));
+    report->period_ns = period_ns;
+    report->min_ns    = UINT64_MAX;
+    if (0 == iters)
+    {
+        selftest_retval = EOUT_OF_RANGE;
+    }
+    // One untimed write, the line's first write may still fault or miss in the cache
+    else if (0 == (selftest_retval = write_gpio_ts(line, 0, &deadline_ns)))
+    {
+        for (iter = 0; (0 == selftest_retval) && (iter < iters); iter++)
+        {
+            if (0 != period_ns)
+            {
+                deadline_ns += period_ns;
+                gpio_delay_until_ns(deadline_ns);
+            }
+            if (0 == (selftest_retval = write_gpio_ts(line, (iter + 1) & 0x01, &stamp_ns)))
+            {
+                late_ns         = stamp_ns - deadline_ns;
+                total_ns       += late_ns;
+                report->min_ns  = (late_ns < report->min_ns) ? late_ns : report->min_ns;
+                report->max_ns  = (late_ns > report->max_ns) ? late_ns : report->max_ns;
+                report->stalls += (late_ns > GPIO_RT_STALL_NS) ? 1 : 0;
+                bucket          = (0 == late_ns) ? 0 : (uint8_t) (64 - __builtin_clzll(late_ns));
+                report->hist[(bucket < GPIO_RT_HIST_SZ) ? bucket : (GPIO_RT_HIST_SZ - 1)]++;
+                report->iters++;
+                // Back to back, the next write is timed from this one
+                deadline_ns     = (0 == period_ns) ? stamp_ns : deadline_ns;
+            }
+        }
+    }
+    report->mean_ns = (0 != report->iters) ? (total_ns / report->iters) : 0;
+    report->min_ns  = (0 != report->iters) ? report->min_ns : 0;
+    return selftest_retval;
+}
+
+/* "Private" Functions */
+// Fault in the heap
+static int32_t __prefault_gpio_heap(uint32_t heap_bytes)
+{
+    /// LOCALS ///
+    // The prefault return value
+    int32_t prefault_retval = 0;
+    // Block faulted in
+    void* block             = NULL;
+
+#ifdef __GLIBC__
+    // Freed memory stays in the heap and every allocation comes from it, not from a fresh mmap
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+#endif
+    if ((0 != heap_bytes) && (NULL == (block = malloc(heap_bytes))))
+    {
+        prefault_retval = EMALLOC;
+    }
+    else if (0 != heap_bytes)
+    {
+        // Every page is written, the heap then keeps them on free()
+        __touch_gpio_pages(block, heap_bytes);
+        free(block);
+    }
+    return prefault_retval;
+}
+// Fault in the stack
+static void __attribute__((noinline)) __prefault_gpio_stack(uint32_t stack_bytes)
+{
+    /// LOCALS ///
+    // Stack below this frame
+    volatile uint8_t* stack = (0 != stack_bytes) ? alloca(stack_bytes) : NULL;
+
+    if (NULL != stack)
+    {
+        __touch_gpio_pages(stack, stack_bytes);
+    }
+}
+// Write one byte of each page
+static void __touch_gpio_pages(volatile uint8_t* block,
+                               uint32_t num_bytes)
+{
+    /// LOCALS ///
+    // Page size
+    uint32_t page_size = (uint32_t) sysconf(_SC_PAGESIZE);
+    // Offset of the byte written
+    uint32_t offset    = 0;
+
+    for (offset = 0; offset < num_bytes; offset += page_size)
+    {
+        block[offset] = 0;
+    }
+    block[num_bytes - 1] = 0;
+}
+// Touch the register mapping
+static void __prefault_gpio_regs(void)
+{
+    if (0 == __gpio_regs_retval())
+    {
+        // A read faults the page in, a write then takes any fault of the first store. Writing 0 to
+        // GPSET0 changes no pin.
+        (void) gpio_reg_read((volatile uint32_t *)(gpio_chip._base + GPLEV0_OFF));
+        gpio_reg_write((volatile uint32_t *)(gpio_chip._base + GPSET0_OFF), 0);
+    }
+}
@@ -0,0 +1,312 @@
+#include <gpiod_sim.h>
+#ifdef GPIOD_SIM
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <gpiod.h>
+#include <gpiod_internals.h>
+#include <gpio_addressing.h>
+
+/// GLOBALS ///
+// Number of 32-bit registers in the GPIO block
+#define SIM_NUM_REGS (GPIO_ADDR_RANGE_SIZE / GPIO_REG_SIZE)
+// Size of a 32-bit int 
+static const uint8_t BIT32_SIZE     = 32;
+// Base 10 const
+static const uint8_t BASE_TEN       = 10;
+// Three bit mask
+static const uint8_t THREE_BIT_MASK = 0x07;
+// Every pin of the chip as a 64-bit pin word
+static const uint64_t SIM_ALL_PINS  = (GPIO_PIN_BIT(GPIO_PIN_MAX) << 1) - 1;
+// Serializes the model, accesses may come from the poller thread as well
+static pthread_mutex_t sim_lock     = PTHREAD_MUTEX_INITIALIZER;
+// Backing store of the read/write registers (FSEL, enables, PUP_PDN)
+static uint32_t sim_regs[SIM_NUM_REGS];
+// Hidden output latch, written through GPSET/GPCLR
+static uint64_t sim_latch           = 0x00;
+// Injected external levels
+static uint64_t sim_inputs          = 0x00;
+// Event detect status
+static uint64_t sim_eds             = 0x00;
+// Current pin levels
+static uint64_t sim_levels          = 0x00;
+// Access log, its length and the accesses logged, NULL when not logging
+static gpio_sim_access_t* sim_log   = NULL;
+static uint32_t sim_log_size        = 0;
+static uint32_t sim_log_len         = 0;
+
+/// FUNCTION DECLARATIONS ///
+/* Writable bits of the register at an offset, 0 for reserved offsets */
+static uint32_t __sim_reg_mask(uint32_t);
+/* Register pair starting at the bank 0 offset, as a 64-bit pin word */
+static uint64_t __sim_reg_pair(uint32_t);
+/* Pins whose function is OUTPUT */
+static uint64_t __sim_output_pins(void);
+/* Recompute the pin levels and latch any detected events */
+static void __sim_update(void);
+/* Offset of a register pointer in the register file, or -1 when it is not a simulated register */
+static int32_t __sim_offset(volatile uint32_t *);
+/* Log one access, if logging */
+static void __sim_log_access(uint32_t, uint32_t, bool);
+
+/// FUNCTION DEFINITIONS ///
+/* "Public" Functions */
+// Reset the simulator
+void gpio_sim_reset(void)
+{
+    pthread_mutex_lock(&sim_lock);
+    memset(sim_regs, 0, sizeof(sim_regs));
+    sim_latch  = 0x00;
+    sim_inputs = 0x00;
+    sim_eds    = 0x00;
+    sim_levels = 0x00;
+    pthread_mutex_unlock(&sim_lock);
+}
+// Drive external levels
+void gpio_sim_set_inputs(uint64_t levels,
+                         uint64_t mask)
+{
+    pthread_mutex_lock(&sim_lock);
+    sim_inputs = ((sim_inputs & ~mask) | (levels & mask)) & SIM_ALL_PINS;
+    __sim_update();
+    pthread_mutex_unlock(&sim_lock);
+}
+// Log register accesses
+void gpio_sim_log(gpio_sim_access_t* log,
+                  uint32_t log_size)
+{
+    pthread_mutex_lock(&sim_lock);
+    sim_log      = log;
+    sim_log_size = (NULL != log) ? log_size : 0;
+    sim_log_len  = 0;
+    pthread_mutex_unlock(&sim_lock);
+}
+// Accesses logged
+uint32_t gpio_sim_logged(void)
+{
+    /// LOCALS ///
+    // Accesses logged
+    uint32_t logged = 0;
+
+    pthread_mutex_lock(&sim_lock);
+    logged = sim_log_len;
+    pthread_mutex_unlock(&sim_lock);
+    return logged;
+}
+// Levels of the output pins
+uint64_t gpio_sim_get_outputs(void)
+{
+    /// LOCALS ///
+    // Output levels
+    uint64_t outputs = 0x00;
+
+    pthread_mutex_lock(&sim_lock);
+    outputs = sim_latch & __sim_output_pins();
+    pthread_mutex_unlock(&sim_lock);
+    return outputs;
+}
+// Simulated register read
+uint32_t gpio_sim_read(volatile uint32_t* reg)
+{
+    /// LOCALS ///
+    // Offset of the register
+    int32_t reg_off    = __sim_offset(reg);
+    // Value read
+    uint32_t reg_value = 0x00;
+
+    // Not a simulated register, plain load
+    if (-1 == reg_off)
+    {
+        return *reg;
+    }
+    pthread_mutex_lock(&sim_lock);
+    switch (reg_off)
+    {
+        // Write only, nothing to read back
+        case GPSET0_OFF: case GPSET1_OFF: case GPCLR0_OFF: case GPCLR1_OFF:
+            reg_value = 0x00;
+            break;
+        case GPLEV0_OFF:
+            reg_value = (uint32_t) sim_levels;
+            break;
+        case GPLEV1_OFF:
+            reg_value = (uint32_t) (sim_levels >> BIT32_SIZE);
+            break;
+        case GPEDS0_OFF:
+            reg_value = (uint32_t) sim_eds;
+            break;
+        case GPEDS1_OFF:
+            reg_value = (uint32_t) (sim_eds >> BIT32_SIZE);
+            break;
+        // Read/write registers, reserved bits read as 0
+        default:
+            reg_value = sim_regs[reg_off / GPIO_REG_SIZE] & __sim_reg_mask(reg_off);
+            break;
+    }
+    __sim_log_access((uint32_t) reg_off, reg_value, false);
+    pthread_mutex_unlock(&sim_lock);
+    return reg_value;
+}
+// Simulated register write
+void gpio_sim_write(volatile uint32_t* reg,
+                    uint32_t value)
+{
+    /// LOCALS ///
+    // Offset of the register
+    int32_t reg_off = __sim_offset(reg);
+
+    // Not a simulated register, plain store
+    if (-1 == reg_off)
+    {
+        *reg = value;
+        return;
+    }
+    pthread_mutex_lock(&sim_lock);
+    __sim_log_access((uint32_t) reg_off, value, true);
+    // Reserved bits are written as 0
+    value &= __sim_reg_mask(reg_off);
+    switch (reg_off)
+    {
+        // Writing a 1 sets/clears the latch bit, a 0 has no effect
+        case GPSET0_OFF:
+            sim_latch |= (uint64_t) value;
+            break;
+        case GPSET1_OFF:
+            sim_latch |= (uint64_t) value << BIT32_SIZE;
+            break;
+        case GPCLR0_OFF:
+            sim_latch &= ~((uint64_t) value);
+            break;
+        case GPCLR1_OFF:
+            sim_latch &= ~((uint64_t) value << BIT32_SIZE);
+            break;
+        // Read only
+        case GPLEV0_OFF: case GPLEV1_OFF:
+            break;
+        // Write 1 to clear
+        case GPEDS0_OFF:
+            sim_eds &= ~((uint64_t) value);
+            break;
+        case GPEDS1_OFF:
+            sim_eds &= ~((uint64_t) value << BIT32_SIZE);
+            break;
+        default:
+            sim_regs[reg_off / GPIO_REG_SIZE] = value;
+            break;
+    }
+    __sim_update();
+    pthread_mutex_unlock(&sim_lock);
+}
+
+/* "Private" Functions */
+// The register file the chip context points at
+void* __gpio_sim_regs(void)
+{
+    return (void *) sim_regs;
+}
+// Writable bits of a register
+static uint32_t __sim_reg_mask(uint32_t reg_off)
+{
+    /// LOCALS ///
+    // The register mask
+    uint32_t reg_mask = 0x00;
+
+    switch (reg_off)
+    {
+        // 3-bit mapped
+        case GPFN_SEL0_OFF: case GPFN_SEL1_OFF: case GPFN_SEL2_OFF: case GPFN_SEL3_OFF: case GPFN_SEL4_OFF:
+            reg_mask = GPREG0_4_3BIT_WRITE_MASK;
+            break;
+        case GPFN_SEL5_OFF:
+            reg_mask = GPREG5_3BIT_WRITE_MASK;
+            break;
+        // 2-bit mapped
+        case GP_PUP_PDN_CNTRL_REG0: case GP_PUP_PDN_CNTRL_REG1: case GP_PUP_PDN_CNTRL_REG2:
+            reg_mask = GPREG0_2_2BIT_WRITE_MASK;
+            break;
+        case GP_PUP_PDN_CNTRL_REG3:
+            reg_mask = GPREG3_2BIT_WRITE_MASK;
+            break;
+        // 1-bit mapped, bank 0
+        case GPSET0_OFF: case GPCLR0_OFF: case GPLEV0_OFF: case GPEDS0_OFF: case GPREN0_OFF: 
+        case GPFEN0_OFF: case GPHEN0_OFF: case GPLEN0_OFF: case GPAREN0_OFF: case GPAFEN0_OFF:
+            reg_mask = GPREG0_1BIT_WRITE_MASK;
+            break;
+        // 1-bit mapped, bank 1
+        case GPSET1_OFF: case GPCLR1_OFF: case GPLEV1_OFF: case GPEDS1_OFF: case GPREN1_OFF: 
+        case GPFEN1_OFF: case GPHEN1_OFF: case GPLEN1_OFF: case GPAREN1_OFF: case GPAFEN1_OFF:
+            reg_mask = GPREG1_1BIT_WRITE_MASK;
+            break;
+        // Reserved
+        default:
+            reg_mask = 0x00;
+            break;
+    }
+    return reg_mask;
+}
+// Register pair as a pin word
+static uint64_t __sim_reg_pair(uint32_t reg0_off)
+{
+    return (uint64_t) sim_regs[reg0_off / GPIO_REG_SIZE] | 
+           ((uint64_t) sim_regs[(reg0_off / GPIO_REG_SIZE) + 1] << BIT32_SIZE);
+}
+// Output pins
+static uint64_t __sim_output_pins(void)
+{
+    /// LOCALS ///
+    // Output pins
+    uint64_t out_pins = 0x00;
+    // Pin index
+    uint8_t pin       = 0;
+
+    for (pin = 0; pin <= GPIO_PIN_MAX; pin++)
+    {
+        if (OUTPUT == ((sim_regs[(GPFN_SEL0_OFF / GPIO_REG_SIZE) + (pin / BASE_TEN)] >> 
+                        ((pin % BASE_TEN) * 3)) & THREE_BIT_MASK))
+        {
+            out_pins |= GPIO_PIN_BIT(pin);
+        }
+    }
+    return out_pins;
+}
+// Recompute the levels
+static void __sim_update(void)
+{
+    /// LOCALS ///
+    // Pins driven by the latch
+    uint64_t out_pins   = __sim_output_pins();
+    // New levels
+    uint64_t new_levels = ((sim_latch & out_pins) | (sim_inputs & ~out_pins)) & SIM_ALL_PINS;
+    // Pins that went high
+    uint64_t rising     = new_levels & ~sim_levels;
+    // Pins that went low
+    uint64_t falling    = sim_levels & ~new_levels;
+
+    sim_eds |= (rising  & (__sim_reg_pair(GPREN0_OFF) | __sim_reg_pair(GPAREN0_OFF))) |
+               (falling & (__sim_reg_pair(GPFEN0_OFF) | __sim_reg_pair(GPAFEN0_OFF))) |
+               (new_levels  & __sim_reg_pair(GPHEN0_OFF)) |
+               (~new_levels & __sim_reg_pair(GPLEN0_OFF) & SIM_ALL_PINS);
+    sim_levels = new_levels;
+}
+// Register offset
+static int32_t __sim_offset(volatile uint32_t* reg)
+{
+    /// LOCALS ///
+    // Offset in bytes from the register file
+    intptr_t reg_off = (intptr_t) ((volatile uint8_t *) reg - (volatile uint8_t *) sim_regs);
+
+    return ((0 <= reg_off) && (reg_off < (intptr_t) sizeof(sim_regs))) ? (int32_t) reg_off : -1;
+}
+// Log an access, called with the model lock held
+static void __sim_log_access(uint32_t reg_off,
+                             uint32_t value,
+                             bool write)
+{
+    if (sim_log_len < sim_log_size)
+    {
+        sim_log[sim_log_len].offset  = reg_off;
+        sim_log[sim_log_len].value   = value;
+        sim_log[sim_log_len++].write = write;
+    }
+}
+#endif
@@ -0,0 +1,170 @@
+#include <stddef.h>
+#include <gpiod.h>
+#include <gpiod_spi.h>
+#include <gpiod_internals.h>
+#include <gpiod_time.h>
+
+/// GLOBALS ///
+// Bits per transferred byte
+static const uint8_t BYTE_BITS = 8;
+
+/// FUNCTION DECLARATIONS ///
+/* Wait half a clock period */
+static inline void __spi_half_period(const gpio_spi_t *);
+/* Sample MISO */
+static inline uint8_t __spi_sample(const gpio_spi_t *);
+
+/// FUNCTION DEFINITIONS ///
+/* "Public" Functions */
+// Initialize a SPI master
+int32_t init_gpio_spi(gpio_spi_t* spi,
+                      gpio_line_t* cs,
+                      gpio_line_t* sclk,
+                      gpio_line_t* mosi,
+                      gpio_line_t* miso,
+                      enum SpiMode mode,
+                      uint32_t half_period_ns)
+{
+    /// LOCALS ///
+    // The init return value
+    int32_t init_retval = 0;
+    // Data bit
+    uint64_t mosi_bit   = 0x00;
+    // Data bit and clock level index
+    uint8_t data_ind    = 0;
+    uint8_t clk_ind     = 0;
+
+    // Directions are validated here, once
+    if ((NULL == sclk) || (NULL == sclk->priv_dat) || ((NULL != cs) && (NULL == cs->priv_dat)) ||
+        ((NULL != mosi) && (NULL == mosi->priv_dat)) || ((NULL != miso) && (NULL == miso->priv_dat)))
+    {
+        init_retval = EPDAT_NULL;
+    }
+    // Bits are clocked with register stores
+    else if (NULL == sclk->priv_dat->_base)
+    {
+        init_retval = EBACKEND;
+    }
+    else if ((OUTPUT != __get_gpio_fn(sclk->priv_dat)) ||
+             ((NULL != cs) && (OUTPUT != __get_gpio_fn(cs->priv_dat))) ||
+             ((NULL != mosi) && (OUTPUT != __get_gpio_fn(mosi->priv_dat))) ||
+             ((NULL != miso) && (INPUT != __get_gpio_fn(miso->priv_dat))))
+    {
+        init_retval = EPIN_CONFIG;
+    }
+    else if (mode > SPI_MODE_3)
+    {
+        init_retval = EOUT_OF_RANGE;
+    }
+    else
+    {
+        spi->_base           = gpio_chip._base;
+        spi->_cpol           = (mode >> 1) & 0x01;
+        spi->_cpha           = mode & 0x01;
+        spi->_half_period_ns = half_period_ns;
+        spi->_cs_bit         = (NULL != cs) ? GPIO_PIN_BIT(cs->priv_dat->_pin_value) : 0x00;
+        spi->_miso_reg       = (NULL != miso) ? __gpio_bank_reg(miso->priv_dat, GPLEV0_OFF) : NULL;
+        spi->_miso_shift     = (NULL != miso) ? gpio_pin_desc[miso->priv_dat->_pin_value]._bank_shift : 0;
+        spi->_sclk_bit       = GPIO_PIN_BIT(sclk->priv_dat->_pin_value);
+        mosi_bit             = (NULL != mosi) ? GPIO_PIN_BIT(mosi->priv_dat->_pin_value) : 0x00;
+        // Every data bit and clock level combination, so a bit never computes a mask
+        for (data_ind = 0; data_ind < 2; data_ind++)
+        {
+            for (clk_ind = 0; clk_ind < 2; clk_ind++)
+            {
+                spi->_set_masks[data_ind][clk_ind] = (data_ind ? mosi_bit : 0x00) | (clk_ind ? spi->_sclk_bit : 0x00);
+                spi->_clr_masks[data_ind][clk_ind] = (data_ind ? 0x00 : mosi_bit) | (clk_ind ? 0x00 : spi->_sclk_bit);
+            }
+        }
+        // Park the clock at its idle level and deselect
+        __write_gpio_masks(spi->_base, (spi->_cpol ? spi->_sclk_bit : 0x00) | spi->_cs_bit, spi->_cpol ? 0x00 : spi->_sclk_bit);
+    }
+    return init_retval;
+}
+// Transfer a buffer
+int32_t transfer_gpio_spi(gpio_spi_t* spi,
+                          const uint8_t* tx,
+                          uint8_t* rx,
+                          uint32_t len)
+{
+    /// LOCALS ///
+    // The transfer return value
+    int32_t xfer_retval = 0;
+    // Idle and active clock levels
+    uint8_t idle      = spi->_cpol;
+    uint8_t active    = spi->_cpol ^ 0x01;
+    // Byte sent and received
+    uint8_t tx_byte   = 0x00;
+    uint8_t rx_byte   = 0x00;
+    // Data bit sent
+    uint8_t data_bit  = 0;
+    // Byte and bit index
+    uint32_t byte_ind = 0;
+    uint8_t bit_ind   = 0;
+
+    // Check the master was initialized
+    if (NULL == spi->_base)
+    {
+        xfer_retval = EPDAT_NULL;
+    }
+    else
+    {
+        // Select
+        __write_gpio_masks(spi->_base, 0x00, spi->_cs_bit);
+        for (byte_ind = 0; byte_ind < len; byte_ind++)
+        {
+            tx_byte = (NULL != tx) ? tx[byte_ind] : 0x00;
+            rx_byte = 0x00;
+            for (bit_ind = 0; bit_ind < BYTE_BITS; bit_ind++)
+            {
+                data_bit = (tx_byte >> (BYTE_BITS - 1 - bit_ind)) & 0x01;
+                if (0 == spi->_cpha)
+                {
+                    // Data changes with the clock at idle (the trailing edge of the previous bit),
+                    // the slave samples on the leading edge and so do we
+                    __write_gpio_masks(spi->_base, spi->_set_masks[data_bit][idle], spi->_clr_masks[data_bit][idle]);
+                    __spi_half_period(spi);
+                    __write_gpio_masks(spi->_base, spi->_set_masks[data_bit][active], spi->_clr_masks[data_bit][active]);
+                    rx_byte = (rx_byte << 1) | __spi_sample(spi);
+                    __spi_half_period(spi);
+                }
+                else
+                {
+                    // Data changes on the leading edge, both sides sample on the trailing edge
+                    __write_gpio_masks(spi->_base, spi->_set_masks[data_bit][active], spi->_clr_masks[data_bit][active]);
+                    __spi_half_period(spi);
+                    __write_gpio_masks(spi->_base, spi->_set_masks[data_bit][idle], spi->_clr_masks[data_bit][idle]);
+                    rx_byte = (rx_byte << 1) | __spi_sample(spi);
+                    __spi_half_period(spi);
+                }
+            }
+            if (NULL != rx)
+            {
+                rx[byte_ind] = rx_byte;
+            }
+        }
+        // Modes 0 and 2 leave the clock at its active level after the last bit, return it to idle
+        if (0 == spi->_cpha)
+        {
+            __write_gpio_masks(spi->_base, idle ? spi->_sclk_bit : 0x00, idle ? 0x00 : spi->_sclk_bit);
+        }
+        // Deselect
+        __write_gpio_masks(spi->_base, spi->_cs_bit, 0x00);
+    }
+    return xfer_retval;
+}
+
+/* "Private" Functions */
+// Wait half a clock period
+static inline void __spi_half_period(const gpio_spi_t* spi)
+{
+    if (0 != spi->_half_period_ns)
+    {
+        gpio_delay_ns(spi->_half_period_ns);
+    }
+}
+// Sample MISO
+static inline uint8_t __spi_sample(const gpio_spi_t* spi)
+{
+    return (NULL != spi->_miso_reg) ? ((gpio_reg_read(spi->_miso_reg) >> spi->_miso_shift) & 0x01) : 0x00;
+}
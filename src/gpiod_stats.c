@@ -0,0 +1,220 @@
+#ifdef GPIOD_STATS
+#define _GNU_SOURCE
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <gpiod.h>
+#include <gpiod_stats.h>
+#include <gpiod_internals.h>
+
+/// GLOBALS ///
+// Tid of the slot shared by the threads that found no free slot
+static const uint64_t STATS_SHARED_TID    = UINT64_MAX;
+// Counters in a slot, all of them 64-bit
+static const uint32_t STATS_SLOT_COUNTERS = (GPIO_STATS_LINES * sizeof(gpio_stats_line_t)) / sizeof(uint64_t);
+// The segment, NULL until created
+static gpio_stats_segment_t* gpio_stats = NULL;
+// Name of the segment
+static char gpio_stats_name[32];
+// Key whose destructor frees the slot of an exiting thread, and whether it was created
+static pthread_key_t gpio_stats_key;
+static bool gpio_stats_key_valid = false;
+// Slot of the calling thread, NULL until its first operation
+static __thread gpio_stats_slot_t* gpio_stats_slot = NULL;
+// Whether the calling thread's slot is shared
+static __thread bool gpio_stats_shared = false;
+// Pid of this process, refreshed in a forked child so the hot path makes no system call
+static uint32_t gpio_stats_pid = 0;
+
+/// FUNCTION DECLARATIONS ///
+/* Claim a slot for the calling thread */
+static void __claim_gpio_stats_slot(gpio_stats_segment_t *);
+/* Move an exiting thread's counts to the retired counters and free its slot */
+static void __release_gpio_stats_slot(void *);
+/* Count one, with a plain store in an owned slot or an atomic add in the shared one */
+static inline void __inc_gpio_stat(uint64_t *);
+/* Remove the segment, at exit */
+static void __unlink_gpio_stats(void);
+/* In a forked child, take the new pid and drop the parent's slot */
+static void __fork_gpio_stats(void);
+
+/// FUNCTION DEFINITIONS ///
+/* "Private" Functions */
+// Create the stats segment
+void __open_gpio_stats(void)
+{
+    /// LOCALS ///
+    // Segment mapped
+    gpio_stats_segment_t* segment = MAP_FAILED;
+    // Descriptor of the segment
+    int32_t fd                    = -1;
+
+    // Created once, the segment outlives the chip context
+    if (NULL != gpio_stats)
+    {
+        return;
+    }
+    snprintf(gpio_stats_name, sizeof(gpio_stats_name), "%s%d", GPIO_STATS_SHM_PREFIX, (int) getpid());
+    // Without the key slots are never freed, a thread past the last free one shares
+    gpio_stats_key_valid = (0 == pthread_key_create(&gpio_stats_key, __release_gpio_stats_slot));
+    // A stale segment of a reused pid is started over. Without a segment nothing is counted.
+    if ((-1 != (fd = shm_open(gpio_stats_name, O_CREAT | O_TRUNC | O_RDWR | O_CLOEXEC, 0644))) &&
+        (0 == ftruncate(fd, sizeof(gpio_stats_segment_t))) &&
+        (MAP_FAILED != (segment = mmap(NULL, sizeof(gpio_stats_segment_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0))))
+    {
+        segment->pid      = (uint32_t) getpid();
+        segment->slots    = GPIO_STATS_SLOTS;
+        segment->lines    = GPIO_STATS_LINES;
+        segment->ops      = STAT_OPS;
+        segment->errors   = GPIO_STATS_ERRORS;
+        segment->hist_sz  = GPIO_STATS_HIST_SZ;
+        segment->claimed  = 0;
+        segment->start_ns = gpio_time_ns();
+        segment->version  = GPIO_STATS_VERSION;
+        // Readers check the magic last, once the layout is filled in
+        __atomic_store_n(&segment->magic, GPIO_STATS_MAGIC, __ATOMIC_RELEASE);
+        gpio_stats_pid = segment->pid;
+        atexit(__unlink_gpio_stats);
+        pthread_atfork(NULL, NULL, __fork_gpio_stats);
+        __atomic_store_n(&gpio_stats, segment, __ATOMIC_RELEASE);
+    }
+    else if (-1 != fd)
+    {
+        shm_unlink(gpio_stats_name);
+    }
+    if (-1 != fd)
+    {
+        close(fd);
+    }
+}
+// Count one operation
+void __record_gpio_stat(uint8_t line_ind,
+                        enum GpioStatOp op,
+                        int32_t retval,
+                        uint64_t start_ns)
+{
+    /// LOCALS ///
+    // Latency of the operation
+    uint64_t latency_ns            = gpio_time_ns() - start_ns;
+    // The segment
+    gpio_stats_segment_t* segment  = __atomic_load_n(&gpio_stats, __ATOMIC_ACQUIRE);
+    // Counters of the line in the thread's slot
+    gpio_stats_line_t* counters    = NULL;
+    // Latency bucket
+    uint32_t bucket                = (0 == latency_ns) ? 0 : (64 - __builtin_clzll(latency_ns));
+
+    // A forked child shares the mapping but not the counts
+    if ((NULL != segment) && (gpio_stats_pid == segment->pid))
+    {
+        if (NULL == gpio_stats_slot)
+        {
+            __claim_gpio_stats_slot(segment);
+        }
+        counters = &gpio_stats_slot->lines[line_ind];
+        __inc_gpio_stat(&counters->ops[op]);
+        __inc_gpio_stat(&counters->hist[op][(bucket < GPIO_STATS_HIST_SZ) ? bucket : (GPIO_STATS_HIST_SZ - 1)]);
+        if (0 > retval)
+        {
+            __inc_gpio_stat(&counters->errors[(-retval < GPIO_STATS_ERRORS) ? -retval : (GPIO_STATS_ERRORS - 1)]);
+        }
+    }
+}
+// Claim a slot
+static void __claim_gpio_stats_slot(gpio_stats_segment_t* segment)
+{
+    /// LOCALS ///
+    // Slot index
+    uint32_t slot_ind = 0;
+    // Tid of a free slot
+    uint64_t free_tid = 0;
+
+    __atomic_fetch_add(&segment->claimed, 1, __ATOMIC_RELAXED);
+    // First free slot, acquire pairs with the release of the thread that freed it and cleared its counts
+    for (slot_ind = 0; slot_ind < (GPIO_STATS_SLOTS - 1); slot_ind++)
+    {
+        free_tid = 0;
+        if (__atomic_compare_exchange_n(&segment->slot[slot_ind].tid, &free_tid, (uint64_t) gettid(), false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            break;
+        }
+    }
+    // Out of slots, share the last one
+    if (slot_ind >= (GPIO_STATS_SLOTS - 1))
+    {
+        gpio_stats_shared = true;
+        __atomic_store_n(&segment->slot[slot_ind].tid, STATS_SHARED_TID, __ATOMIC_RELAXED);
+    }
+    // The slot is freed when the thread exits
+    else if (gpio_stats_key_valid)
+    {
+        pthread_setspecific(gpio_stats_key, &segment->slot[slot_ind]);
+    }
+    gpio_stats_slot = &segment->slot[slot_ind];
+}
+// Free an exiting thread's slot
+static void __release_gpio_stats_slot(void* slot)
+{
+    /// LOCALS ///
+    // The segment
+    gpio_stats_segment_t* segment = __atomic_load_n(&gpio_stats, __ATOMIC_ACQUIRE);
+    // Counters of the slot and the retired counters, as flat arrays of the same layout
+    uint64_t* counters            = (uint64_t *) ((gpio_stats_slot_t *) slot)->lines;
+    uint64_t* retired             = (uint64_t *) segment->retired.lines;
+    // Counter index and count
+    uint32_t counter_ind          = 0;
+    uint64_t count                = 0;
+
+    // Added before it is cleared, a reader may count it twice meanwhile but never misses it
+    for (counter_ind = 0; counter_ind < STATS_SLOT_COUNTERS; counter_ind++)
+    {
+        if (0 != (count = __atomic_load_n(&counters[counter_ind], __ATOMIC_RELAXED)))
+        {
+            __atomic_fetch_add(&retired[counter_ind], count, __ATOMIC_RELAXED);
+            __atomic_store_n(&counters[counter_ind], 0, __ATOMIC_RELAXED);
+        }
+    }
+    gpio_stats_slot = NULL;
+    __atomic_store_n(&((gpio_stats_slot_t *) slot)->tid, 0, __ATOMIC_RELEASE);
+}
+// Count one
+static inline void __inc_gpio_stat(uint64_t* counter)
+{
+    // Only this thread writes an owned slot, a relaxed store keeps the reader from seeing a torn value
+    if (!gpio_stats_shared)
+    {
+        __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+    }
+    else
+    {
+        __atomic_fetch_add(counter, 1, __ATOMIC_RELAXED);
+    }
+}
+// Remove the segment
+static void __unlink_gpio_stats(void)
+{
+    // A forked child inherits the handler, only the creator removes the segment
+    if ((NULL != gpio_stats) && ((uint32_t) getpid() == gpio_stats->pid))
+    {
+        shm_unlink(gpio_stats_name);
+    }
+}
+// Leave the parent's counts in a forked child
+static void __fork_gpio_stats(void)
+{
+    gpio_stats_pid    = (uint32_t) getpid();
+    gpio_stats_slot   = NULL;
+    gpio_stats_shared = false;
+    // The forking thread's slot is the parent's, it is not freed when the child's thread exits
+    if (gpio_stats_key_valid)
+    {
+        pthread_setspecific(gpio_stats_key, NULL);
+    }
+}
+#endif
@@ -0,0 +1,181 @@
+#include <stddef.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <gpiod_time.h>
+
+/// GLOBALS ///
+#if defined(__aarch64__)
+// Sleep the counter is measured against the clock over
+static const uint64_t CALIBRATE_NS         = 10000000;
+// Counter/clock samples taken at each end of the sleep, the tightest is kept
+static const uint8_t CALIBRATE_SAMPLES     = 8;
+#endif
+// Reads timed for the read cost
+static const uint32_t CALIBRATE_READS      = 10000;
+// Delays timed for the error bound, and their length
+#define CALIBRATE_DELAYS 1000
+static const uint64_t CALIBRATE_DELAY_NS   = 1000;
+// The timebase, the clock until calibrated
+_gpio_timebase_t gpio_timebase             = { ._mult = 0, ._offset_ns = 0, ._source = TIME_SOURCE_CLOCK };
+// Calibration results
+static gpio_timebase_info_t gpio_timebase_info;
+// Calibration runs once
+static pthread_once_t gpio_timebase_once   = PTHREAD_ONCE_INIT;
+
+/// FUNCTION DECLARATIONS ///
+/* Measure the timebase, run once */
+static void __calibrate_gpio_timebase(void);
+/* Order overshoots for the percentile */
+static int __cmp_overshoot(const void *, const void *);
+/* CLOCK_MONOTONIC_RAW in nanoseconds */
+static uint64_t __clock_raw_ns(void);
+#if defined(__aarch64__)
+/* Counter and clock read together, the clock is taken between two counter reads and paired with their
+ * midpoint. Returns the width of the counter window, in ticks. */
+static uint64_t __sample_cntvct(uint64_t *, uint64_t *);
+/* Tightest of a few counter/clock samples */
+static void __best_sample_cntvct(uint64_t *, uint64_t *);
+#endif
+
+/// FUNCTION DEFINITIONS ///
+/* "Public" Functions */
+// Calibrate the timebase
+int32_t init_gpio_timebase(void)
+{
+    pthread_once(&gpio_timebase_once, __calibrate_gpio_timebase);
+    return 0;
+}
+// Calibration results
+int32_t get_gpio_timebase_info(gpio_timebase_info_t* info)
+{
+    init_gpio_timebase();
+    *info = gpio_timebase_info;
+    return 0;
+}
+
+/* "Private" Functions */
+// Measure the timebase
+static void __calibrate_gpio_timebase(void)
+{
+    /// LOCALS ///
+    // Clock resolution
+    struct timespec res_ts;
+    // Timing of the read cost and delay loops
+    uint64_t start_ns        = 0;
+    uint64_t end_ns          = 0;
+    // Sink for the timed reads
+    volatile uint64_t sink   = 0;
+    // Overshoot of each timed delay
+    uint32_t overshoot_ns[CALIBRATE_DELAYS];
+    // Loop index
+    uint32_t loop_ind        = 0;
+#if defined(__aarch64__)
+    // Sleep between the two samples
+    struct timespec sleep_ts = { .tv_sec = 0, .tv_nsec = (long) CALIBRATE_NS };
+    // Counter frequency advertised by the firmware, only checked for
+    uint64_t cntfrq          = 0;
+    // Counter and clock at both ends of the sleep
+    uint64_t ticks0          = 0;
+    uint64_t ticks1          = 0;
+    uint64_t clock0_ns       = 0;
+    uint64_t clock1_ns       = 0;
+
+    __asm__ __volatile__("mrs %0, cntfrq_el0" : "=r" (cntfrq));
+    // Without a frequency the counter may not be running, stay on the clock
+    if (0 != cntfrq)
+    {
+        __best_sample_cntvct(&ticks0, &clock0_ns);
+        nanosleep(&sleep_ts, NULL);
+        __best_sample_cntvct(&ticks1, &clock1_ns);
+        gpio_timebase._mult                = ((clock1_ns - clock0_ns) << 32) / (ticks1 - ticks0);
+        gpio_timebase._offset_ns           = clock1_ns - (uint64_t) (((unsigned __int128) ticks1 * gpio_timebase._mult) >> 32);
+        gpio_timebase_info.counter_hz      = ((ticks1 - ticks0) * 1000000000ULL) / (clock1_ns - clock0_ns);
+        gpio_timebase_info.resolution_ns   = (uint32_t) ((1000000000ULL + gpio_timebase_info.counter_hz - 1) /
+                                                         gpio_timebase_info.counter_hz);
+        gpio_timebase_info.source          = TIME_SOURCE_CNTVCT;
+        // The scale is complete before a reader can see the source
+        __atomic_store_n(&gpio_timebase._source, TIME_SOURCE_CNTVCT, __ATOMIC_RELEASE);
+    }
+#endif
+    if (TIME_SOURCE_CLOCK == gpio_timebase._source)
+    {
+        clock_getres(CLOCK_MONOTONIC_RAW, &res_ts);
+        gpio_timebase_info.source        = TIME_SOURCE_CLOCK;
+        gpio_timebase_info.counter_hz    = 0;
+        gpio_timebase_info.resolution_ns = (uint32_t) (((uint64_t) res_ts.tv_sec * 1000000000ULL) + (uint64_t) res_ts.tv_nsec);
+    }
+    // Cost of a read, averaged
+    start_ns = __clock_raw_ns();
+    for (loop_ind = 0; loop_ind < CALIBRATE_READS; loop_ind++)
+    {
+        sink ^= gpio_time_ns();
+    }
+    end_ns = __clock_raw_ns();
+    gpio_timebase_info.read_ns = (uint32_t) ((end_ns - start_ns) / CALIBRATE_READS);
+    // Overshoot of a short delay
+    for (loop_ind = 0; loop_ind < CALIBRATE_DELAYS; loop_ind++)
+    {
+        start_ns = gpio_time_ns();
+        gpio_delay_ns(CALIBRATE_DELAY_NS);
+        end_ns   = gpio_time_ns() - start_ns - CALIBRATE_DELAY_NS;
+        overshoot_ns[loop_ind] = (end_ns > UINT32_MAX) ? UINT32_MAX : (uint32_t) end_ns;
+    }
+    qsort(overshoot_ns, CALIBRATE_DELAYS, sizeof(overshoot_ns[0]), __cmp_overshoot);
+    gpio_timebase_info.delay_error_ns = overshoot_ns[(CALIBRATE_DELAYS * 99) / 100];
+    gpio_timebase_info.delay_max_ns   = overshoot_ns[CALIBRATE_DELAYS - 1];
+}
+// Order overshoots
+static int __cmp_overshoot(const void* lhs,
+                           const void* rhs)
+{
+    return (*(const uint32_t *) lhs > *(const uint32_t *) rhs) - (*(const uint32_t *) lhs < *(const uint32_t *) rhs);
+}
+// CLOCK_MONOTONIC_RAW
+static uint64_t __clock_raw_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000000ULL) + (uint64_t) ts.tv_nsec;
+}
+#if defined(__aarch64__)
+// Counter and clock read together
+static uint64_t __sample_cntvct(uint64_t* ticks,
+                                uint64_t* clock_ns)
+{
+    /// LOCALS ///
+    // Counter before and after the clock read
+    uint64_t before = 0;
+    uint64_t after  = 0;
+
+    __asm__ __volatile__("isb\n\tmrs %0, cntvct_el0" : "=r" (before) :: "memory");
+    *clock_ns = __clock_raw_ns();
+    __asm__ __volatile__("isb\n\tmrs %0, cntvct_el0" : "=r" (after) :: "memory");
+    *ticks = before + ((after - before) / 2);
+    return after - before;
+}
+// Tightest of a few samples
+static void __best_sample_cntvct(uint64_t* ticks,
+                                 uint64_t* clock_ns)
+{
+    /// LOCALS ///
+    // Sample taken and its window
+    uint64_t sample_ticks = 0;
+    uint64_t sample_ns    = 0;
+    uint64_t window       = 0;
+    // Tightest window so far
+    uint64_t best_window  = UINT64_MAX;
+    // Sample index
+    uint8_t sample_ind    = 0;
+
+    for (sample_ind = 0; sample_ind < CALIBRATE_SAMPLES; sample_ind++)
+    {
+        if ((window = __sample_cntvct(&sample_ticks, &sample_ns)) < best_window)
+        {
+            best_window = window;
+            *ticks      = sample_ticks;
+            *clock_ns   = sample_ns;
+        }
+    }
+}
+#endif
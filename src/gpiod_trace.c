@@ -0,0 +1,189 @@
+#ifdef GPIOD_TRACE
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <gpiod.h>
+#include <gpiod_trace.h>
+#include <gpiod_internals.h>
+
+/// GLOBALS ///
+// The buffer, NULL until the first start
+static gpio_trace_record_t* gpio_trace_buf = NULL;
+// Records the buffer holds
+static uint64_t gpio_trace_capacity        = 0;
+// Accesses claimed since the start, may exceed the capacity
+static uint64_t gpio_trace_claimed         = 0;
+// Accesses between their check of the armed flag and their record
+static uint32_t gpio_trace_in_flight       = 0;
+// Whether accesses are recorded
+static bool gpio_trace_armed               = false;
+// File the trace is saved to at exit when recording from the environment
+static char* gpio_trace_path               = NULL;
+
+/// FUNCTION DECLARATIONS ///
+/* Stop and save the environment trace, at exit */
+static void __save_gpio_trace_at_exit(void);
+
+/// FUNCTION DEFINITIONS ///
+/* "Public" Functions */
+// Start recording
+int32_t start_gpio_trace(uint32_t capacity)
+{
+    /// LOCALS ///
+    // Status of the call
+    int32_t start_retval             = 0;
+    // New buffer
+    gpio_trace_record_t* buf         = NULL;
+
+    if (0 == capacity)
+    {
+        start_retval = EOUT_OF_RANGE;
+    }
+    else if (NULL == (buf = malloc((size_t) capacity * sizeof(gpio_trace_record_t))))
+    {
+        start_retval = EMALLOC;
+    }
+    else
+    {
+        stop_gpio_trace();
+        // Touch every page now so that recording never faults one in
+        memset(buf, 0, (size_t) capacity * sizeof(gpio_trace_record_t));
+        free(gpio_trace_buf);
+        gpio_trace_buf      = buf;
+        gpio_trace_capacity = capacity;
+        gpio_trace_claimed  = 0;
+        // Release, an access that sees the trace armed sees the buffer
+        __atomic_store_n(&gpio_trace_armed, true, __ATOMIC_RELEASE);
+    }
+    return start_retval;
+}
+// Stop recording
+int32_t stop_gpio_trace(void)
+{
+    __atomic_store_n(&gpio_trace_armed, false, __ATOMIC_SEQ_CST);
+    // Accesses that saw the trace armed after entering finish their record, later ones see it stopped
+    while (0 != __atomic_load_n(&gpio_trace_in_flight, __ATOMIC_SEQ_CST))
+    {
+        sched_yield();
+    }
+    return 0;
+}
+// Records of the trace
+int32_t get_gpio_trace(const gpio_trace_record_t** records,
+                       uint64_t* count,
+                       uint64_t* dropped)
+{
+    /// LOCALS ///
+    // Status of the call
+    int32_t get_retval = 0;
+
+    if (__atomic_load_n(&gpio_trace_armed, __ATOMIC_ACQUIRE))
+    {
+        get_retval = ESTATE;
+    }
+    else
+    {
+        *records = gpio_trace_buf;
+        *count   = (gpio_trace_claimed < gpio_trace_capacity) ? gpio_trace_claimed : gpio_trace_capacity;
+        *dropped = gpio_trace_claimed - *count;
+    }
+    return get_retval;
+}
+// Save the trace
+int32_t save_gpio_trace(const char* path)
+{
+    /// LOCALS ///
+    // Status of the call
+    int32_t save_retval        = 0;
+    // Header of the file
+    gpio_trace_file_t header   = { .magic = GPIO_TRACE_MAGIC, .version = GPIO_TRACE_VERSION,
+                                   .record_size = sizeof(gpio_trace_record_t) };
+    // Records of the trace
+    const gpio_trace_record_t* records = NULL;
+    // The file
+    FILE* file                 = NULL;
+
+    // Nothing is written while still recording
+    save_retval = get_gpio_trace(&records, &header.count, &header.dropped);
+    if ((0 == save_retval) && (NULL == (file = fopen(path, "wb"))))
+    {
+        save_retval = EFILE_IO;
+    }
+    else if (0 == save_retval)
+    {
+        if ((1 != fwrite(&header, sizeof(header), 1, file)) ||
+            ((0 != header.count) && (header.count != fwrite(records, sizeof(gpio_trace_record_t), header.count, file))))
+        {
+            save_retval = EFILE_IO;
+        }
+        if (0 != fclose(file))
+        {
+            save_retval = EFILE_IO;
+        }
+    }
+    return save_retval;
+}
+
+/* "Private" Functions */
+// Start recording from the environment
+void __open_gpio_trace(void)
+{
+    /// LOCALS ///
+    // File named by the environment
+    const char* path = getenv(GPIO_TRACE_ENV);
+
+    // Started once, the trace spans every open of the chip
+    if ((NULL != gpio_trace_path) || (NULL == path) || ('\0' == path[0]))
+    {
+        return;
+    }
+    if ((NULL != (gpio_trace_path = strdup(path))) && (0 == start_gpio_trace(GPIO_TRACE_DEFAULT_RECORDS)))
+    {
+        atexit(__save_gpio_trace_at_exit);
+    }
+}
+// Record one register access
+void __trace_gpio_reg(enum GpioTraceOp op,
+                      volatile uint32_t* reg,
+                      uint32_t value)
+{
+    /// LOCALS ///
+    // Record claimed
+    uint64_t record_ind          = 0;
+    // Offset of the register
+    uintptr_t offset             = 0;
+    // The record
+    gpio_trace_record_t* record  = NULL;
+
+    if (!__atomic_load_n(&gpio_trace_armed, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+    __atomic_fetch_add(&gpio_trace_in_flight, 1, __ATOMIC_SEQ_CST);
+    // Checked again once in flight, an access racing a stop either is waited for or records nothing
+    if (__atomic_load_n(&gpio_trace_armed, __ATOMIC_SEQ_CST) &&
+        ((record_ind = __atomic_fetch_add(&gpio_trace_claimed, 1, __ATOMIC_RELAXED)) < gpio_trace_capacity))
+    {
+        offset            = (uintptr_t) reg - (uintptr_t) gpio_chip._base;
+        record            = &gpio_trace_buf[record_ind];
+        record->ts_ns     = gpio_time_ns();
+        record->value     = value;
+        record->offset    = (offset < GPIO_ADDR_RANGE_SIZE) ? (uint16_t) offset : UINT16_MAX;
+        record->op        = (uint8_t) op;
+        record->_reserved = 0;
+    }
+    __atomic_fetch_sub(&gpio_trace_in_flight, 1, __ATOMIC_RELEASE);
+}
+// Stop and save the environment trace
+static void __save_gpio_trace_at_exit(void)
+{
+    stop_gpio_trace();
+    if (0 != save_gpio_trace(gpio_trace_path))
+    {
+        fprintf(stderr, "gpiod: could not save the register trace to %s\n", gpio_trace_path);
+    }
+}
+#endif
@@ -0,0 +1,255 @@
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gpiod.h>
+#include <gpiod_wave.h>
+#include <gpiod_internals.h>
+#include <gpiod_time.h>
+
+/// FUNCTION DECLARATIONS ///
+/* Order steps by the start time held in their delay while compiling */
+static int __cmp_wave_step(const void *, const void *);
+/* Swap a queued waveform in, retiring the one it replaces */
+static void __swap_gpio_wave(gpio_wave_player_t *);
+
+/// FUNCTION DEFINITIONS ///
+/* "Public" Functions */
+// Compile a waveform
+int32_t compile_gpio_wave(gpio_wave_t* wave,
+                          const gpio_wave_edge_t* edges,
+                          uint32_t num_edges,
+                          uint32_t period_ns,
+                          gpio_wave_step_t* steps,
+                          uint32_t capacity)
+{
+    /// LOCALS ///
+    // The compile return value
+    int32_t comp_retval = 0;
+    // Edge index
+    uint32_t edge_ind   = 0;
+    // Last step written
+    uint32_t step_ind   = 0;
+    // Pins the waveform drives
+    uint64_t pin_mask   = 0x00;
+
+    // One step per edge plus the step at time 0, and a loop that takes time
+    if ((NULL == steps) || (capacity < (num_edges + 1)) || (0 == period_ns))
+    {
+        comp_retval = EOUT_OF_RANGE;
+    }
+    // Every edge becomes a step at its time (held in delay_ns until the delays are worked out)
+    for (edge_ind = 0; (0 == comp_retval) && (edge_ind < num_edges); edge_ind++)
+    {
+        if (edges[edge_ind].pin > GPIO_PIN_MAX)
+        {
+            comp_retval = EBAD_PIN;
+        }
+        else
+        {
+            steps[edge_ind + 1].set_mask = (0 != edges[edge_ind].level) ? GPIO_PIN_BIT(edges[edge_ind].pin) : 0x00;
+            steps[edge_ind + 1].clr_mask = (0 != edges[edge_ind].level) ? 0x00 : GPIO_PIN_BIT(edges[edge_ind].pin);
+            steps[edge_ind + 1].delay_ns = edges[edge_ind].time_ns;
+        }
+    }
+    if (0 == comp_retval)
+    {
+        // Empty step at time 0, the first edges merge into it
+        steps[0].set_mask = 0x00;
+        steps[0].clr_mask = 0x00;
+        steps[0].delay_ns = 0;
+        qsort(&steps[1], num_edges, sizeof(steps[0]), __cmp_wave_step);
+        // Merge edges on the same instant into one step
+        for (edge_ind = 1; (0 == comp_retval) && (edge_ind <= num_edges); edge_ind++)
+        {
+            if (steps[edge_ind].delay_ns != steps[step_ind].delay_ns)
+            {
+                steps[++step_ind] = steps[edge_ind];
+            }
+            // A pin cannot be driven both ways at once
+            else if (0 != ((steps[step_ind].set_mask | steps[edge_ind].set_mask) & 
+                           (steps[step_ind].clr_mask | steps[edge_ind].clr_mask)))
+            {
+                comp_retval = EPIN_CONFIG;
+            }
+            else
+            {
+                steps[step_ind].set_mask |= steps[edge_ind].set_mask;
+                steps[step_ind].clr_mask |= steps[edge_ind].clr_mask;
+            }
+        }
+    }
+    // The last step runs to the end of the period
+    if ((0 == comp_retval) && (period_ns < steps[step_ind].delay_ns))
+    {
+        comp_retval = EOUT_OF_RANGE;
+    }
+    if (0 == comp_retval)
+    {
+        // Start times to delays
+        for (edge_ind = 0; edge_ind < step_ind; edge_ind++)
+        {
+            steps[edge_ind].delay_ns = steps[edge_ind + 1].delay_ns - steps[edge_ind].delay_ns;
+            pin_mask |= steps[edge_ind].set_mask | steps[edge_ind].clr_mask;
+        }
+        steps[step_ind].delay_ns = period_ns - steps[step_ind].delay_ns;
+        pin_mask |= steps[step_ind].set_mask | steps[step_ind].clr_mask;
+        wave->steps     = steps;
+        wave->num_steps = step_ind + 1;
+        wave->pin_mask  = pin_mask;
+    }
+    return comp_retval;
+}
+// Initialize a player
+int32_t init_gpio_wave_player(gpio_wave_player_t* player,
+                              gpio_bulk_t* bulk)
+{
+    /// LOCALS ///
+    // The init return value
+    int32_t init_retval = 0;
+
+    // Group must have been requested, the player stores to the registers
+    if (-1 != bulk->_fd)
+    {
+        init_retval = EBACKEND;
+    }
+    else if (NULL == bulk->_base)
+    {
+        init_retval = EPDAT_NULL;
+    }
+    else
+    {
+        player->_bulk   = bulk;
+        player->_active = NULL;
+        atomic_init(&player->_pending, NULL);
+        atomic_init(&player->_retired, NULL);
+        atomic_init(&player->_running, false);
+        memset(&player->_timing, 0, sizeof(player->_timing));
+    }
+    return init_retval;
+}
+// Queue a waveform
+int32_t queue_gpio_wave(gpio_wave_player_t* player,
+                        gpio_wave_t* wave)
+{
+    /// LOCALS ///
+    // The queue return value
+    int32_t queue_retval = 0;
+    // No waveform waiting
+    gpio_wave_t* pending = NULL;
+
+    // Pins were validated as outputs when the group was requested, the waveform must stay inside it
+    if (0 != (wave->pin_mask & ~player->_bulk->pin_mask))
+    {
+        queue_retval = EOUT_OF_RANGE;
+    }
+    // The player picks it up at its next loop boundary, replacing a waiting waveform would drop it
+    // out of the retire order
+    else if (!atomic_compare_exchange_strong_explicit(&player->_pending, &pending, wave,
+                                                      memory_order_release, memory_order_relaxed))
+    {
+        queue_retval = ETHREAD;
+    }
+    else
+    {
+        atomic_store(&player->_running, true);
+    }
+    return queue_retval;
+}
+// Play
+int32_t play_gpio_wave(gpio_wave_player_t* player,
+                       uint32_t loops)
+{
+    /// LOCALS ///
+    // The play return value
+    int32_t play_retval    = 0;
+    // Register base of the group
+    void* base             = player->_bulk->_base;
+    // Deadline of the next step
+    uint64_t deadline_ns   = 0;
+    // Time read while spinning
+    uint64_t now_ns        = 0;
+    // Loops played
+    uint32_t loop_ind      = 0;
+    // Step index
+    uint32_t step_ind      = 0;
+
+    __swap_gpio_wave(player);
+    memset(&player->_timing, 0, sizeof(player->_timing));
+    if (NULL == player->_active)
+    {
+        play_retval = EPDAT_NULL;
+    }
+    else
+    {
+        deadline_ns = gpio_time_ns();
+        while (atomic_load_explicit(&player->_running, memory_order_relaxed) && ((0 == loops) || (loop_ind < loops)))
+        {
+            for (step_ind = 0; step_ind < player->_active->num_steps; step_ind++)
+            {
+                // Steps are scheduled against absolute deadlines so errors do not accumulate
+                while ((now_ns = gpio_time_ns()) < deadline_ns)
+                {
+                }
+                __write_gpio_masks(base, player->_active->steps[step_ind].set_mask, player->_active->steps[step_ind].clr_mask);
+                player->_timing.steps++;
+                player->_timing.total_late_ns += now_ns - deadline_ns;
+                player->_timing.max_late_ns    = ((now_ns - deadline_ns) > player->_timing.max_late_ns) ? 
+                                                     (now_ns - deadline_ns) : player->_timing.max_late_ns;
+                deadline_ns += player->_active->steps[step_ind].delay_ns;
+                if (!atomic_load_explicit(&player->_running, memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            loop_ind++;
+            // Loop boundary
+            __swap_gpio_wave(player);
+        }
+    }
+    return play_retval;
+}
+// Stop
+int32_t stop_gpio_wave(gpio_wave_player_t* player)
+{
+    atomic_store(&player->_running, false);
+    return 0;
+}
+// Hand back a retired waveform
+gpio_wave_t* reclaim_gpio_wave(gpio_wave_player_t* player)
+{
+    return atomic_exchange_explicit(&player->_retired, NULL, memory_order_acquire);
+}
+// Timing report
+int32_t get_gpio_wave_timing(gpio_wave_player_t* player,
+                             gpio_wave_timing_t* timing)
+{
+    *timing = player->_timing;
+    return 0;
+}
+
+/* "Private" Functions */
+// Order steps by start time
+static int __cmp_wave_step(const void* lhs,
+                           const void* rhs)
+{
+    return (((const gpio_wave_step_t *) lhs)->delay_ns > ((const gpio_wave_step_t *) rhs)->delay_ns) -
+           (((const gpio_wave_step_t *) lhs)->delay_ns < ((const gpio_wave_step_t *) rhs)->delay_ns);
+}
+// Swap in a queued waveform
+static void __swap_gpio_wave(gpio_wave_player_t* player)
+{
+    /// LOCALS ///
+    // Waveform queued
+    gpio_wave_t* next_wave = atomic_exchange_explicit(&player->_pending, NULL, memory_order_acquire);
+
+    if (NULL != next_wave)
+    {
+        // Release, the player's last reads of the old steps come before the caller reuses them. A
+        // waveform queued again over itself keeps playing and is not retired.
+        if ((NULL != player->_active) && (next_wave != player->_active))
+        {
+            atomic_store_explicit(&player->_retired, player->_active, memory_order_release);
+        }
+        player->_active = next_wave;
+    }
+}
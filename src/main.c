@@ -1,15 +1,124 @@
 #include <stdio.h>
 #include <sys/mman.h>
 #include <gpiod.h>
+#include <gpiod_broker.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <signal.h>
 #include <stdbool.h>
 
+/*******************************************************************************/
+//
+// DESCRIPTION : GPIO broker daemon.
+//
+// USAGE       : target [--dev-mem | --gpiomem | --sim | --chardev PATH] [--socket PATH] [--mode OCTAL]
+//
+// DETAILS     : Opens the backend (/dev/mem by default) and serves the pins to
+//               client processes until SIGINT or SIGTERM, see gpiod_broker.h. The
+//               socket is created with the given mode, 0660 by default, so clients
+//               only need access to it. On exit the number of write commands and
+//               the SET/CLR flushes they were merged into are printed.
+//
+/*******************************************************************************/
+
+/// GLOBALS ///
+// Mode of the socket when none is given
+static const uint32_t BROKER_SOCKET_MODE = 0660;
+// The broker, stopped by the signal handler
+static gpio_broker_t broker;
+
+/// FUNCTION DECLARATIONS ///
+/* Stop the broker on SIGINT and SIGTERM */
+static void broker_on_signal(int);
+
+/// FUNCTION DEFINITIONS ///
 int main(int argc, char* argv[])
 {
     /// LOCALS ///
-    return 0;
+    // Backend opened, and the path of the character device
+    enum GpioBackend backend = BACKEND_DEV_MEM;
+    const char* chip_path    = NULL;
+    // Socket of the broker
+    const char* socket_path  = GPIO_BROKER_SOCKET_PATH;
+    // Mode of the socket
+    uint32_t socket_mode     = BROKER_SOCKET_MODE;
+    // Signal handling
+    struct sigaction action;
+    // Status of the setup
+    int32_t status           = 0;
+    // Argument index
+    int32_t arg_ind          = 0;
+
+    for (arg_ind = 1; arg_ind < argc; arg_ind++)
+    {
+        if (0 == strcmp(argv[arg_ind], "--dev-mem"))
+        {
+            backend = BACKEND_DEV_MEM;
+        }
+        else if (0 == strcmp(argv[arg_ind], "--gpiomem"))
+        {
+            backend = BACKEND_GPIOMEM;
+        }
+        else if (0 == strcmp(argv[arg_ind], "--sim"))
+        {
+            backend = BACKEND_SIM;
+        }
+        else if ((0 == strcmp(argv[arg_ind], "--chardev")) && (arg_ind + 1 < argc))
+        {
+            backend   = BACKEND_CHARDEV;
+            chip_path = argv[++arg_ind];
+        }
+        else if ((0 == strcmp(argv[arg_ind], "--socket")) && (arg_ind + 1 < argc))
+        {
+            socket_path = argv[++arg_ind];
+        }
+        else if ((0 == strcmp(argv[arg_ind], "--mode")) && (arg_ind + 1 < argc))
+        {
+            socket_mode = (uint32_t) strtoul(argv[++arg_ind], NULL, 8);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--dev-mem | --gpiomem | --sim | --chardev PATH] [--socket PATH] [--mode OCTAL]\n",
+                    argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (0 != (status = open_gpio_backend(backend, chip_path)))
+    {
+        fprintf(stderr, "gpiod broker: failed to open the backend (%d)\n", status);
+        return EXIT_FAILURE;
+    }
+    if (0 != (status = init_gpio_broker(&broker, socket_path, socket_mode)))
+    {
+        fprintf(stderr, "gpiod broker: cannot listen on %s (%d)\n", socket_path, status);
+        close_gpio_chip();
+        return EXIT_FAILURE;
+    }
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = broker_on_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    // Clients that vanish mid-handshake must not kill the broker
+    signal(SIGPIPE, SIG_IGN);
+
+    fprintf(stderr, "gpiod broker: serving on %s\n", socket_path);
+    run_gpio_broker(&broker);
+    fprintf(stderr, "gpiod broker: %llu commands, %llu writes stored in %llu SET/CLR flushes\n",
+            (unsigned long long) broker.commands, (unsigned long long) broker.writes,
+            (unsigned long long) broker.flushes);
+
+    release_gpio_broker(&broker);
+    close_gpio_chip();
+    return EXIT_SUCCESS;
+}
+// Stop the broker
+static void broker_on_signal(int signum)
+{
+    (void) signum;
+    stop_gpio_broker(&broker);
 }
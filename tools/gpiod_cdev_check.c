@@ -0,0 +1,223 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+#include <gpiod.h>
+#include <gpiod_event.h>
+
+/*******************************************************************************/
+//
+// DESCRIPTION : Check of BACKEND_CHARDEV against a gpio-sim chip.
+//
+// USAGE       : make cdev-check (as root, on a kernel with CONFIG_GPIO_SIM), which
+//               runs tools/gpiod_cdev_check.sh to create the chip and then
+//               gpiod_cdev_check /dev/gpiochipN /sys/devices/platform/gpio-sim.M/gpiochipN
+//
+// DETAILS     : Drives lines 0 to 5 of an eight line simulated chip through the
+//               library and reads back what the kernel and the simulator see: the
+//               sim_gpioN/value of the outputs, sim_gpioN/pull to drive the inputs,
+//               and GPIO_V2_GET_LINEINFO for the flags a line holds. Checks a single
+//               output and input with their bias, a bulk group written with one
+//               request that gives its lines back with their bias and levels, a group
+//               refused for mixed flags, and edge events with their levels. Prints one
+//               line per check and exits 1 if any fails.
+//
+/*******************************************************************************/
+
+/// GLOBALS ///
+// Output line, input line, the two lines of the group, the line of mixed flags and the edge line
+static const uint8_t CHECK_OUT_PIN   = 0;
+static const uint8_t CHECK_IN_PIN    = 1;
+static const uint8_t CHECK_BULK0_PIN = 2;
+static const uint8_t CHECK_BULK1_PIN = 3;
+static const uint8_t CHECK_MIXED_PIN = 4;
+static const uint8_t CHECK_EDGE_PIN  = 5;
+// Time for the simulator to deliver an edge, in microseconds
+static const uint32_t CHECK_SETTLE_US = 10000;
+// sysfs directory of the simulated chip
+static const char* check_sim_dir     = NULL;
+// Descriptor of the chip, for the line info
+static int32_t check_chip_fd         = -1;
+// Checks failed
+static uint32_t check_failures       = 0;
+
+/// FUNCTION DECLARATIONS ///
+/* Report one check */
+static void check(const char *, int);
+/* Level the simulator sees on a line, -1 when it cannot be read */
+static int32_t check_sim_value(uint8_t);
+/* Pull the simulator applies to a line, driving an input */
+static void check_sim_pull(uint8_t, const char *);
+/* Kernel flags of a line, 0 when they cannot be read */
+static uint64_t check_line_flags(uint8_t);
+
+/// FUNCTION DEFINITIONS ///
+int main(int argc,
+         char** argv)
+{
+    /// LOCALS ///
+    // Lines checked
+    gpio_line_t out_line;
+    gpio_line_t in_line;
+    gpio_line_t bulk_lines[2];
+    gpio_line_t mixed_lines[2];
+    gpio_line_t edge_line;
+    // Groups checked
+    gpio_bulk_t bulk;
+    gpio_bulk_t mixed;
+    // Events delivered
+    gpio_event_t events[4];
+    int32_t num_events = 0;
+
+    if (3 != argc)
+    {
+        fprintf(stderr, "usage: gpiod_cdev_check /dev/gpiochipN SIM_SYSFS_DIR, see tools/gpiod_cdev_check.sh\n");
+        return EXIT_FAILURE;
+    }
+    check_sim_dir = argv[2];
+    if ((-1 == (check_chip_fd = open(argv[1], O_RDWR | O_CLOEXEC))) ||
+        (0 != open_gpio_backend(BACKEND_CHARDEV, argv[1])) ||
+        (0 != request_gpio_line(&out_line, CHECK_OUT_PIN)) ||
+        (0 != request_gpio_line(&in_line, CHECK_IN_PIN)) ||
+        (0 != request_gpio_line(&bulk_lines[0], CHECK_BULK0_PIN)) ||
+        (0 != request_gpio_line(&bulk_lines[1], CHECK_BULK1_PIN)) ||
+        (0 != request_gpio_line(&mixed_lines[1], CHECK_MIXED_PIN)) ||
+        (0 != request_gpio_line(&edge_line, CHECK_EDGE_PIN)))
+    {
+        fprintf(stderr, "gpiod_cdev_check: cannot request the lines of %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    // A single output, seen by the simulator
+    check("a line switches to OUTPUT", 0 == set_gpio_fn(&out_line, OUTPUT));
+    check("the kernel holds the line as an output", 0 != (check_line_flags(CHECK_OUT_PIN) & GPIO_V2_LINE_FLAG_OUTPUT));
+    write_gpio(&out_line, 1);
+    check("a high write reaches the simulator", 1 == check_sim_value(CHECK_OUT_PIN));
+    check("an output reads back high", 1 == read_gpio(&out_line));
+    write_gpio(&out_line, 0);
+    check("a low write reaches the simulator", 0 == check_sim_value(CHECK_OUT_PIN));
+
+    // A single input, driven by the simulator and by its own bias
+    check("a line switches to INPUT", 0 == set_gpio_fn(&in_line, INPUT));
+    check_sim_pull(CHECK_IN_PIN, "pull-up");
+    check("an input reads a pulled up line high", 1 == read_gpio(&in_line));
+    check_sim_pull(CHECK_IN_PIN, "pull-down");
+    check("an input reads a pulled down line low", 0 == read_gpio(&in_line));
+    check("a pull up is accepted", 0 == set_gpio_pull(&in_line, PULL_UP));
+    check("the kernel holds the pull up", 0 != (check_line_flags(CHECK_IN_PIN) & GPIO_V2_LINE_FLAG_BIAS_PULL_UP));
+    check("the pull up drives the input high", 1 == read_gpio(&in_line));
+
+    // A group of two outputs with a pull up, written with one request and given back as it was
+    set_gpio_fn(&bulk_lines[0], OUTPUT);
+    set_gpio_fn(&bulk_lines[1], OUTPUT);
+    set_gpio_pull(&bulk_lines[0], PULL_UP);
+    set_gpio_pull(&bulk_lines[1], PULL_UP);
+    check("a group of lines with the same flags is requested", 0 == request_gpio_bulk(&bulk, bulk_lines, 2));
+    check("a group write is accepted",
+          0 == write_gpio_bulk(&bulk, GPIO_PIN_BIT(CHECK_BULK0_PIN), GPIO_PIN_BIT(CHECK_BULK0_PIN) | GPIO_PIN_BIT(CHECK_BULK1_PIN)));
+    check("a group write drives its first line high", 1 == check_sim_value(CHECK_BULK0_PIN));
+    check("a group write drives its second line low", 0 == check_sim_value(CHECK_BULK1_PIN));
+    check("the group keeps the pull up", 0 != (check_line_flags(CHECK_BULK0_PIN) & GPIO_V2_LINE_FLAG_BIAS_PULL_UP));
+    check("a line of a group refuses a reconfiguration", EPIN_CONFIG == set_gpio_pull(&bulk_lines[0], PULL_DOWN));
+    check("a group is released", 0 == release_gpio_bulk(&bulk));
+    check("a released line keeps its pull up", 0 != (check_line_flags(CHECK_BULK0_PIN) & GPIO_V2_LINE_FLAG_BIAS_PULL_UP));
+    check("a released line stays an output", 0 != (check_line_flags(CHECK_BULK0_PIN) & GPIO_V2_LINE_FLAG_OUTPUT));
+    check("a released line keeps its high level", 1 == check_sim_value(CHECK_BULK0_PIN));
+    check("a released line keeps its low level", 0 == check_sim_value(CHECK_BULK1_PIN));
+    check("a released line is written on its own again", (0 == write_gpio(&bulk_lines[0], 0)) && (0 == check_sim_value(CHECK_BULK0_PIN)));
+
+    // A group of lines with different bias is refused
+    mixed_lines[0] = bulk_lines[0];
+    set_gpio_fn(&mixed_lines[1], OUTPUT);
+    set_gpio_pull(&mixed_lines[1], PULL_NONE);
+    check("a group of lines with different flags is refused", EPIN_CONFIG == request_gpio_bulk(&mixed, mixed_lines, 2));
+    check("a refused group leaves its lines usable", 0 == write_gpio(&mixed_lines[1], 1));
+
+    // Edges of an input, with their levels
+    set_gpio_fn(&edge_line, INPUT);
+    check_sim_pull(CHECK_EDGE_PIN, "pull-down");
+    check("an input arms both edges", 0 == set_gpio_event(&edge_line, EVENT_RISING | EVENT_FALLING));
+    check("the armed line has an event descriptor", 0 <= get_gpio_event_fd(&edge_line));
+    check_sim_pull(CHECK_EDGE_PIN, "pull-up");
+    usleep(CHECK_SETTLE_US);
+    num_events = poll_gpio_events(events, 4);
+    check("a rising edge is delivered", (1 == num_events) && (CHECK_EDGE_PIN == events[0].pin) && (1 == events[0].level));
+    check_sim_pull(CHECK_EDGE_PIN, "pull-down");
+    usleep(CHECK_SETTLE_US);
+    num_events = poll_gpio_events(events, 4);
+    check("a falling edge is delivered", (1 == num_events) && (CHECK_EDGE_PIN == events[0].pin) && (0 == events[0].level));
+    check("nothing is left queued", 0 == poll_gpio_events(events, 4));
+    check("an output refuses edge detection", EPIN_CONFIG == set_gpio_event(&out_line, EVENT_RISING));
+
+    release_gpio_line(&edge_line);
+    release_gpio_line(&mixed_lines[1]);
+    release_gpio_line(&bulk_lines[1]);
+    release_gpio_line(&bulk_lines[0]);
+    release_gpio_line(&in_line);
+    release_gpio_line(&out_line);
+    close_gpio_chip();
+    close(check_chip_fd);
+    printf("gpiod_cdev_check: %u failed\n", check_failures);
+    return (0 == check_failures) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+// Report one check
+static void check(const char* what,
+                  int passed)
+{
+    printf("%s: %s\n", passed ? "ok  " : "FAIL", what);
+    check_failures += passed ? 0 : 1;
+}
+// Level seen by the simulator
+static int32_t check_sim_value(uint8_t offset)
+{
+    /// LOCALS ///
+    // Path of the attribute
+    char path[256];
+    // The attribute
+    FILE* attr    = NULL;
+    // Level read
+    int32_t value = -1;
+
+    snprintf(path, sizeof(path), "%s/sim_gpio%u/value", check_sim_dir, offset);
+    if (NULL != (attr = fopen(path, "r")))
+    {
+        value = (1 == fscanf(attr, "%d", &value)) ? value : -1;
+        fclose(attr);
+    }
+    return value;
+}
+// Drive a simulated input
+static void check_sim_pull(uint8_t offset,
+                           const char* pull)
+{
+    /// LOCALS ///
+    // Path of the attribute
+    char path[256];
+    // The attribute
+    FILE* attr = NULL;
+
+    snprintf(path, sizeof(path), "%s/sim_gpio%u/pull", check_sim_dir, offset);
+    if ((NULL == (attr = fopen(path, "w"))) || (EOF == fputs(pull, attr)))
+    {
+        fprintf(stderr, "gpiod_cdev_check: cannot write %s\n", path);
+    }
+    if (NULL != attr)
+    {
+        fclose(attr);
+    }
+}
+// Kernel flags of a line
+static uint64_t check_line_flags(uint8_t offset)
+{
+    /// LOCALS ///
+    // Line info
+    struct gpio_v2_line_info info;
+
+    memset(&info, 0, sizeof(info));
+    info.offset = offset;
+    return (0 == ioctl(check_chip_fd, GPIO_V2_GET_LINEINFO_IOCTL, &info)) ? info.flags : 0;
+}
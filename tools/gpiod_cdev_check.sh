@@ -0,0 +1,47 @@
+#!/bin/sh
+################################################################################
+#
+# DESCRIPTION : Runs gpiod_cdev_check against a gpio-sim chip.
+#
+# USAGE       : gpiod_cdev_check.sh PATH_TO_gpiod_cdev_check (make cdev-check)
+#
+# DETAILS     : Creates an eight line simulated chip through configfs, runs the
+#               check on it and removes the chip again, whatever the outcome.
+#               Needs root and a kernel with CONFIG_GPIO_SIM (the gpio-sim module
+#               is loaded if it is not built in).
+#
+################################################################################
+
+CHECK_BIN="$1"
+CONFIGFS=/sys/kernel/config
+SIM_DIR="$CONFIGFS/gpio-sim/gpiod-lib-check.$$"
+
+if [ -z "$CHECK_BIN" ] || [ ! -x "$CHECK_BIN" ]; then
+    echo "usage: $0 PATH_TO_gpiod_cdev_check" >&2
+    exit 1
+fi
+modprobe gpio-sim 2>/dev/null
+if [ ! -d "$CONFIGFS/gpio-sim" ] && ! grep -q " $CONFIGFS " /proc/mounts; then
+    mount -t configfs none "$CONFIGFS" || exit 1
+fi
+if [ ! -d "$CONFIGFS/gpio-sim" ]; then
+    echo "gpio-sim is not available, is CONFIG_GPIO_SIM set?" >&2
+    exit 1
+fi
+
+# Take the chip down and remove it on any exit
+cleanup()
+{
+    [ -f "$SIM_DIR/live" ] && echo 0 > "$SIM_DIR/live"
+    rmdir "$SIM_DIR/bank0" "$SIM_DIR" 2>/dev/null
+}
+trap cleanup EXIT
+trap 'exit 1' INT TERM
+
+mkdir "$SIM_DIR" "$SIM_DIR/bank0" || exit 1
+echo 8 > "$SIM_DIR/bank0/num_lines" || exit 1
+echo 1 > "$SIM_DIR/live" || exit 1
+CHIP_NAME="$(cat "$SIM_DIR/bank0/chip_name")"
+DEV_NAME="$(cat "$SIM_DIR/dev_name")"
+
+"$CHECK_BIN" "/dev/$CHIP_NAME" "/sys/devices/platform/$DEV_NAME/$CHIP_NAME"
@@ -0,0 +1,104 @@
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstddef>
+#include <gpiod.hpp>
+#include <gpiod.h>
+#include <gpiod_broker.h>
+#include <gpiod_capture.h>
+#include <gpiod_config.h>
+#include <gpiod_debounce.h>
+#include <gpiod_event.h>
+#include <gpiod_poller.h>
+#include <gpiod_pwm.h>
+#include <gpiod_regs.h>
+#include <gpiod_rt.h>
+#include <gpiod_sim.h>
+#include <gpiod_spi.h>
+#include <gpiod_stats.h>
+#include <gpiod_time.h>
+#include <gpiod_trace.h>
+#include <gpiod_wave.h>
+
+/*******************************************************************************/
+//
+// DESCRIPTION : C++ check of the public headers and of gpiod.hpp.
+//
+// USAGE       : make SIM=1 check
+//
+// DETAILS     : Includes every public header in a C++17 translation unit, so a
+//               C only construct in one of them fails the build, and checks at
+//               compile time that the shared memory segments keep the layout the
+//               C library gives them. Then drives Pin and PinGroup against the
+//               simulator and reads the results back through the C API. Prints
+//               one line per check and exits 1 if any fails.
+//
+/*******************************************************************************/
+
+/// GLOBALS ///
+// Segments shared with C code in another process keep the C layout
+static_assert(offsetof(gpio_broker_shm_t, _cmd_tail) == (2 * GPIO_CACHE_LINE), "broker segment layout changed");
+static_assert(offsetof(gpio_broker_shm_t, _async_errors) == (5 * GPIO_CACHE_LINE) + sizeof(uint64_t),
+              "broker segment layout changed");
+static_assert(sizeof(GPIO_ATOMIC(uint64_t)) == sizeof(uint64_t), "atomic members change size");
+// Pin of the single pin checks, and the pins of the group, one per bank
+static const uint8_t CHECK_PIN      = 5;
+static const uint8_t CHECK_GROUP0   = 17;
+static const uint8_t CHECK_GROUP1   = 45;
+// Checks failed
+static uint32_t check_failures      = 0;
+
+/// FUNCTION DECLARATIONS ///
+/* Report one check */
+static void check(const char *, bool);
+
+/// FUNCTION DEFINITIONS ///
+int main()
+{
+    /// LOCALS ///
+    // Levels snapshot
+    uint64_t levels = 0x00;
+
+    gpio_sim_reset();
+    {
+        // The chip context, held by the scope
+        gpiod::Chip chip(BACKEND_SIM);
+        // Pins checked
+        gpiod::Pin<CHECK_PIN> pin;
+        gpiod::PinGroup<CHECK_GROUP0, CHECK_GROUP1> group;
+
+        check("a Chip opens the simulator", 0 == chip.status());
+        check("a Pin takes the chip base", pin.valid() && group.valid());
+
+        // A single pin
+        pin.set_fn(OUTPUT);
+        check("Pin::set_fn() selects OUTPUT", OUTPUT == pin.get_fn());
+        pin.set();
+        check("Pin::set() drives the pin high", pin.read() && (0 != (gpio_sim_get_outputs() & GPIO_PIN_BIT(CHECK_PIN))));
+        pin.write(false);
+        check("Pin::write() drives the pin low", !pin.read());
+        pin.set_pull(PULL_UP);
+        check("Pin::set_pull() selects a pull up", PULL_UP == pin.get_pull());
+        pin.set_pull(PULL_DOWN);
+        check("Pin::set_pull() selects a pull down", PULL_DOWN == pin.get_pull());
+        check("Pin::set_pull() leaves the function select", OUTPUT == pin.get_fn());
+
+        // A group across both banks
+        group.set_fn(OUTPUT);
+        group.write(GPIO_PIN_BIT(CHECK_GROUP1));
+        read_gpio_levels(&levels);
+        check("PinGroup::write() drives both banks",
+              (0 == GPIO_PIN_LEVEL(levels, CHECK_GROUP0)) && (1 == GPIO_PIN_LEVEL(levels, CHECK_GROUP1)));
+        group.write<GPIO_PIN_BIT(CHECK_GROUP0)>();
+        check("PinGroup::write<>() drives both banks", GPIO_PIN_BIT(CHECK_GROUP0) == group.read());
+    }
+    printf("gpiod_cpp_check: %u failed\n", check_failures);
+    return (0 == check_failures) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+// Report one check
+static void check(const char* what,
+                  bool passed)
+{
+    printf("%s: %s\n", passed ? "ok  " : "FAIL", what);
+    check_failures += passed ? 0 : 1;
+}
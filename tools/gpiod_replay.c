@@ -0,0 +1,316 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <gpiod_trace.h>
+#include <gpio_addressing.h>
+
+/*******************************************************************************/
+//
+// DESCRIPTION : Replay of a register trace recorded with GPIOD_TRACE.
+//
+// USAGE       : gpiod_replay [-n LOOPS] TRACE [OTHER_TRACE]
+//
+// DETAILS     : Drives the accesses of the trace, in order and as fast as possible,
+//               against an in-memory register image: a write stores its value, a
+//               read loads the register. The image is plain memory, the register
+//               semantics (write-only SET/CLR, write-1-to-clear GPEDS) are not
+//               modelled, so it gives a deterministic workload and not the levels
+//               of the pins. The timing of LOOPS replays is printed with the
+//               registers written, their write counts and last values, and a hash
+//               of the write sequence. Given a second trace, its write sequence is
+//               compared with the first one: the program exits 1 and prints the
+//               first difference when they differ, so a change to the library can
+//               be checked for identical register effects. Read values and
+//               timestamps are not compared.
+//
+/*******************************************************************************/
+
+/// GLOBALS ///
+// Registers in the image
+#define REPLAY_NUM_REGS (GPIO_ADDR_RANGE_SIZE / GPIO_REG_SIZE)
+// FNV-1a parameters of the write sequence hash
+static const uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325ULL;
+static const uint64_t FNV_PRIME        = 0x100000001B3ULL;
+// Names of the registers, by word index
+static const char* REPLAY_REG_NAMES[REPLAY_NUM_REGS] = {
+    [GPFN_SEL0_OFF / GPIO_REG_SIZE] = "GPFSEL0", [GPFN_SEL1_OFF / GPIO_REG_SIZE] = "GPFSEL1",
+    [GPFN_SEL2_OFF / GPIO_REG_SIZE] = "GPFSEL2", [GPFN_SEL3_OFF / GPIO_REG_SIZE] = "GPFSEL3",
+    [GPFN_SEL4_OFF / GPIO_REG_SIZE] = "GPFSEL4", [GPFN_SEL5_OFF / GPIO_REG_SIZE] = "GPFSEL5",
+    [GPSET0_OFF / GPIO_REG_SIZE]    = "GPSET0",  [GPSET1_OFF / GPIO_REG_SIZE]    = "GPSET1",
+    [GPCLR0_OFF / GPIO_REG_SIZE]    = "GPCLR0",  [GPCLR1_OFF / GPIO_REG_SIZE]    = "GPCLR1",
+    [GPLEV0_OFF / GPIO_REG_SIZE]    = "GPLEV0",  [GPLEV1_OFF / GPIO_REG_SIZE]    = "GPLEV1",
+    [GPEDS0_OFF / GPIO_REG_SIZE]    = "GPEDS0",  [GPEDS1_OFF / GPIO_REG_SIZE]    = "GPEDS1",
+    [GPREN0_OFF / GPIO_REG_SIZE]    = "GPREN0",  [GPREN1_OFF / GPIO_REG_SIZE]    = "GPREN1",
+    [GPFEN0_OFF / GPIO_REG_SIZE]    = "GPFEN0",  [GPFEN1_OFF / GPIO_REG_SIZE]    = "GPFEN1",
+    [GPHEN0_OFF / GPIO_REG_SIZE]    = "GPHEN0",  [GPHEN1_OFF / GPIO_REG_SIZE]    = "GPHEN1",
+    [GPLEN0_OFF / GPIO_REG_SIZE]    = "GPLEN0",  [GPLEN1_OFF / GPIO_REG_SIZE]    = "GPLEN1",
+    [GPAREN0_OFF / GPIO_REG_SIZE]   = "GPAREN0", [GPAREN1_OFF / GPIO_REG_SIZE]   = "GPAREN1",
+    [GPAFEN0_OFF / GPIO_REG_SIZE]   = "GPAFEN0", [GPAFEN1_OFF / GPIO_REG_SIZE]   = "GPAFEN1",
+    [GP_PUP_PDN_CNTRL_REG0 / GPIO_REG_SIZE] = "GP_PUP_PDN_CNTRL_REG0",
+    [GP_PUP_PDN_CNTRL_REG1 / GPIO_REG_SIZE] = "GP_PUP_PDN_CNTRL_REG1",
+    [GP_PUP_PDN_CNTRL_REG2 / GPIO_REG_SIZE] = "GP_PUP_PDN_CNTRL_REG2",
+    [GP_PUP_PDN_CNTRL_REG3 / GPIO_REG_SIZE] = "GP_PUP_PDN_CNTRL_REG3",
+};
+// A loaded trace
+typedef struct replay_trace {
+    // Header of the file
+    gpio_trace_file_t header;
+    // The records
+    gpio_trace_record_t* records;
+} replay_trace_t;
+
+/// FUNCTION DECLARATIONS ///
+/* Load a trace file, prints why and returns -1 when it cannot */
+static int32_t replay_load(const char *, replay_trace_t *);
+/* Replay a trace LOOPS times, print the timing and effects, return the write sequence hash */
+static uint64_t replay_run(const char *, const replay_trace_t *, uint32_t);
+/* Compare the write sequences of two traces, print the first difference, 0 when identical */
+static int32_t replay_compare(const replay_trace_t *, const replay_trace_t *);
+/* Whether a record is an access of the image, records of foreign addresses are skipped */
+static inline int replay_in_image(const gpio_trace_record_t *);
+/* CLOCK_MONOTONIC_RAW in nanoseconds */
+static uint64_t replay_now_ns(void);
+
+/// FUNCTION DEFINITIONS ///
+int main(int argc, char* argv[])
+{
+    /// LOCALS ///
+    // Traces given
+    replay_trace_t trace = { .records = NULL };
+    replay_trace_t other = { .records = NULL };
+    // Replays of each trace
+    uint32_t loops       = 1;
+    // Exit status
+    int32_t status       = EXIT_SUCCESS;
+    // Option parsed
+    int opt              = 0;
+
+    while (-1 != (opt = getopt(argc, argv, "n:")))
+    {
+        if ('n' == opt)
+        {
+            loops = (uint32_t) strtoul(optarg, NULL, 0);
+        }
+        else
+        {
+            optind = argc + 1;
+            break;
+        }
+    }
+    if ((0 == loops) || (optind >= argc) || ((argc - optind) > 2))
+    {
+        fprintf(stderr, "usage: %s [-n LOOPS] TRACE [OTHER_TRACE]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if ((0 != replay_load(argv[optind], &trace)) ||
+        ((2 == (argc - optind)) && (0 != replay_load(argv[optind + 1], &other))))
+    {
+        return EXIT_FAILURE;
+    }
+    replay_run(argv[optind], &trace, loops);
+    if (NULL != other.records)
+    {
+        replay_run(argv[optind + 1], &other, loops);
+        if (0 != replay_compare(&trace, &other))
+        {
+            status = 1;
+        }
+        else
+        {
+            printf("write sequences identical\n");
+        }
+    }
+    free(trace.records);
+    free(other.records);
+    return status;
+}
+// Load a trace file
+static int32_t replay_load(const char* path,
+                           replay_trace_t* trace)
+{
+    /// LOCALS ///
+    // Status of the load
+    int32_t load_retval = -1;
+    // The file
+    FILE* file          = fopen(path, "rb");
+
+    if (NULL == file)
+    {
+        fprintf(stderr, "gpiod_replay: cannot open %s\n", path);
+    }
+    else if ((1 != fread(&trace->header, sizeof(trace->header), 1, file)) ||
+             (GPIO_TRACE_MAGIC != trace->header.magic) || (GPIO_TRACE_VERSION != trace->header.version) ||
+             (sizeof(gpio_trace_record_t) != trace->header.record_size))
+    {
+        fprintf(stderr, "gpiod_replay: %s is not a trace of this version\n", path);
+    }
+    else if (NULL == (trace->records = malloc((0 != trace->header.count ? trace->header.count : 1) *
+                                              sizeof(gpio_trace_record_t))))
+    {
+        fprintf(stderr, "gpiod_replay: cannot hold the %llu records of %s\n",
+                (unsigned long long) trace->header.count, path);
+    }
+    else if (trace->header.count != fread(trace->records, sizeof(gpio_trace_record_t), trace->header.count, file))
+    {
+        fprintf(stderr, "gpiod_replay: %s is truncated\n", path);
+    }
+    else
+    {
+        load_retval = 0;
+    }
+    if (NULL != file)
+    {
+        fclose(file);
+    }
+    return load_retval;
+}
+// Replay a trace
+static uint64_t replay_run(const char* path,
+                           const replay_trace_t* trace,
+                           uint32_t loops)
+{
+    /// LOCALS ///
+    // The register image
+    volatile uint32_t image[REPLAY_NUM_REGS];
+    // Writes per register
+    uint64_t writes[REPLAY_NUM_REGS];
+    // Sink of the reads
+    uint32_t sink              = 0;
+    // Accesses of the image and of foreign addresses
+    uint64_t accesses          = 0;
+    uint64_t foreign           = 0;
+    // Hash of the write sequence
+    uint64_t hash              = FNV_OFFSET_BASIS;
+    // Replay timing
+    uint64_t start_ns          = 0;
+    uint64_t elapsed_ns        = 0;
+    // The record replayed
+    const gpio_trace_record_t* record = NULL;
+    // Loop, record and register index
+    uint32_t loop_ind          = 0;
+    uint64_t record_ind        = 0;
+    uint32_t reg_ind           = 0;
+
+    memset(writes, 0, sizeof(writes));
+    start_ns = replay_now_ns();
+    for (loop_ind = 0; loop_ind < loops; loop_ind++)
+    {
+        for (reg_ind = 0; reg_ind < REPLAY_NUM_REGS; reg_ind++)
+        {
+            image[reg_ind] = 0;
+        }
+        for (record_ind = 0; record_ind < trace->header.count; record_ind++)
+        {
+            record = &trace->records[record_ind];
+            if (!replay_in_image(record))
+            {
+                // Foreign addresses are skipped
+            }
+            else if (TRACE_WRITE == record->op)
+            {
+                image[record->offset / GPIO_REG_SIZE] = record->value;
+            }
+            else
+            {
+                sink ^= image[record->offset / GPIO_REG_SIZE];
+            }
+        }
+    }
+    elapsed_ns = replay_now_ns() - start_ns;
+    // Effects, taken outside the timed loop
+    for (record_ind = 0; record_ind < trace->header.count; record_ind++)
+    {
+        record = &trace->records[record_ind];
+        if (!replay_in_image(record))
+        {
+            foreign++;
+        }
+        else
+        {
+            accesses++;
+            if (TRACE_WRITE == record->op)
+            {
+                writes[record->offset / GPIO_REG_SIZE]++;
+                hash = (hash ^ record->offset) * FNV_PRIME;
+                hash = (hash ^ record->value) * FNV_PRIME;
+            }
+        }
+    }
+    printf("%s: %llu accesses (%llu dropped while recording, %llu foreign), %u loops in %llu ns, "
+           "%.1f ns/access, write hash %016llx, read sink %08x\n",
+           path, (unsigned long long) accesses, (unsigned long long) trace->header.dropped,
+           (unsigned long long) foreign, loops, (unsigned long long) elapsed_ns,
+           (0 != accesses) ? ((double) elapsed_ns / ((double) accesses * loops)) : 0.0,
+           (unsigned long long) hash, sink);
+    for (reg_ind = 0; reg_ind < REPLAY_NUM_REGS; reg_ind++)
+    {
+        if (0 != writes[reg_ind])
+        {
+            printf("  %-22s %10llu writes, last 0x%08x\n",
+                   (NULL != REPLAY_REG_NAMES[reg_ind]) ? REPLAY_REG_NAMES[reg_ind] : "(reserved)",
+                   (unsigned long long) writes[reg_ind], image[reg_ind]);
+        }
+    }
+    return hash;
+}
+// Compare write sequences
+static int32_t replay_compare(const replay_trace_t* lhs,
+                              const replay_trace_t* rhs)
+{
+    /// LOCALS ///
+    // Position in each trace
+    uint64_t lhs_ind = 0;
+    uint64_t rhs_ind = 0;
+    // Writes matched so far
+    uint64_t matched = 0;
+
+    for (;;)
+    {
+        // Next write of each trace
+        while ((lhs_ind < lhs->header.count) &&
+               ((TRACE_WRITE != lhs->records[lhs_ind].op) || !replay_in_image(&lhs->records[lhs_ind])))
+        {
+            lhs_ind++;
+        }
+        while ((rhs_ind < rhs->header.count) &&
+               ((TRACE_WRITE != rhs->records[rhs_ind].op) || !replay_in_image(&rhs->records[rhs_ind])))
+        {
+            rhs_ind++;
+        }
+        if ((lhs_ind == lhs->header.count) && (rhs_ind == rhs->header.count))
+        {
+            return 0;
+        }
+        if ((lhs_ind == lhs->header.count) || (rhs_ind == rhs->header.count))
+        {
+            printf("write sequences differ: one trace ends after %llu matching writes\n", (unsigned long long) matched);
+            return -1;
+        }
+        if ((lhs->records[lhs_ind].offset != rhs->records[rhs_ind].offset) ||
+            (lhs->records[lhs_ind].value != rhs->records[rhs_ind].value))
+        {
+            printf("write sequences differ at write %llu: 0x%08x to offset 0x%02x against 0x%08x to offset 0x%02x\n",
+                   (unsigned long long) matched, lhs->records[lhs_ind].value, lhs->records[lhs_ind].offset,
+                   rhs->records[rhs_ind].value, rhs->records[rhs_ind].offset);
+            return -1;
+        }
+        matched++;
+        lhs_ind++;
+        rhs_ind++;
+    }
+}
+// Whether a record is an access of the image
+static inline int replay_in_image(const gpio_trace_record_t* record)
+{
+    return (record->offset < GPIO_ADDR_RANGE_SIZE) && (0 == (record->offset % GPIO_REG_SIZE));
+}
+// CLOCK_MONOTONIC_RAW
+static uint64_t replay_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000000ULL) + (uint64_t) ts.tv_nsec;
+}
@@ -0,0 +1,514 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <gpiod.h>
+#include <gpiod_sim.h>
+#include <gpiod_regs.h>
+#include <gpiod_time.h>
+#include <gpiod_capture.h>
+#include <gpiod_config.h>
+#include <gpiod_debounce.h>
+#include <gpiod_event.h>
+#include <gpio_addressing.h>
+
+/*******************************************************************************/
+//
+// DESCRIPTION : Self-check of the register simulator (BACKEND_SIM).
+//
+// USAGE       : make SIM=1 check
+//
+// DETAILS     : Drives the simulator through the library and the register
+//               accessors and checks the behaviour gpiod_sim.h documents: SET/CLR
+//               writes showing up on GPLEV, SET/CLR reading as 0 and ignoring 0
+//               bits, the function select gating the output latch onto the pin,
+//               edge and level detection in GPEDS with write-1-to-clear, and
+//               reserved bits dropped. Commits configuration transactions with the
+//               simulator logging the accesses: a read and a write for a partly
+//               staged register, a write alone for a fully staged one (GPFSEL5 and
+//               GP_PUP_PDN_CNTRL_REG3 by their narrower write masks), and function
+//               selects before pulls before detect enables. Runs the bit-sliced
+//               debouncer and a per-pin counter loop over the same bouncing stream,
+//               with thresholds from 1 to GPIO_DEBOUNCE_MAX changed midway, and
+//               compares them sample by sample. Then runs a capture over a small ring while a
+//               second thread toggles an input, wrapping the ring, and checks the
+//               times rebuilt from the records held against the times of the
+//               toggles, and resumes a capture after an idle gap longer than a record
+//               delta holds. Prints one line per check and exits 1 if any fails. Linked
+//               against the SIM build of the library only.
+//
+/*******************************************************************************/
+
+/// GLOBALS ///
+// Output pin in bank 0, output pin in bank 1, and the input pin of the detect checks
+static const uint8_t CHECK_OUT_PIN  = 5;
+static const uint8_t CHECK_OUT1_PIN = 45;
+static const uint8_t CHECK_IN_PIN   = 6;
+// Capture ring size, and toggles driven into it (it wraps), each CAPTURE_GAP_US apart
+#define CHECK_CAPTURE_RING    4
+#define CHECK_CAPTURE_TOGGLES 10
+static const uint32_t CHECK_CAPTURE_GAP_US = 2000;
+// Idle gap before the capture is resumed, over two record deltas, and the length of each run
+static const uint64_t CHECK_CAPTURE_IDLE_NS = 10000000000ULL;
+static const uint64_t CHECK_CAPTURE_RUN_NS  = 1000000;
+// Samples of the debounce check, its thresholds change halfway
+static const uint32_t CHECK_DEBOUNCE_SAMPLES = 20000;
+// Accesses logged by the configuration checks
+#define CHECK_LOG_SIZE 64
+static gpio_sim_access_t check_log[CHECK_LOG_SIZE];
+// Checks failed
+static uint32_t check_failures      = 0;
+// Capture of the wrap check, and the time just before each toggle (index 0 unused)
+static gpio_capture_t check_capture;
+static uint64_t check_toggle_ns[CHECK_CAPTURE_TOGGLES + 1];
+
+/// FUNCTION DECLARATIONS ///
+/* Report one check */
+static void check(const char *, int);
+/* A register of the chip mapping, by offset */
+static volatile uint32_t* check_reg(uint32_t);
+/* Commit configuration transactions, check the accesses made and their order */
+static void check_config_commit(void);
+/* Index of the first logged write to a register, -1 when there is none */
+static int32_t check_log_write(uint32_t);
+/* Compare the debouncer with a per-pin loop over a bouncing stream */
+static void check_debounce(void);
+/* Capture the toggles of the input pin through a ring that wraps, check the times held */
+static void check_capture_wrap(void);
+/* Resume a capture after a long idle gap, check the keep-alive records and the resumed delta */
+static void check_capture_resume(void);
+/* Thread toggling the input pin under the capture, then stopping it */
+static void* check_toggle_thread(void *);
+
+/// FUNCTION DEFINITIONS ///
+int main(void)
+{
+    /// LOCALS ///
+    // Lines checked
+    gpio_line_t out_line;
+    gpio_line_t out1_line;
+    gpio_line_t in_line;
+    // Levels snapshot
+    uint64_t levels = 0x00;
+
+    gpio_sim_reset();
+    if ((0 != open_gpio_backend(BACKEND_SIM, NULL)) ||
+        (0 != request_gpio_line(&out_line, CHECK_OUT_PIN)) ||
+        (0 != request_gpio_line(&out1_line, CHECK_OUT1_PIN)) ||
+        (0 != request_gpio_line(&in_line, CHECK_IN_PIN)))
+    {
+        fprintf(stderr, "gpiod_sim_check: cannot open the simulator, is this a SIM=1 build?\n");
+        return EXIT_FAILURE;
+    }
+
+    // SET/CLR reach GPLEV on an OUTPUT pin, in both banks
+    set_gpio_fn(&out_line, OUTPUT);
+    set_gpio_fn(&out1_line, OUTPUT);
+    write_gpio(&out_line, 1);
+    check("SET drives an output pin high on GPLEV0", 1 == read_gpio(&out_line));
+    check("SET shows in the simulator outputs", 0 != (gpio_sim_get_outputs() & GPIO_PIN_BIT(CHECK_OUT_PIN)));
+    write_gpio(&out_line, 0);
+    check("CLR drives an output pin low on GPLEV0", 0 == read_gpio(&out_line));
+    write_gpio(&out1_line, 1);
+    read_gpio_levels(&levels);
+    check("SET drives a bank 1 pin high on GPLEV1", 1 == GPIO_PIN_LEVEL(levels, CHECK_OUT1_PIN));
+    write_gpio(&out1_line, 0);
+    read_gpio_levels(&levels);
+    check("CLR drives a bank 1 pin low on GPLEV1", 0 == GPIO_PIN_LEVEL(levels, CHECK_OUT1_PIN));
+
+    // SET/CLR are write only and a 0 bit changes nothing
+    write_gpio(&out_line, 1);
+    check("GPSET0 reads as 0", 0 == gpio_reg_read(check_reg(GPSET0_OFF)));
+    check("GPCLR0 reads as 0", 0 == gpio_reg_read(check_reg(GPCLR0_OFF)));
+    gpio_reg_write(check_reg(GPCLR0_OFF), 0);
+    check("writing 0 to GPCLR0 leaves the pin high", 1 == read_gpio(&out_line));
+    gpio_reg_write(check_reg(GPLEV0_OFF), 0);
+    check("GPLEV0 ignores writes", 1 == read_gpio(&out_line));
+
+    // The function select gates the latch, an INPUT pin shows the external level
+    set_gpio_fn(&out_line, INPUT);
+    gpio_sim_set_inputs(0x00, GPIO_PIN_BIT(CHECK_OUT_PIN));
+    check("an INPUT pin ignores its high latch", 0 == read_gpio(&out_line));
+    check("an INPUT pin is not in the simulator outputs", 0 == (gpio_sim_get_outputs() & GPIO_PIN_BIT(CHECK_OUT_PIN)));
+    gpio_sim_set_inputs(GPIO_PIN_BIT(CHECK_OUT_PIN), GPIO_PIN_BIT(CHECK_OUT_PIN));
+    check("an INPUT pin follows the external level", 1 == read_gpio(&out_line));
+    // The latch still takes writes while the pin is an INPUT
+    gpio_reg_write(check_reg(GPCLR0_OFF), (uint32_t) GPIO_PIN_BIT(CHECK_OUT_PIN));
+    check("CLR of an INPUT pin leaves the external level", 1 == read_gpio(&out_line));
+    set_gpio_fn(&out_line, OUTPUT);
+    check("back to OUTPUT the pin shows the latch written while INPUT", 0 == read_gpio(&out_line));
+
+    // Rising edge detect, write-1-to-clear
+    set_gpio_fn(&in_line, INPUT);
+    gpio_sim_set_inputs(0x00, GPIO_PIN_BIT(CHECK_IN_PIN));
+    update_gpio_reg(GPREN0_OFF, (uint32_t) GPIO_PIN_BIT(CHECK_IN_PIN), (uint32_t) GPIO_PIN_BIT(CHECK_IN_PIN));
+    check("no event before the edge", 0 == (gpio_reg_read(check_reg(GPEDS0_OFF)) & GPIO_PIN_BIT(CHECK_IN_PIN)));
+    gpio_sim_set_inputs(GPIO_PIN_BIT(CHECK_IN_PIN), GPIO_PIN_BIT(CHECK_IN_PIN));
+    check("a rising edge sets GPEDS0", 0 != (gpio_reg_read(check_reg(GPEDS0_OFF)) & GPIO_PIN_BIT(CHECK_IN_PIN)));
+    gpio_reg_write(check_reg(GPEDS0_OFF), 0);
+    check("writing 0 to GPEDS0 keeps the event", 0 != (gpio_reg_read(check_reg(GPEDS0_OFF)) & GPIO_PIN_BIT(CHECK_IN_PIN)));
+    gpio_reg_write(check_reg(GPEDS0_OFF), (uint32_t) GPIO_PIN_BIT(CHECK_IN_PIN));
+    check("writing 1 to GPEDS0 clears the event", 0 == (gpio_reg_read(check_reg(GPEDS0_OFF)) & GPIO_PIN_BIT(CHECK_IN_PIN)));
+    gpio_sim_set_inputs(0x00, GPIO_PIN_BIT(CHECK_IN_PIN));
+    check("a falling edge does not set a rising detect", 0 == (gpio_reg_read(check_reg(GPEDS0_OFF)) & GPIO_PIN_BIT(CHECK_IN_PIN)));
+    update_gpio_reg(GPREN0_OFF, (uint32_t) GPIO_PIN_BIT(CHECK_IN_PIN), 0x00);
+
+    // High level detect re-asserts while the level holds
+    update_gpio_reg(GPHEN0_OFF, (uint32_t) GPIO_PIN_BIT(CHECK_IN_PIN), (uint32_t) GPIO_PIN_BIT(CHECK_IN_PIN));
+    gpio_sim_set_inputs(GPIO_PIN_BIT(CHECK_IN_PIN), GPIO_PIN_BIT(CHECK_IN_PIN));
+    gpio_reg_write(check_reg(GPEDS0_OFF), (uint32_t) GPIO_PIN_BIT(CHECK_IN_PIN));
+    check("a high level detect re-asserts after a clear", 0 != (gpio_reg_read(check_reg(GPEDS0_OFF)) & GPIO_PIN_BIT(CHECK_IN_PIN)));
+    gpio_sim_set_inputs(0x00, GPIO_PIN_BIT(CHECK_IN_PIN));
+    gpio_reg_write(check_reg(GPEDS0_OFF), (uint32_t) GPIO_PIN_BIT(CHECK_IN_PIN));
+    check("a high level detect stays clear once low", 0 == (gpio_reg_read(check_reg(GPEDS0_OFF)) & GPIO_PIN_BIT(CHECK_IN_PIN)));
+    update_gpio_reg(GPHEN0_OFF, (uint32_t) GPIO_PIN_BIT(CHECK_IN_PIN), 0x00);
+
+    // Reserved bits are dropped
+    gpio_reg_write(check_reg(GPFN_SEL5_OFF), 0xFFFFFFFF);
+    check("GPFSEL5 drops its reserved bits", GPREG5_3BIT_WRITE_MASK == gpio_reg_read(check_reg(GPFN_SEL5_OFF)));
+    gpio_reg_write(check_reg(GPFN_SEL5_OFF), 0x00);
+    gpio_reg_write(check_reg(GPREN1_OFF), 0xFFFFFFFF);
+    check("GPREN1 drops its reserved bits", GPREG1_1BIT_WRITE_MASK == gpio_reg_read(check_reg(GPREN1_OFF)));
+    gpio_reg_write(check_reg(GPREN1_OFF), 0x00);
+
+    check_config_commit();
+    check_debounce();
+    check_capture_wrap();
+    check_capture_resume();
+
+    release_gpio_line(&in_line);
+    release_gpio_line(&out1_line);
+    release_gpio_line(&out_line);
+    close_gpio_chip();
+    printf("gpiod_sim_check: %u failed\n", check_failures);
+    return (0 == check_failures) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+// Report one check
+static void check(const char* what,
+                  int passed)
+{
+    printf("%s: %s\n", passed ? "ok  " : "FAIL", what);
+    check_failures += passed ? 0 : 1;
+}
+// A register of the chip mapping
+static volatile uint32_t* check_reg(uint32_t offset)
+{
+    return (volatile uint32_t *)(get_gpio_chip_base() + offset);
+}
+// Configuration commit check
+static void check_config_commit(void)
+{
+    /// LOCALS ///
+    // Transaction committed
+    gpio_config_t config;
+    // Function selects of pins 11 and 12, left in GPFSEL1 by the partial commit
+    uint32_t fsel1          = (((uint32_t) ALT_0) << 3) | (((uint32_t) OUTPUT) << 6);
+    // Every pin of GPFSEL5 as an OUTPUT, every pin of GP_PUP_PDN_CNTRL_REG3 pulled up
+    uint32_t fsel5_outputs  = 0x00;
+    uint32_t pup3_pull_ups  = 0x00;
+    // First write of the function select, the pull and the rising edge enable of the ordered commit
+    int32_t fsel_write      = -1;
+    int32_t pull_write      = -1;
+    int32_t detect_write    = -1;
+    // Pin index
+    uint8_t pin             = 0;
+
+    // A partly staged register is read and written once, keeping the fields not staged
+    gpio_reg_write(check_reg(GPFN_SEL1_OFF), fsel1);
+    init_gpio_config(&config);
+    stage_gpio_fn(&config, 13, OUTPUT);
+    gpio_sim_log(check_log, CHECK_LOG_SIZE);
+    commit_gpio_config(&config);
+    check("a partly staged register is read then written",
+          (2 == gpio_sim_logged()) && !check_log[0].write && (GPFN_SEL1_OFF == check_log[0].offset) &&
+          check_log[1].write && (GPFN_SEL1_OFF == check_log[1].offset));
+    check("a partial commit keeps the fields not staged",
+          (fsel1 | (((uint32_t) OUTPUT) << 9)) == gpio_reg_read(check_reg(GPFN_SEL1_OFF)));
+
+    // A fully staged register is written without a read
+    gpio_reg_write(check_reg(GPFN_SEL2_OFF), GPREG0_4_3BIT_WRITE_MASK);
+    init_gpio_config(&config);
+    for (pin = 20; pin <= 29; pin++)
+    {
+        stage_gpio_fn(&config, pin, INPUT);
+    }
+    gpio_sim_log(check_log, CHECK_LOG_SIZE);
+    commit_gpio_config(&config);
+    check("a fully staged register is only written",
+          (1 == gpio_sim_logged()) && check_log[0].write && (GPFN_SEL2_OFF == check_log[0].offset));
+    check("a fully staged register takes the staged value", 0 == gpio_reg_read(check_reg(GPFN_SEL2_OFF)));
+
+    // GPFSEL5 and GP_PUP_PDN_CNTRL_REG3 are full with their eight and ten pins
+    init_gpio_config(&config);
+    for (pin = 50; pin <= GPIO_PIN_MAX; pin++)
+    {
+        stage_gpio_fn(&config, pin, OUTPUT);
+        fsel5_outputs |= ((uint32_t) OUTPUT) << ((pin - 50) * 3);
+    }
+    for (pin = 48; pin <= GPIO_PIN_MAX; pin++)
+    {
+        stage_gpio_pull(&config, pin, PULL_UP);
+        pup3_pull_ups |= ((uint32_t) PULL_UP) << ((pin - 48) * 2);
+    }
+    gpio_sim_log(check_log, CHECK_LOG_SIZE);
+    commit_gpio_config(&config);
+    check("GPFSEL5 is full by its write mask and only written",
+          (2 == gpio_sim_logged()) && check_log[0].write && (GPFN_SEL5_OFF == check_log[0].offset) &&
+          (fsel5_outputs == check_log[0].value) && (0 == (check_log[0].value & ~GPREG5_3BIT_WRITE_MASK)));
+    check("GP_PUP_PDN_CNTRL_REG3 is full by its write mask and only written",
+          (2 == gpio_sim_logged()) && check_log[1].write && (GP_PUP_PDN_CNTRL_REG3 == check_log[1].offset) &&
+          (pup3_pull_ups == check_log[1].value) && (0 == (check_log[1].value & ~GPREG3_2BIT_WRITE_MASK)));
+
+    // Function select, then pull, then detect enable
+    init_gpio_config(&config);
+    stage_gpio_event(&config, 21, EVENT_RISING);
+    stage_gpio_pull(&config, 21, PULL_DOWN);
+    stage_gpio_fn(&config, 21, INPUT);
+    gpio_sim_log(check_log, CHECK_LOG_SIZE);
+    commit_gpio_config(&config);
+    fsel_write   = check_log_write(GPFN_SEL2_OFF);
+    pull_write   = check_log_write(GP_PUP_PDN_CNTRL_REG1);
+    detect_write = check_log_write(GPREN0_OFF);
+    check("a commit writes the function select, then the pull, then the detect enable",
+          (0 <= fsel_write) && (fsel_write < pull_write) && (pull_write < detect_write));
+    check("the detect enable is committed", 0 != (gpio_reg_read(check_reg(GPREN0_OFF)) & GPIO_PIN_BIT(21)));
+    gpio_sim_log(NULL, 0);
+    gpio_reg_write(check_reg(GPREN0_OFF), 0x00);
+}
+// First logged write to a register
+static int32_t check_log_write(uint32_t offset)
+{
+    /// LOCALS ///
+    // Index of the write
+    int32_t write_ind = -1;
+    // Log index
+    uint32_t log_ind  = 0;
+
+    for (log_ind = 0; (-1 == write_ind) && (log_ind < gpio_sim_logged()); log_ind++)
+    {
+        write_ind = (check_log[log_ind].write && (offset == check_log[log_ind].offset)) ? (int32_t) log_ind : -1;
+    }
+    return write_ind;
+}
+// Debounce equivalence check
+static void check_debounce(void)
+{
+    /// LOCALS ///
+    // The debouncer checked, over every pin
+    gpio_debounce_t deb;
+    // Per-pin model: debounced levels, counts and thresholds
+    uint64_t model_levels                   = 0x00;
+    uint8_t model_count[GPIO_PIN_MAX + 1]   = { 0 };
+    uint8_t model_threshold[GPIO_PIN_MAX + 1];
+    // Pins changed by the sample, in the debouncer and in the model
+    uint64_t changed                        = 0x00;
+    uint64_t model_changed                  = 0x00;
+    // Pins whose debounced level changed at least once, at a threshold of 1 and of GPIO_DEBOUNCE_MAX
+    uint64_t moved                          = 0x00;
+    uint64_t moved_min                      = 0x00;
+    uint64_t moved_max                      = 0x00;
+    // Pins of the mask passed to the midway threshold change
+    uint64_t even_pins                      = 0x00;
+    // Raw levels, and the xorshift state driving their bounces
+    uint64_t raw                            = 0x00;
+    uint64_t rng                            = 0x9E3779B97F4A7C15ULL;
+    // Pins flipped by the sample
+    uint64_t flips                          = 0x00;
+    // Samples where the two disagree
+    uint32_t mismatches                     = 0;
+    // Sample, draw and pin index
+    uint32_t sample                         = 0;
+    uint8_t draw                            = 0;
+    uint8_t pin                             = 0;
+
+    init_gpio_debounce(&deb, (GPIO_PIN_BIT(GPIO_PIN_MAX) << 1) - 1, 0x00, 1);
+    // Every threshold from 1 to GPIO_DEBOUNCE_MAX, over the pins in turn
+    for (pin = 0; pin <= GPIO_PIN_MAX; pin++)
+    {
+        model_threshold[pin] = 1 + (pin % GPIO_DEBOUNCE_MAX);
+        set_gpio_debounce_threshold(&deb, GPIO_PIN_BIT(pin), model_threshold[pin]);
+        even_pins |= (0 == (pin % 2)) ? GPIO_PIN_BIT(pin) : 0x00;
+    }
+    for (sample = 0; sample < CHECK_DEBOUNCE_SAMPLES; sample++)
+    {
+        // Halfway the even pins go to GPIO_DEBOUNCE_MAX and their counts start over
+        if ((CHECK_DEBOUNCE_SAMPLES / 2) == sample)
+        {
+            set_gpio_debounce_threshold(&deb, even_pins, GPIO_DEBOUNCE_MAX);
+            for (pin = 0; pin <= GPIO_PIN_MAX; pin += 2)
+            {
+                model_threshold[pin] = GPIO_DEBOUNCE_MAX;
+                model_count[pin]     = 0;
+            }
+        }
+        // Each pin flips with a chance of 1 in 32, the AND of five draws, so runs of every threshold occur
+        flips = UINT64_MAX;
+        for (draw = 0; draw < 5; draw++)
+        {
+            rng   ^= rng << 13;
+            rng   ^= rng >> 7;
+            rng   ^= rng << 17;
+            flips &= rng;
+        }
+        raw ^= flips;
+        changed       = update_gpio_debounce(&deb, raw);
+        model_changed = 0x00;
+        for (pin = 0; pin <= GPIO_PIN_MAX; pin++)
+        {
+            if (GPIO_PIN_LEVEL(raw, pin) == GPIO_PIN_LEVEL(model_levels, pin))
+            {
+                model_count[pin] = 0;
+            }
+            else if (++model_count[pin] >= model_threshold[pin])
+            {
+                model_count[pin] = 0;
+                model_changed   |= GPIO_PIN_BIT(pin);
+                moved_min       |= (1 == model_threshold[pin]) ? GPIO_PIN_BIT(pin) : 0x00;
+                moved_max       |= (GPIO_DEBOUNCE_MAX == model_threshold[pin]) ? GPIO_PIN_BIT(pin) : 0x00;
+            }
+        }
+        model_levels ^= model_changed;
+        moved        |= model_changed;
+        mismatches   += ((changed != model_changed) || (deb.levels != model_levels)) ? 1 : 0;
+    }
+    check("the debouncer matches a per-pin loop across a threshold change", 0 == mismatches);
+    check("the stream moves pins at thresholds 1 and GPIO_DEBOUNCE_MAX",
+          (0 != moved_min) && (0 != moved_max) && (((GPIO_PIN_BIT(GPIO_PIN_MAX) << 1) - 1) == moved));
+}
+// Capture wrap check
+static void check_capture_wrap(void)
+{
+    /// LOCALS ///
+    // Capture file
+    char path[]                          = "/tmp/gpiod_sim_check.XXXXXX";
+    int32_t path_fd                      = mkstemp(path);
+    // The toggling thread
+    pthread_t toggler;
+    // Header and records of the capture
+    const gpio_capture_header_t* header  = NULL;
+    const gpio_capture_record_t* records = NULL;
+    // Oldest record held and record index, record n is toggle n (record 0 the initial level)
+    uint64_t first                       = 0;
+    uint64_t rec_ind                     = 0;
+    // Time of the record rebuilt from the time base and the deltas
+    uint64_t rec_ns                      = 0;
+    // Records whose time falls outside the half gap after their toggle
+    uint32_t misplaced                   = 0;
+
+    if (-1 != path_fd)
+    {
+        close(path_fd);
+    }
+    gpio_sim_set_inputs(0x00, GPIO_PIN_BIT(CHECK_IN_PIN));
+    if ((-1 == path_fd) ||
+        (0 != open_gpio_capture(&check_capture, path, CHECK_CAPTURE_RING, GPIO_PIN_BIT(CHECK_IN_PIN), UINT64_MAX)))
+    {
+        check("a capture file opens", 0);
+    }
+    else if (0 != pthread_create(&toggler, NULL, check_toggle_thread, NULL))
+    {
+        check("the toggling thread starts", 0);
+        close_gpio_capture(&check_capture);
+    }
+    else
+    {
+        run_gpio_capture(&check_capture, 0);
+        pthread_join(toggler, NULL);
+        header  = check_capture._header;
+        records = check_capture._records;
+        first   = header->head - CHECK_CAPTURE_RING;
+        check("the capture ring wrapped", (CHECK_CAPTURE_TOGGLES + 1) == header->head);
+        // Walk the ring oldest first, the way export_gpio_capture_vcd() does
+        rec_ns = header->base_ns;
+        for (rec_ind = first; ((CHECK_CAPTURE_TOGGLES + 1) == header->head) && (rec_ind < header->head); rec_ind++)
+        {
+            rec_ns    += (rec_ind == first) ? 0 : records[rec_ind % CHECK_CAPTURE_RING].delta_ns;
+            misplaced += ((rec_ns < check_toggle_ns[rec_ind]) ||
+                          (rec_ns >= (check_toggle_ns[rec_ind] + (CHECK_CAPTURE_GAP_US * 1000 / 2)))) ? 1 : 0;
+        }
+        check("times rebuilt across the wrap follow the toggles", 0 == misplaced);
+        close_gpio_capture(&check_capture);
+    }
+    if (-1 != path_fd)
+    {
+        unlink(path);
+    }
+}
+// Capture resume check
+static void check_capture_resume(void)
+{
+    /// LOCALS ///
+    // Capture file
+    char path[]                          = "/tmp/gpiod_sim_check.XXXXXX";
+    int32_t path_fd                      = mkstemp(path);
+    // Header and records of the capture
+    gpio_capture_header_t* header        = NULL;
+    const gpio_capture_record_t* records = NULL;
+    // Time of the first record, moved back by the idle gap, and the start of the resumed run
+    uint64_t idle_ns                     = 0;
+    uint64_t resume_ns                   = 0;
+    // Time of the newest record rebuilt from the time base and the deltas
+    uint64_t rec_ns                      = 0;
+    // Record index
+    uint64_t rec_ind                     = 0;
+
+    if (-1 != path_fd)
+    {
+        close(path_fd);
+    }
+    gpio_sim_set_inputs(0x00, GPIO_PIN_BIT(CHECK_IN_PIN));
+    if ((-1 == path_fd) ||
+        (0 != open_gpio_capture(&check_capture, path, CHECK_CAPTURE_RING * 4, GPIO_PIN_BIT(CHECK_IN_PIN), UINT64_MAX)))
+    {
+        check("a capture file opens", 0);
+    }
+    else
+    {
+        header  = check_capture._header;
+        records = check_capture._records;
+        run_gpio_capture(&check_capture, CHECK_CAPTURE_RUN_NS);
+        // The capture sat idle for CHECK_CAPTURE_IDLE_NS since its only record
+        idle_ns          = header->last_ns - CHECK_CAPTURE_IDLE_NS;
+        header->base_ns -= CHECK_CAPTURE_IDLE_NS;
+        header->last_ns  = idle_ns;
+        resume_ns        = gpio_time_ns();
+        run_gpio_capture(&check_capture, CHECK_CAPTURE_RUN_NS);
+        check("a long idle gap is bridged by two keep-alive records", 4 == header->head);
+        check("keep-alive records hold the full delta and the levels held",
+              (4 == header->head) &&
+              (UINT32_MAX == records[1].delta_ns) && (UINT32_MAX == records[2].delta_ns) &&
+              (records[0].levels == records[1].levels) && (records[0].levels == records[2].levels));
+        rec_ns = header->base_ns;
+        for (rec_ind = 1; rec_ind < header->head; rec_ind++)
+        {
+            rec_ns += records[rec_ind].delta_ns;
+        }
+        check("the resumed delta counts from the last record across the gap",
+              (rec_ns == header->last_ns) && (resume_ns <= rec_ns) && (idle_ns < resume_ns));
+        close_gpio_capture(&check_capture);
+    }
+    if (-1 != path_fd)
+    {
+        unlink(path);
+    }
+}
+// Toggle the input pin under the capture
+static void* check_toggle_thread(void* arg)
+{
+    /// LOCALS ///
+    // Toggle index
+    uint32_t toggle_ind = 0;
+
+    (void) arg;
+    for (toggle_ind = 1; toggle_ind <= CHECK_CAPTURE_TOGGLES; toggle_ind++)
+    {
+        usleep(CHECK_CAPTURE_GAP_US);
+        // Stamped before the change, the capture cannot see it any earlier
+        check_toggle_ns[toggle_ind] = gpio_time_ns();
+        gpio_sim_set_inputs((toggle_ind & 0x01) ? GPIO_PIN_BIT(CHECK_IN_PIN) : 0x00, GPIO_PIN_BIT(CHECK_IN_PIN));
+    }
+    usleep(CHECK_CAPTURE_GAP_US);
+    stop_gpio_capture(&check_capture);
+    return NULL;
+}
@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <gpiod.h>
+#include <gpiod_stats.h>
+
+/*******************************************************************************/
+//
+// DESCRIPTION : Reader of a process's gpiod stats segment.
+//
+// USAGE       : gpiod_stats PID [INTERVAL_S]
+//
+// DETAILS     : Maps the segment of a process built with GPIOD_STATS read-only
+//               and prints, for every line with activity, its operation counts,
+//               its median and 99th percentile latencies (the upper edge of the
+//               log2 bucket holding them) and its errors, summed over the thread
+//               slots and the counts of exited threads. The process is never stopped. With an interval the table
+//               is printed again every INTERVAL_S seconds until interrupted.
+//
+/*******************************************************************************/
+
+/// GLOBALS ///
+// Names of the operations, in enum GpioStatOp order
+static const char* STATS_OP_NAMES[STAT_OPS]           = { "write", "read", "set_fn", "set_pull" };
+// Names of the error codes, indexed by the negated code
+static const char* STATS_ERROR_NAMES[GPIO_STATS_ERRORS] = {
+    "", "EDEVMEM_OPEN", "EBAD_PIN", "EMALLOC", "EMAP_FAIL", "EPDAT_NULL", "EPIN_CONFIG", "EOUT_OF_RANGE",
+    "ECHIP_CLOSED", "ETHREAD", "EBACKEND", "EFILE_IO", "EKERNEL", "EBROKER", "ERT_SETUP", "ESTATE",
+    "EOTHER"
+};
+
+/// FUNCTION DECLARATIONS ///
+/* Sum a line's counters over every slot and the retired counters */
+static void stats_sum_line(const gpio_stats_segment_t *, uint8_t, gpio_stats_line_t *);
+/* Upper edge of the bucket holding the given fraction of a histogram, 0 when empty */
+static uint64_t stats_percentile_ns(const uint64_t *, uint64_t, double);
+/* Print the table */
+static void stats_print(const gpio_stats_segment_t *);
+
+/// FUNCTION DEFINITIONS ///
+int main(int argc, char* argv[])
+{
+    /// LOCALS ///
+    // Name of the segment
+    char name[32];
+    // The segment
+    const gpio_stats_segment_t* segment = MAP_FAILED;
+    // Seconds between tables, 0 prints one
+    uint32_t interval_s = 0;
+    // Descriptor of the segment
+    int32_t fd          = -1;
+
+    if ((argc < 2) || (argc > 3))
+    {
+        fprintf(stderr, "usage: %s PID [INTERVAL_S]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    interval_s = (3 == argc) ? (uint32_t) strtoul(argv[2], NULL, 0) : 0;
+    snprintf(name, sizeof(name), "%s%s", GPIO_STATS_SHM_PREFIX, argv[1]);
+    if ((-1 == (fd = shm_open(name, O_RDONLY, 0))) ||
+        (MAP_FAILED == (segment = mmap(NULL, sizeof(gpio_stats_segment_t), PROT_READ, MAP_SHARED, fd, 0))))
+    {
+        fprintf(stderr, "gpiod_stats: no stats segment for pid %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    close(fd);
+    // The layout must be the one this reader was built with
+    if ((GPIO_STATS_MAGIC != __atomic_load_n(&segment->magic, __ATOMIC_ACQUIRE)) || (GPIO_STATS_VERSION != segment->version) ||
+        (GPIO_STATS_SLOTS != segment->slots) || (GPIO_STATS_LINES != segment->lines) || (STAT_OPS != segment->ops) ||
+        (GPIO_STATS_ERRORS != segment->errors) || (GPIO_STATS_HIST_SZ != segment->hist_sz))
+    {
+        fprintf(stderr, "gpiod_stats: segment %s has an unknown layout\n", name);
+        return EXIT_FAILURE;
+    }
+    do
+    {
+        stats_print(segment);
+    } while ((0 != interval_s) && (0 == sleep(interval_s)));
+    return EXIT_SUCCESS;
+}
+// Sum a line's counters
+static void stats_sum_line(const gpio_stats_segment_t* segment,
+                           uint8_t line_ind,
+                           gpio_stats_line_t* sum)
+{
+    /// LOCALS ///
+    // Counters of the line in one slot
+    const gpio_stats_line_t* counters = NULL;
+    // Slot, operation, bucket and error index
+    uint8_t slot_ind   = 0;
+    uint8_t op_ind     = 0;
+    uint8_t bucket     = 0;
+    uint8_t error_ind  = 0;
+
+    memset(sum, 0, sizeof(*sum));
+    // One pass past the slots for the retired counters
+    for (slot_ind = 0; slot_ind <= GPIO_STATS_SLOTS; slot_ind++)
+    {
+        counters = (GPIO_STATS_SLOTS == slot_ind) ? &segment->retired.lines[line_ind] : &segment->slot[slot_ind].lines[line_ind];
+        for (op_ind = 0; op_ind < STAT_OPS; op_ind++)
+        {
+            sum->ops[op_ind] += __atomic_load_n(&counters->ops[op_ind], __ATOMIC_RELAXED);
+            for (bucket = 0; bucket < GPIO_STATS_HIST_SZ; bucket++)
+            {
+                sum->hist[op_ind][bucket] += __atomic_load_n(&counters->hist[op_ind][bucket], __ATOMIC_RELAXED);
+            }
+        }
+        for (error_ind = 0; error_ind < GPIO_STATS_ERRORS; error_ind++)
+        {
+            sum->errors[error_ind] += __atomic_load_n(&counters->errors[error_ind], __ATOMIC_RELAXED);
+        }
+    }
+}
+// Percentile of a histogram
+static uint64_t stats_percentile_ns(const uint64_t* hist,
+                                    uint64_t count,
+                                    double fraction)
+{
+    /// LOCALS ///
+    // Samples up to and including the bucket
+    uint64_t seen  = 0;
+    // Bucket index
+    uint8_t bucket = 0;
+
+    for (bucket = 0; (bucket < GPIO_STATS_HIST_SZ) && (0 != count); bucket++)
+    {
+        seen += hist[bucket];
+        if ((double) seen >= (fraction * (double) count))
+        {
+            return ((uint64_t) 1) << bucket;
+        }
+    }
+    return 0;
+}
+// Print the table
+static void stats_print(const gpio_stats_segment_t* segment)
+{
+    /// LOCALS ///
+    // Counters of one line over every slot
+    gpio_stats_line_t sum;
+    // Histogram total of an operation
+    uint64_t count     = 0;
+    // Line, operation, bucket and error index
+    uint8_t line_ind   = 0;
+    uint8_t op_ind     = 0;
+    uint8_t bucket     = 0;
+    uint8_t error_ind  = 0;
+
+    printf("pid %u, %u thread slots claimed\n", segment->pid, __atomic_load_n(&segment->claimed, __ATOMIC_RELAXED));
+    printf("%-5s %-9s %12s %10s %10s  %s\n", "line", "op", "count", "p50_ns<=", "p99_ns<=", "errors");
+    for (line_ind = 0; line_ind < GPIO_STATS_LINES; line_ind++)
+    {
+        stats_sum_line(segment, line_ind, &sum);
+        for (op_ind = 0; op_ind < STAT_OPS; op_ind++)
+        {
+            if (0 == sum.ops[op_ind])
+            {
+                continue;
+            }
+            count = 0;
+            for (bucket = 0; bucket < GPIO_STATS_HIST_SZ; bucket++)
+            {
+                count += sum.hist[op_ind][bucket];
+            }
+            if (GPIO_STATS_CHIP == line_ind)
+            {
+                printf("%-5s ", "chip");
+            }
+            else
+            {
+                printf("%-5u ", line_ind);
+            }
+            printf("%-9s %12llu %10llu %10llu ", STATS_OP_NAMES[op_ind], (unsigned long long) sum.ops[op_ind],
+                   (unsigned long long) stats_percentile_ns(sum.hist[op_ind], count, 0.50),
+                   (unsigned long long) stats_percentile_ns(sum.hist[op_ind], count, 0.99));
+            // A line's errors are listed once, on its first operation
+            for (error_ind = 1; error_ind < GPIO_STATS_ERRORS; error_ind++)
+            {
+                if (0 != sum.errors[error_ind])
+                {
+                    printf(" %s=%llu", STATS_ERROR_NAMES[error_ind], (unsigned long long) sum.errors[error_ind]);
+                    sum.errors[error_ind] = 0;
+                }
+            }
+            printf("\n");
+        }
+    }
+    fflush(stdout);
+}